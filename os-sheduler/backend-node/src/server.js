@@ -64,10 +64,22 @@ const VALID_ALGOS = [
   "fcfs",
   "sjf",
   "srtf",
+  "hrrn",
   "priority",
   "priority_p",
   "rr",
-  "mlfq"
+  "mlfq",
+  "mlq",
+  "hfs",
+  "cfs",
+  "eevdf",
+  "edf",
+  "rm",
+  "lottery",
+  "stride",
+  "cpf",
+  "gang",
+  "easy"
 ];
 
 function validateAlgorithm(algo) {
@@ -20,7 +20,7 @@ export default function NewRun() {
   const [isModalOpen, setIsModalOpen] = useState(false);
   const [isSubmitting, setIsSubmitting] = useState(false);
 
-  const algorithmsNeedingQuantum = ['RR', 'Round Robin'];
+  const algorithmsNeedingQuantum = ['RR', 'Round Robin', 'Lottery', 'Stride', 'Gang'];
   const algorithmsNeedingMLFQ = ['MLFQ'];
 
   const handleAddProcess = () => {
@@ -82,11 +82,23 @@ export default function NewRun() {
         'FCFS': 'fcfs',
         'SJF': 'sjf',
         'SRTF': 'srtf',
+        'HRRN': 'hrrn',
         'Priority': 'priority',
         'Priority_Preemptive': 'priority_p',
         'RR': 'rr',
         'Round Robin': 'rr',
-        'MLFQ': 'mlfq'
+        'MLFQ': 'mlfq',
+        'MLQ': 'mlq',
+        'HFS': 'hfs',
+        'CFS': 'cfs',
+        'EEVDF': 'eevdf',
+        'EDF': 'edf',
+        'RM': 'rm',
+        'Lottery': 'lottery',
+        'Stride': 'stride',
+        'CPF': 'cpf',
+        'Gang': 'gang',
+        'EASY': 'easy'
       };
       
       const backendAlgorithm = algorithmMap[algorithm] || algorithm.toLowerCase();
@@ -149,10 +161,22 @@ export default function NewRun() {
                   <option value="FCFS">FCFS (First Come First Served)</option>
                   <option value="SJF">SJF (Shortest Job First)</option>
                   <option value="SRTF">SRTF (Shortest Remaining Time First)</option>
+                  <option value="HRRN">HRRN (Highest Response Ratio Next)</option>
                   <option value="Priority">Priority (Non-preemptive)</option>
                   <option value="Priority_Preemptive">Priority (Preemptive)</option>
                   <option value="RR">Round Robin</option>
                   <option value="MLFQ">MLFQ (Multi-Level Feedback Queue)</option>
+                  <option value="MLQ">MLQ (Multi-Level Queue)</option>
+                  <option value="HFS">HFS (Hierarchical Fair Share)</option>
+                  <option value="CFS">CFS (Completely Fair Scheduler)</option>
+                  <option value="EEVDF">EEVDF (Earliest Eligible Virtual Deadline First)</option>
+                  <option value="EDF">EDF (Earliest Deadline First)</option>
+                  <option value="RM">RM (Rate-Monotonic)</option>
+                  <option value="Lottery">Lottery (Proportional Share)</option>
+                  <option value="Stride">Stride (Proportional Share)</option>
+                  <option value="CPF">CPF (Critical Path First)</option>
+                  <option value="Gang">Gang (Co-scheduled Parallel Jobs)</option>
+                  <option value="EASY">EASY (Cluster Backfilling)</option>
                 </select>
               </div>
 
@@ -0,0 +1,90 @@
+#ifndef ADMIT_H
+#define ADMIT_H
+
+#include "process.h"
+
+struct scheduler_t;
+
+/* Admission control on the single-CPU model: every arrival passes it before
+ * it joins the ready queue, and one that fails is rejected (it leaves with
+ * job_finished, "rejected" giving the reason) without ever running:
+ *   queue     max_queue admitted jobs are in the system (ready, running
+ *             or blocked) already;
+ *   rate      the token bucket is empty: it holds up to burst tokens,
+ *             refills at rate tokens per tick, and each admission takes one;
+ *   deadline  (deadline) the job could not finish by its deadline even if
+ *             it ran after the CPU work already admitted, back to back.
+ * The checks run in that order, and a rejected job takes no token.
+ *
+ * With shed_late, an admitted job that has a deadline is shed when it is
+ * first dispatched if it can no longer meet it: the dispatch tick is lost
+ * (shed_ticks) and the job leaves with job_finished, "shed".
+ *
+ * Jobs that other jobs wait for, or that wait for others, are always
+ * admitted and never shed: those with predecessors or dependants in the
+ * dependency graph (see dag.h), and children whose parent waits for them
+ * (see spawn.h). They count towards the queue and the backlog all the same.
+ * Periodic jobs bypass admission.
+ */
+
+typedef enum {
+    REJECT_QUEUE,
+    REJECT_RATE,
+    REJECT_DEADLINE,
+    REJECT_REASONS
+} reject_reason_t;
+
+/* A job that never completed: rejected at arrival or shed */
+typedef struct {
+    int pid;
+    unsigned int arrival;
+    int burst;               // CPU work
+    unsigned int deadline;   // UINT_MAX = none
+    int reason;              // reject_reason_t, -1 if shed
+    unsigned int at;         // tick it was rejected or shed
+} dropped_job_t;
+
+typedef struct {
+    int on;                  // any control set
+    int max_queue;           // 0 = no cap
+    double rate;             // tokens per tick (0 = no limit)
+    double burst;            // bucket depth
+    int deadline;            // reject jobs that cannot meet their deadline
+    int shed_late;           // shed jobs that can no longer meet it
+
+    double tokens;
+    unsigned long refill_tick;
+    int in_system;           // admitted and not finished
+    unsigned long backlog;   // CPU work those still have to do
+
+    /* results */
+    unsigned long arrivals;
+    unsigned long admitted;
+    unsigned long rejected[REJECT_REASONS];
+    unsigned long shed;
+    unsigned long shed_ticks;
+    int queue_peak;
+    dropped_job_t *dropped;  // in the order they left
+    size_t ndropped, cap;
+} admit_t;
+
+void admit_init(admit_t *a);
+const char *admit_reason_name(int reason);
+
+/* p arrives. Returns 1 if it is admitted; otherwise it is recorded and
+ * freed, and 0 is returned. */
+int admit_arrive(struct scheduler_t *s, process_t *p);
+
+/* p is about to do a tick of work (scheduler_consume). Returns 1 if it is
+ * to be shed instead: the tick is lost and p leaves after the policy. */
+int admit_shed(struct scheduler_t *s, process_t *p);
+
+/* After the policy's tick: s->running leaves if it was shed */
+void admit_tick(struct scheduler_t *s);
+
+/* p finished */
+void admit_leave(struct scheduler_t *s, process_t *p);
+
+void admit_clear(struct scheduler_t *s);
+
+#endif // ADMIT_H
@@ -0,0 +1,37 @@
+#ifndef CFS_H
+#define CFS_H
+
+#include "scheduler.h"
+
+/* Per-tick handler for the CFS-style fair scheduler.
+ *
+ * Runnable processes sit in a red-black tree (s->rq) ordered by vruntime:
+ * ticks run, scaled by NICE_0_WEIGHT / weight, where the weight comes from
+ * the Linux nice table with priority used as nice (clamped to -20..19).
+ * The leftmost (smallest vruntime) process runs. Each process gets a slice
+ * of the scheduling period, max(sched_latency, nr_running * min_granularity),
+ * in proportion to its weight; it is preempted when the slice is used up,
+ * or once it has run min_granularity ticks and is a slice ahead of the
+ * leftmost. A waking process preempts when it trails the running one by
+ * more than min_granularity (weighted).
+ *
+ * New processes start at min_vruntime plus one slice; processes back from
+ * I/O at no less than min_vruntime - sched_latency/2.
+ */
+void cfs_tick(scheduler_t *s);
+
+#define NICE_0_WEIGHT 1024
+
+/* vruntime is kept in 1/VR_SCALE ticks */
+#define VR_SCALE 1024ULL
+
+/* Load weight for a priority used as nice value */
+unsigned long cfs_weight(int priority);
+
+/* Set up s->rq as the vruntime tree (scheduler_create) */
+void cfs_init(scheduler_t *s);
+
+/* Free every process left in s->rq (scheduler teardown, CFS and EEVDF) */
+void cfs_clear(scheduler_t *s);
+
+#endif // CFS_H
@@ -0,0 +1,130 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <stdio.h>
+#include "scheduler.h"
+#include "rbtree.h"
+
+/* Batch scheduling on a cluster (ALG_EASY, or fcfs with --nodes): nodes of
+ * node_cpus CPUs each, every one a scheduler_t holding the node's counts,
+ * and a global queue of rigid jobs. A job asks for procs CPUs and a wall
+ * time limit (its requested run time), and holds its CPUs from start to
+ * finish; one that runs past its limit is killed at it. Jobs take CPUs
+ * first fit across the nodes (shared), or whole nodes, the unused CPUs
+ * of the last one idle (exclusive).
+ *
+ * The queue is served in submit order (FCFS). With backfilling (EASY), the
+ * first job that does not fit gets a reservation: the time enough CPUs are
+ * free if running jobs end at their limits (the shadow time), and the CPUs
+ * it will leave over (extra). A later job then starts at once if it fits
+ * and either ends by the shadow time or uses only extra CPUs, so it never
+ * delays the first job. Only the first backfill_depth jobs of the queue are
+ * tried (0 = all), as batch systems bound the scan on long queues.
+ *
+ * The simulation goes from event to event (submits and job ends), not tick
+ * by tick, and jobs are read from the trace as they are submitted, so
+ * traces of millions of jobs run in memory for the jobs queued or running.
+ * Time is in ticks; for a standard workload format (SWF) trace, seconds.
+ *
+ * Bounded slowdown is (wait + run) / max(run, tau), at least 1: tau keeps
+ * jobs of a few seconds from dominating the average.
+ */
+
+#define CLUSTER_TAU_DEFAULT 10UL
+
+typedef enum {
+    ALLOC_SHARED,            // CPUs first fit across nodes
+    ALLOC_EXCLUSIVE          // whole nodes
+} cluster_alloc_t;
+
+typedef struct cluster_job_t {
+    int id;
+    unsigned long submit;
+    unsigned long run;       // actual run time (cut to req)
+    unsigned long req;       // requested run time (wall time limit)
+    int procs;               // CPUs it asks for
+    int units;               // CPUs (shared) or nodes (exclusive) it holds
+    unsigned long start;
+    int backfilled;
+    int killed;              // ran into its limit
+    int *alloc;              // while running: (node, CPUs used there) pairs
+    int nalloc;
+    rb_node_t by_end;        // running jobs by actual end
+    rb_node_t by_limit;      // running jobs by start + req (reservations)
+    struct cluster_job_t *prev, *next;   // queue links
+} cluster_job_t;
+
+/* Where jobs come from, in submit order: an SWF trace read line by line, or
+ * the jobs of a JSON workload */
+typedef struct {
+    FILE *fp;
+    const char *path;
+    unsigned long line;
+    char buf[1024];
+    int have_line;           // buf holds the first job line, read with the header
+    cluster_job_t **jobs;    // workload jobs, sorted by submit
+    int njobs, next;
+    int max_nodes, max_procs;// SWF header (0 = not given)
+    unsigned long invalid;   // trace lines skipped: bad fields or no CPUs or run time
+    unsigned long truncated; // jobs that ran past their limit
+} cluster_source_t;
+
+typedef struct cluster_t {
+    int nodes, node_cpus;
+    cluster_alloc_t alloc;
+    int backfill;            // EASY (0 = plain FCFS)
+    int backfill_depth;
+    unsigned long tau;       // bounded slowdown threshold
+
+    scheduler_t **node;      // per node: busy CPU ticks, jobs done, events
+    int *node_free;          // free CPUs per node
+    int units, free_units;   // CPUs (shared) or nodes (exclusive) in all, free
+
+    unsigned long now;
+    cluster_job_t *head, *tail;  // the queue, in submit order
+    int queued;
+    rb_tree_t running_end;
+    rb_tree_t running_limit;
+    unsigned long shadow;    // reservation of the queue head
+    int extra;
+
+    /* results */
+    unsigned long jobs;      // jobs that finished
+    unsigned long too_wide;  // jobs asking for more CPUs than the cluster has (skipped)
+    unsigned long late;      // submits earlier than the previous one (taken as submitted then)
+    unsigned long backfilled;
+    unsigned long first_submit, last_end;
+    unsigned long long run_total;    // run time of the finished jobs
+    unsigned long long used_ticks;   // CPU ticks of work
+    unsigned long long held_ticks;   // CPU ticks held, with the idle CPUs of exclusive nodes
+    int queue_peak;
+    unsigned int *waits;     // per finished job
+    double *bsld;
+    size_t nrec, caprec;
+} cluster_t;
+
+/* A cluster of nodes x node_cpus, backfilling under ALG_EASY; NULL on OOM */
+cluster_t *cluster_create(sched_algo_t algo, int nodes, int node_cpus);
+void cluster_destroy(cluster_t *c);
+
+const char *cluster_alloc_name(cluster_alloc_t a);
+
+/* "shared" or "exclusive"; -1 if unknown */
+int cluster_parse_alloc(const char *name);
+
+/* Open an SWF trace and read its header comments (MaxNodes, MaxProcs).
+ * Returns 0, or -1 if it cannot be opened. */
+int cluster_open_swf(cluster_source_t *src, const char *path);
+
+/* Jobs of a workload: procs from "cpus", run time the job's CPU and I/O
+ * bursts, limit its "walltime" (its run time if none). Frees the
+ * processes. Returns 0, or -1 on OOM. */
+int cluster_use_processes(cluster_source_t *src, process_t **procs, int n);
+
+void cluster_close(cluster_source_t *src);
+
+/* Run every job of src to completion. Returns the number of jobs
+ * submitted, or -1 on OOM. */
+long cluster_run(cluster_t *c, cluster_source_t *src);
+
+#endif // CLUSTER_H
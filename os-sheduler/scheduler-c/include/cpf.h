@@ -0,0 +1,22 @@
+#ifndef CPF_H
+#define CPF_H
+
+#include "scheduler.h"
+
+/* Per-tick handler for non-preemptive critical-path first, list scheduling
+ * for job dependency graphs (see dag.h).
+ *
+ * When the CPU is free, the ready process with the longest critical path
+ * still ahead of it (its cp_rank less the CPU and I/O work it has done) runs
+ * to the end of its CPU burst, so the chain that bounds the makespan is never
+ * left waiting behind work that has slack. Ties go to the earlier arrival,
+ * then the lower pid. Jobs outside any graph have the path of their own
+ * length, which makes this longest job first for an independent workload.
+ * Ready processes sit in s->heap.
+ */
+void cpf_tick(scheduler_t *s);
+
+/* Set up s->heap ordered by remaining critical path (scheduler_create) */
+void cpf_init(scheduler_t *s);
+
+#endif // CPF_H
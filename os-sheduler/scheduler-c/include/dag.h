@@ -0,0 +1,69 @@
+#ifndef DAG_H
+#define DAG_H
+
+#include "process.h"
+
+/* Job dependencies: a job lists its predecessors by pid ("after") and is held
+ * back, whatever its arrival, until every one of them has finished. It is
+ * released at the later of its arrival and the tick its last predecessor
+ * finished, and is dispatchable from the next tick like any arrival.
+ *
+ * A job's critical path (cp_rank) is its own length, CPU plus I/O bursts,
+ * plus the longest critical path among the jobs that depend on it: the
+ * least time from its start until everything downstream of it can be done.
+ * The graph's path bound is the makespan it would have with a free CPU for
+ * every job and no device contention, counted from the first arrival.
+ */
+
+typedef struct {
+    process_t *proc;         // the job from its arrival until it finishes (NULL otherwise)
+    unsigned int arrival;
+    unsigned long length;    // CPU + I/O ticks
+    int first, nchildren;    // its dependants, children[first .. first + nchildren)
+    int waiting;             // predecessors not finished yet
+    int arrived;             // arrival passed (held or injected)
+    int finished;
+    unsigned long released;  // tick its last predecessor finished
+    unsigned long due;       // no earlier than its finish tick (key in dag_t.running)
+} dag_job_t;
+
+typedef struct dag_t {
+    dag_job_t *v;
+    int n;
+    int *children;
+    int nedges;
+    int unreleased;          // jobs still waiting on a predecessor
+    int *running;            // released jobs with dependants: min-heap on due, finished ones left in
+    int nrunning;
+    unsigned long path_bound;// makespan with unlimited CPUs, from the first arrival
+    unsigned long work;      // CPU ticks of all the jobs (all threads of a gang)
+} dag_t;
+
+/* Build the graph of jobs[0..n): sets each job's dag_idx and cp_rank, and
+ * drops (with a warning) predecessors that are not in the workload, and the
+ * dependencies among the jobs of each cycle. Returns 0, or -1 on OOM.
+ */
+int dag_build(dag_t *d, process_t **jobs, int n);
+
+/* p's arrival came: returns 1 if it can run, 0 if it is held
+ * until its predecessors finish (the graph keeps it meanwhile). Sets
+ * p->released either way.
+ */
+int dag_arrive(dag_t *d, process_t *p);
+
+/* Job idx finished at tick now: returns the held jobs it released, chained
+ * through their next field, in workload order.
+ */
+process_t *dag_finish(dag_t *d, int idx, unsigned long now);
+
+/* Earliest tick, from now, at which a running job with dependants could
+ * finish on a CPU of the given speed (ULONG_MAX if none can). speed must be
+ * the fastest a job can run, and the same on every call: a job's earliest
+ * finish then never moves back, so only the jobs whose bound is the
+ * earliest are looked at again. */
+unsigned long dag_next_finish(dag_t *d, unsigned long now, unsigned int speed);
+
+/* Free the graph and the jobs it still holds */
+void dag_free(dag_t *d);
+
+#endif // DAG_H
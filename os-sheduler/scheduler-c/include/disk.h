@@ -0,0 +1,28 @@
+#ifndef DISK_H
+#define DISK_H
+
+#include "scheduler.h"
+
+/* Request scheduling for the simulated I/O device. Every I/O burst is a
+ * request for one block; serving it takes the burst length plus the seek
+ * from the current head position (|block - disk_pos| / seek_rate ticks,
+ * rounded up). When the device goes idle the policy picks the next request:
+ *
+ *   DISK_FIFO      arrival order
+ *   DISK_SCAN      elevator: nearest block in the current direction, reversing
+ *                  at the last request (LOOK)
+ *   DISK_DEADLINE  elevator order, but a request queued for io_deadline ticks
+ *                  or more is served first (oldest first)
+ */
+
+/* Remove and return the next request of s's device queue (NULL if empty) */
+process_t *disk_pick(scheduler_t *s);
+
+/* Seek ticks for moving the head of s to block */
+unsigned long disk_seek_ticks(const scheduler_t *s, long block);
+
+/* Name used in the summary, and parsing of --disk= (-1 if unknown) */
+const char *disk_policy_name(disk_sched_t policy);
+int disk_parse_policy(const char *name);
+
+#endif // DISK_H
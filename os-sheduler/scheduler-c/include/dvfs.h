@@ -0,0 +1,89 @@
+#ifndef DVFS_H
+#define DVFS_H
+
+#include "process.h"
+
+struct scheduler_t;
+
+/* Dynamic voltage and frequency scaling. Every CPU has the same frequency
+ * levels, in percent of its top frequency, and runs at one of them: a tick
+ * at level f does f% of the work a tick at the top level does, so a CPU of
+ * speed 200 (see smp.h) at 50% does what a nominal core does.
+ *
+ * Power follows the usual CMOS curve, voltage scaling with frequency: a busy
+ * tick at level f draws static + dynamic * f^3 watts, scaled by the CPU's
+ * speed over 100 (a big core draws more). An idle CPU draws the idle power
+ * whatever its level, so finishing early and idling (race to idle) can beat
+ * running slowly when static power is high. A tick lasts DVFS_TICK_SECONDS.
+ *
+ * A governor picks each CPU's level for every tick it is busy:
+ *   performance  the top level;
+ *   powersave    the lowest;
+ *   schedutil    1.25 times the CPU's utilisation, rounded up to a level:
+ *                utilisation is a PELT-like decaying average of the busy
+ *                ticks (halving every DVFS_HALF_LIFE ticks), each counted
+ *                at its level's frequency, so a busy CPU steps up a level or
+ *                so at a time and an idle one falls back.
+ *
+ * Ticks stalled on a dispatch, a cache refill or a held resource, and gang
+ * threads spinning, are busy: they draw power but do no work. Energy of busy
+ * ticks is charged to the job on the CPU; idle energy to nobody.
+ */
+
+#define DVFS_MAX_LEVELS 16
+#define DVFS_TICK_SECONDS 0.001
+#define DVFS_HALF_LIFE 32
+
+typedef enum {
+    GOV_PERFORMANCE,
+    GOV_POWERSAVE,
+    GOV_SCHEDUTIL
+} governor_t;
+
+typedef struct dvfs_t {
+    governor_t governor;
+    int nlevels;
+    unsigned int levels[DVFS_MAX_LEVELS];  // ascending, the last 100
+    double p_static;         // watts of a busy nominal core at any level
+    double p_dynamic;        // watts it adds at the top level
+    double p_idle;           // watts of an idle nominal core
+} dvfs_t;
+
+/* State of one CPU (scheduler_t.freq) */
+typedef struct {
+    const dvfs_t *cfg;       // NULL: no DVFS, the CPU runs at its speed
+    unsigned int capacity;   // speed at the top level
+    int level;
+    double util;             // 0..1 of the top frequency
+    unsigned long util_tick; // tick util was last updated
+    double energy;           // joules of its busy ticks
+    unsigned long switches;  // level changes
+    unsigned long level_ticks[DVFS_MAX_LEVELS];
+} dvfs_cpu_t;
+
+/* Levels 40,60,80,100 under schedutil; 0.3 W static, 1.7 W dynamic, 0.05 W idle */
+void dvfs_init(dvfs_t *d);
+
+/* "performance", "powersave" or "schedutil"; -1 if unknown */
+int dvfs_parse_governor(const char *name);
+const char *dvfs_governor_name(governor_t g);
+
+/* Levels as percentages, e.g. "40,60,80,100"; sorted, and 100 added if
+ * missing. Returns 0, or -1 on a malformed spec. */
+int dvfs_parse_levels(dvfs_t *d, const char *spec);
+
+/* Power curve "STATIC,DYNAMIC,IDLE" in watts. Returns 0, or -1. */
+int dvfs_parse_power(dvfs_t *d, const char *spec);
+
+/* Put s under d, its speed as its capacity */
+void dvfs_attach(struct scheduler_t *s, const dvfs_t *d);
+
+/* s is busy this tick with p: the governor picks the level, and the
+ * tick's energy is charged to s and p. Returns the speed s works at this
+ * tick. */
+unsigned int dvfs_charge(struct scheduler_t *s, process_t *p);
+
+/* Watts s draws idle */
+double dvfs_idle_power(const struct scheduler_t *s);
+
+#endif // DVFS_H
@@ -0,0 +1,28 @@
+#ifndef EDF_H
+#define EDF_H
+
+#include "scheduler.h"
+
+/* Per-tick handler for preemptive earliest deadline first, and for
+ * rate-monotonic, which only orders the heap differently (rm_init).
+ *
+ * Ready processes sit in a binary heap (s->heap) keyed on their absolute
+ * deadline (arrival + the workload's "deadline"); jobs without one sort
+ * after every job that has one. Ties go to the earlier arrival, then the
+ * lower pid. The running process is preempted as soon as a ready process
+ * has a strictly earlier deadline.
+ */
+void edf_tick(scheduler_t *s);
+
+/* Set up s->heap as the deadline heap (scheduler_create) */
+void edf_init(scheduler_t *s);
+
+/* Set up s->heap for rate-monotonic fixed priorities: the job with the
+ * shortest period (see periodic.h) runs, ties go to the lower pid, and
+ * aperiodic jobs run in the background in arrival order */
+void rm_init(scheduler_t *s);
+
+/* Free every process left in s->heap, and the heap (scheduler teardown) */
+void edf_clear(scheduler_t *s);
+
+#endif // EDF_H
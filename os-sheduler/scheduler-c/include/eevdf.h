@@ -0,0 +1,30 @@
+#ifndef EEVDF_H
+#define EEVDF_H
+
+#include "scheduler.h"
+
+/* Per-tick handler for EEVDF (earliest eligible virtual deadline first).
+ *
+ * Processes carry a vruntime as under CFS (same weights, see cfs.h) and a
+ * virtual deadline: the vruntime at which their current request of
+ * min_granularity ticks of service is used up. V, the weight-averaged
+ * vruntime of everything runnable, is the service an ideal fair CPU would
+ * have given; a process's lag is V - vruntime. Processes with lag >= 0 are
+ * eligible, and the eligible one with the earliest deadline runs.
+ *
+ * s->rq is ordered by vruntime and augmented with each subtree's earliest
+ * deadline, so the pick is a single O(log n) descent. The running process
+ * keeps the CPU until its request is served (it then gets a new deadline)
+ * or a process wakes up, and is only switched out if another pick wins.
+ * A process leaving for I/O keeps its lag and is placed back at V - lag.
+ */
+void eevdf_tick(scheduler_t *s);
+
+/* p stops being runnable other than at the end of a burst (blocked on a
+ * resource): keep its lag for the next wakeup */
+void eevdf_leave(scheduler_t *s, process_t *p);
+
+/* Set up s->rq as the augmented vruntime tree (scheduler_create) */
+void eevdf_init(scheduler_t *s);
+
+#endif // EEVDF_H
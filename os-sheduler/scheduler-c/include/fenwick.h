@@ -0,0 +1,38 @@
+#ifndef FENWICK_H
+#define FENWICK_H
+
+#include <stddef.h>
+#include "process.h"
+
+/* Ticket tree of the lottery scheduler: a Fenwick (binary indexed) tree
+ * over the ticket counts of the processes in slots 0..len-1. Adding a
+ * process, taking one out and finding the holder of a given ticket are
+ * O(log n). Slots stay packed: taking a process out moves the last one
+ * into its slot.
+ */
+
+typedef struct {
+    process_t **v;          // process in each slot
+    unsigned long *w;       // its tickets
+    unsigned long *sum;     // partial sums, 1-based, cap + 1 entries
+    size_t len;
+    size_t cap;             // a power of two
+    unsigned long total;    // tickets of all len processes
+} fenwick_t;
+
+void fenwick_init(fenwick_t *f);
+
+/* Returns 0 on success, -1 if the tree could not grow (p is not added) */
+int fenwick_push(fenwick_t *f, process_t *p, unsigned long tickets);
+
+/* Slot of the process holding ticket r, 0 <= r < total: tickets are
+ * numbered through the slots in order */
+size_t fenwick_find(const fenwick_t *f, unsigned long r);
+
+/* Remove and return the process in slot i */
+process_t *fenwick_take(fenwick_t *f, size_t i);
+
+/* Release the arrays; the processes still in the tree are not freed */
+void fenwick_free(fenwick_t *f);
+
+#endif // FENWICK_H
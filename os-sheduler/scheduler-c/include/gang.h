@@ -0,0 +1,78 @@
+#ifndef GANG_H
+#define GANG_H
+
+#include "smp.h"
+
+/* Gang scheduling of parallel jobs on the multi-CPU model (ALG_GANG), after
+ * Ousterhout's matrix. A job that needs k CPUs at once ("cpus" in the
+ * workload, see process_t.width) has k threads, each pinned to a CPU and
+ * each doing the job's burst. The threads synchronise every tick: a thread
+ * gets at most a tick of work ahead of its slowest sibling and then spins
+ * on its CPU, and the burst advances with the slowest thread (so a gang
+ * runs at the speed of its slowest CPU).
+ *
+ * The matrix has one column per CPU and one row per time slot. A job gets
+ * k free cells side by side in the first row that has them (first fit), or
+ * a new row; with max_rows rows in use, jobs that do not fit queue (in
+ * arrival order, any that fits goes) until a job leaves. Rows left empty
+ * are dropped. The rows take turns for slice ticks each, so the threads of
+ * a gang are dispatched together:
+ *
+ *   strict  only the jobs of the active row run;
+ *   fill    CPUs the active row leaves free run jobs of the other rows
+ *           whose cells are all free (alternate selection);
+ *   none    no coordination: each CPU time-slices the jobs of its column
+ *           on its own, so threads spin (scheduler_t.sync_ticks) while a
+ *           sibling waits for its CPU, which is what gangs avoid.
+ *
+ * A job blocked on I/O keeps its cells, and I/O is served without device
+ * contention. A thread dispatched on its CPU pays the switch cost and the
+ * cache refill (see scheduler_charge_dispatch) as a job would, its siblings
+ * spinning meanwhile; the stall does not use up the slice. Threads never
+ * migrate.
+ *
+ * Every CPU tick is busy (running or spinning), fragmented (idle while a
+ * job waits: a free cell, or one a thread could not use), held (idle in a
+ * cell of a job doing I/O) or idle (nothing to run).
+ */
+
+#define GANG_SLICE_DEFAULT 10UL
+
+typedef enum {
+    COSCHED_STRICT,
+    COSCHED_FILL,
+    COSCHED_NONE
+} cosched_t;
+
+typedef struct gang_t {
+    cosched_t mode;
+    unsigned long slice;     // ticks per row (per CPU with none)
+    int max_rows;            // rows the matrix may grow to (0 = no limit)
+
+    /* results */
+    int rows_peak;
+    unsigned long ticks;     // ticks the matrix held jobs
+    unsigned long row_ticks; // rows in use, summed over those ticks
+    unsigned long row_switches;
+    unsigned long queued;    // jobs that waited for room in the matrix
+    unsigned long queue_wait;// ticks they waited
+    unsigned long queue_wait_max;
+    unsigned long fill_ticks;// CPU ticks of jobs outside the active row (fill)
+    unsigned long frag_ticks;
+    unsigned long held_ticks;
+    unsigned long idle_ticks;
+} gang_t;
+
+void gang_init(gang_t *g);
+const char *gang_mode_name(cosched_t mode);
+
+/* "strict", "fill" or "none"; -1 if unknown */
+int gang_parse_mode(const char *name);
+
+/* Run pending (sorted by arrival, owned) to completion on the CPUs of m
+ * with the matrix of m->gang; called by smp_run. Jobs finish on the
+ * scheduler of their first CPU. Returns the number of processes injected.
+ */
+int gang_run(smp_t *m, process_t **pending, int count);
+
+#endif // GANG_H
@@ -0,0 +1,119 @@
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "process.h"
+#include "mlq.h"
+
+struct scheduler_t;
+
+/* Hierarchical fair share (ALG_HFS), after cgroup cpu.weight.
+ *
+ * Jobs belong to groups named by a path ("tenant/web"); the path's prefixes
+ * are the group's ancestors and every group has a weight (1..10000, 100 by
+ * default). CPU time is split between sibling groups with runnable jobs in
+ * proportion to their weights, level by level from the top; inside a leaf
+ * group its jobs share the leaf's part under an ordinary policy (the MLQ
+ * class policies, see mlq.h).
+ *
+ * Each group carries a virtual runtime, the CPU time its subtree received
+ * divided by its weight. The scheduler walks down from the root, taking at
+ * every level the runnable child with the smallest virtual runtime, and
+ * gives the leaf it reaches the CPU for a group slice before walking again.
+ * A group that becomes runnable starts no lower than the smallest virtual
+ * runtime of its runnable siblings, so time spent idle earns no credit.
+ *
+ * Jobs sit in leaf groups only: a job naming a group that has subgroups is
+ * placed in its "." subgroup, weighted like any other child.
+ *
+ * Bandwidth control, after cgroup cpu.max: a group with a quota may hold
+ * the CPU for quota ticks per period (periods are aligned on multiples of
+ * the period from tick 0), counting its subgroups' time. Once it has used
+ * its quota, its subtree is throttled, i.e. skipped by the walk, until the
+ * next period starts; a running job is preempted at the start of the next
+ * tick. A group's throttled time runs from the first tick it was refused the
+ * CPU to the start of the next period.
+ */
+
+#define GROUP_WEIGHT_DEFAULT 100
+#define GROUP_WEIGHT_MAX 10000
+#define GROUP_PATH_MAX 64
+#define GROUP_PERIOD_DEFAULT 100
+
+typedef struct {
+    char path[GROUP_PATH_MAX];
+    int parent;              // -1 for the root
+    int first_child;         // -1 if none
+    int next_sibling;
+    unsigned long weight;
+    unsigned long long vruntime; // service received, in GROUP_SCALE / weight per tick
+    size_t nr_runnable;      // runnable jobs in the subtree, running included
+    mlq_class_t leaf;        // leaf groups: ready queue under the leaf policy
+    unsigned long cpu_ticks; // ticks the subtree's jobs held the CPU
+    unsigned long runnable_ticks; // ticks the subtree had a runnable job
+    double share;            // CPU share its weight entitled it to at the last tick
+    double due;              // ticks of CPU its weight entitled it to while runnable
+
+    /* bandwidth control (quota 0 = no limit) */
+    unsigned long quota;
+    unsigned long period;
+    unsigned long runtime;   // quota left in the current period
+    unsigned long period_idx;// current period (tick / period)
+    int throttled;
+    unsigned long throttled_since;
+    unsigned long nr_periods;    // periods in which it used the CPU
+    unsigned long nr_throttled;  // periods in which it was throttled
+    unsigned long throttled_ticks;
+} group_t;
+
+typedef struct {
+    group_t *v;              // v[0] is the root, parents come before children
+    int n;
+    int cap;
+    mlq_class_t policy;      // leaf policy (policy and quantum)
+    unsigned long slice;     // ticks of work a leaf gets before the next walk
+    unsigned long slice_left;
+    size_t queued;           // processes in all leaf queues
+    int bandwidth;           // some group has a quota
+    unsigned long throttled_idle; // ticks the CPU idled with only throttled work
+} group_tree_t;
+
+void group_init(group_tree_t *t);
+
+/* Index of the group at path, created with its missing ancestors if need
+ * be (create = 1). Leading, trailing and repeated slashes are ignored; ""
+ * is the root. Returns -1 if it does not exist (or cannot be created).
+ */
+int group_lookup(group_tree_t *t, const char *path, int create);
+
+/* The group a job naming group g runs in: g itself if it is a leaf,
+ * else its "." subgroup (created if need be). -1 if out of memory.
+ */
+int group_leaf(group_tree_t *t, int g);
+
+/* Parse a cpu.max value, "QUOTA [PERIOD]" or "max [PERIOD]" (PERIOD defaults
+ * to GROUP_PERIOD_DEFAULT; quota 0 stands for max). Returns 0 or -1.
+ */
+int group_parse_max(const char *s, unsigned long *quota, unsigned long *period);
+
+/* Set the limit of group g (quota 0 = none) */
+void group_set_max(group_tree_t *t, int g, unsigned long quota, unsigned long period);
+
+/* Apply --cpu-max=PATH=QUOTA[/PERIOD],... to existing groups. Returns 0, or
+ * -1 on a malformed entry; unknown groups are reported and skipped. */
+int group_apply_max(group_tree_t *t, const char *spec);
+
+/* Deep copy of src's groups and settings into dst (dst's own arrays are
+ * released first); the copies start with empty queues. 0 or -1. */
+int group_copy(group_tree_t *dst, const group_tree_t *src);
+
+/* Per-tick handler (ALG_HFS) */
+void hfs_tick(struct scheduler_t *s);
+
+/* p stops being runnable on s (burst done, or moved to another CPU) */
+void hfs_leave(struct scheduler_t *s, process_t *p);
+
+/* Free every process left in the leaf queues, and the groups (scheduler
+ * teardown) */
+void group_clear(struct scheduler_t *s);
+
+#endif // GROUP_H
@@ -0,0 +1,42 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include <stddef.h>
+#include "process.h"
+
+/* Binary min-heap of processes, ordered by a less function. Each process
+ * records its slot in heap_idx, so it can be removed or re-keyed in
+ * O(log n) without a search. A process is in at most one heap at a time.
+ */
+
+typedef int (*heap_less_fn)(const process_t *a, const process_t *b);
+
+typedef struct {
+    process_t **v;
+    size_t len;
+    size_t cap;
+    heap_less_fn less;
+} heap_t;
+
+void heap_init(heap_t *h, heap_less_fn less);
+
+/* Returns 0 on success, -1 if the heap could not grow (p is not added) */
+int heap_push(heap_t *h, process_t *p);
+
+/* Remove and return the smallest process (NULL if empty) */
+process_t *heap_pop(heap_t *h);
+
+static inline process_t *heap_peek(const heap_t *h) {
+    return h->len ? h->v[0] : NULL;
+}
+
+/* Remove p, which must be in h */
+void heap_remove(heap_t *h, process_t *p);
+
+/* Restore the order after p's key changed */
+void heap_fix(heap_t *h, process_t *p);
+
+/* Release the array; the processes still in it are not freed */
+void heap_free(heap_t *h);
+
+#endif // HEAP_H
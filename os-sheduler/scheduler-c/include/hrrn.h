@@ -0,0 +1,21 @@
+#ifndef HRRN_H
+#define HRRN_H
+
+#include "scheduler.h"
+
+/* Per-tick handler for non-preemptive Highest Response Ratio Next.
+ *
+ * When the CPU is free, the ready process with the highest
+ * (waiting + burst) / burst runs to the end of its CPU burst, waiting
+ * being counted from the tick it last became ready. Short jobs go first
+ * like SJF, but a long job's ratio keeps growing while it waits, so it
+ * cannot starve. Ready processes sit in a kinetic tournament (s->hrrn, see
+ * kinetic.h), so a dispatch only revisits the pairs whose order changed
+ * since the last one instead of recomputing every ratio.
+ */
+void hrrn_tick(scheduler_t *s);
+
+/* Free every process left in s->hrrn, and the index (scheduler teardown) */
+void hrrn_clear(scheduler_t *s);
+
+#endif // HRRN_H
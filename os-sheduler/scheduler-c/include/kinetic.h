@@ -0,0 +1,57 @@
+#ifndef KINETIC_H
+#define KINETIC_H
+
+#include <stddef.h>
+#include "process.h"
+
+/* Kinetic tournament of processes by response ratio, the index of HRRN.
+ *
+ * A process that became ready at tick e with a burst of b ticks has, at
+ * tick t, the ratio (t - e + b) / b = 1 + (t - e) / b: a line in t with
+ * slope 1/b. Two lines cross at most once, so the order of two processes
+ * changes at most once, when the one with the shorter burst catches up.
+ *
+ * The tree is a tournament over slots 0..len-1: every internal node holds
+ * the leader of its subtree at the current tick and the tick at which the
+ * leader of its other child overtakes it (its certificate), plus the
+ * earliest certificate in its subtree. Moving time forward replays only the
+ * nodes whose certificates expired, bottom up; nothing is recomputed for
+ * processes whose relative order still holds. Adding or removing a process
+ * is O(log n). Slots stay packed: removing a process moves the last one
+ * into its slot.
+ *
+ * Ties on the ratio go to the process that became ready first, then to
+ * the earlier arrival, then to the lower pid.
+ */
+
+typedef struct {
+    process_t **v;          // process in each slot
+    unsigned long *since;   // tick it became ready
+    unsigned long *burst;   // its burst length (at least 1)
+    size_t *win;            // per node (1-based, leaves at cap + slot): slot of the leader
+    unsigned long *expire;  // per node: tick its leader stops leading (ULONG_MAX = never)
+    unsigned long *min_expire; // per node: earliest expire in its subtree
+    size_t len;
+    size_t cap;             // a power of two
+    unsigned long now;      // tick the leaders are valid for
+} kinetic_t;
+
+void kinetic_init(kinetic_t *k);
+
+/* Add p, ready since tick 'since' with a burst of 'burst' ticks, at tick
+ * now (not before the last now). Returns 0 on success, -1 if the tree could
+ * not grow (p is not added).
+ */
+int kinetic_push(kinetic_t *k, process_t *p, unsigned long since, unsigned long burst, unsigned long now);
+
+/* Remove and return the process with the highest response ratio at tick
+ * now (NULL if empty) */
+process_t *kinetic_pop(kinetic_t *k, unsigned long now);
+
+/* Remove and return the process in slot len - 1 (teardown, any order) */
+process_t *kinetic_take_last(kinetic_t *k);
+
+/* Release the arrays; the processes still in the tree are not freed */
+void kinetic_free(kinetic_t *k);
+
+#endif // KINETIC_H
@@ -0,0 +1,96 @@
+#ifndef LOCK_H
+#define LOCK_H
+
+#include "process.h"
+
+struct scheduler_t;
+
+/* Critical sections on named resources (mutexes).
+ *
+ * A job lists its sections as offsets into its CPU work: "db@2+5" enters
+ * resource db once it has done 2 ticks of CPU work and leaves it 5 ticks of
+ * work later, or at the end of the CPU burst if that comes first (nobody
+ * holds a resource across I/O). A job's sections do not overlap, so it holds
+ * at most one resource at a time and cannot deadlock.
+ *
+ * A job reaching a section whose resource is held blocks in PROC_WAITING on
+ * the resource until the owner leaves; the resource is then handed to one
+ * waiter, which becomes ready. Waiters are handed the resource in priority
+ * order under priority and priority_p, in blocking order otherwise.
+ *
+ * Under priority and priority_p a protocol can bound priority inversion:
+ *   LOCK_INHERIT  the owner runs at the best priority of its waiters
+ *   LOCK_CEILING  the owner runs at the resource's ceiling, the best
+ *                 priority of every job using it, from the moment it enters
+ *
+ * Each job's blocked time is the ticks it spent waiting on resources; its
+ * inversion time is the part of that during which a job of lower (base)
+ * priority other than the owner held the CPU, i.e. the unbounded part.
+ */
+
+typedef enum {
+    LOCK_NONE,
+    LOCK_INHERIT,
+    LOCK_CEILING
+} lock_protocol_t;
+
+#define LOCK_NAME_MAX 32
+#define LOCK_MAX_SECTIONS 64
+
+typedef struct {
+    char name[LOCK_NAME_MAX];
+    int ceiling;             // best (lowest) priority of the jobs using it
+    process_t *owner;
+    process_t *waiters;      // blocked jobs, in blocking order
+    unsigned long acquired_at;
+    unsigned long acquisitions;
+    unsigned long contended; // acquisitions that had to wait
+    unsigned long hold_ticks;// ticks it was held, owner running or not
+    unsigned long blocked_ticks;
+    unsigned long blocked_max;
+    unsigned long inversion_ticks;
+} resource_t;
+
+typedef struct {
+    resource_t *v;
+    int n;
+    int cap;
+    lock_protocol_t protocol;
+    size_t blocked;          // jobs blocked on a resource
+    unsigned long spin_ticks;// ticks a dispatched job spent finding its resource held
+} lock_table_t;
+
+void lock_init(lock_table_t *t);
+
+/* Parse a section list, "RESOURCE@AT+HOLD" separated by commas, into out
+ * (at most max), creating the resources and lowering their ceilings to
+ * priority. Returns the number of sections, or -1 on a malformed spec.
+ */
+int lock_parse_sections(lock_table_t *t, const char *spec, int priority, crit_section_t *out, int max);
+
+/* "none" / "inherit" / "ceiling", and parsing of --lock-protocol= (-1 if unknown) */
+const char *lock_protocol_name(lock_protocol_t p);
+int lock_parse_protocol(const char *name);
+
+/* p is about to do a tick of work (scheduler_consume): enter the section
+ * it has reached. Returns 0 if its resource is held, so the tick is lost.
+ */
+int lock_enter(struct scheduler_t *s, process_t *p);
+
+/* p did work: leave its section once the hold is done */
+void lock_progress(struct scheduler_t *s, process_t *p);
+
+/* p held the CPU this tick while jobs were blocked: charge inversion */
+void lock_charge(struct scheduler_t *s, const process_t *p);
+
+/* After the policy's tick: s->running enters the section it has reached,
+ * or blocks on its resource */
+void lock_tick(struct scheduler_t *s);
+
+/* p's CPU burst ended: leave the section it is in */
+void lock_burst_end(struct scheduler_t *s, process_t *p);
+
+/* Free the blocked jobs and the resources (scheduler teardown) */
+void lock_clear(struct scheduler_t *s);
+
+#endif // LOCK_H
@@ -0,0 +1,47 @@
+#ifndef LOTTERY_H
+#define LOTTERY_H
+
+#include "scheduler.h"
+
+/* Proportional-share schedulers. Each process holds tickets, the CFS load
+ * weight of its priority used as nice (see cfs.h), so a lower priority
+ * number buys a larger share. The running process keeps the CPU for a
+ * quantum (the positional quantum argument, 1 tick if none given); at the
+ * end of it, or when it blocks or finishes, the next one is chosen.
+ *
+ * Lottery draws a ticket at random (splitmix64, seeded per CPU) from a
+ * Fenwick tree over the ready processes' tickets (s->lottery, see
+ * fenwick.h), so a draw is O(log n). The running process takes part in the
+ * draw at the end of its quantum and keeps the CPU without a switch if it
+ * wins again.
+ *
+ * Stride gives every process a pass value that advances by its stride,
+ * STRIDE1 / tickets, for each tick it holds the CPU; the ready process
+ * with the smallest pass runs (s->heap, see heap.h). A process that joins
+ * or comes back from I/O starts no lower than the smallest pass among the
+ * runnable processes, so time spent blocked earns no credit.
+ *
+ * Both track the share each process is entitled to: for every tick it is
+ * runnable, tickets / tickets of all runnable processes (running
+ * included). The summary compares it with the share actually received.
+ */
+void lottery_tick(scheduler_t *s);
+void stride_tick(scheduler_t *s);
+
+#define STRIDE1 (1ULL << 32)
+
+/* Tickets of a process with the given priority */
+unsigned long lottery_tickets(int priority);
+
+/* Set up s->heap ordered by pass (scheduler_create) */
+void stride_init(scheduler_t *s);
+
+/* p stops being runnable on s (burst done, or moved to another CPU):
+ * settle the share it was entitled to since it joined */
+void lottery_leave(scheduler_t *s, process_t *p);
+
+/* Free every process left in the run queue, and the run queue (scheduler
+ * teardown, lottery and stride) */
+void lottery_clear(scheduler_t *s);
+
+#endif // LOTTERY_H
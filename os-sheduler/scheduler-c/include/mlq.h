@@ -0,0 +1,96 @@
+#ifndef MLQ_H
+#define MLQ_H
+
+#include "process.h"
+
+struct scheduler_t;
+
+/* Multi-level queue: jobs are mapped to fixed classes, each class keeps its
+ * own ready queue and runs its own policy on it, and an arbiter decides
+ * which class gets the CPU. Unlike MLFQ, a job never changes class.
+ *
+ * A job goes to the class named by its workload "class" key, else to the
+ * first class whose priority range holds its priority, else to the last
+ * class.
+ */
+
+typedef enum {
+    MLQ_FCFS,
+    MLQ_SJF,
+    MLQ_SRTF,
+    MLQ_PRIORITY,
+    MLQ_PRIORITY_P,
+    MLQ_RR
+} mlq_policy_t;
+
+/* Classes arbitration:
+ *   MLQ_STRICT  the first class with ready work runs; a job arriving in a
+ *               higher class preempts a lower class immediately
+ *   MLQ_SLICE   classes take turns, each getting up to share ticks of
+ *               work per round (stalls do not count); classes with no work
+ *               are skipped
+ */
+typedef enum {
+    MLQ_STRICT,
+    MLQ_SLICE
+} mlq_arbiter_t;
+
+#define MLQ_MAX_CLASSES 16
+
+typedef struct {
+    char name[32];
+    mlq_policy_t policy;
+    int quantum;             // MLQ_RR slice (ticks)
+    int lo, hi;              // priority range (lo > hi = none)
+    unsigned long share;     // MLQ_SLICE: ticks per round
+    process_t *head;         // ready queue, in arrival order
+    size_t queued;
+    unsigned long cpu_ticks; // ticks its jobs held the CPU
+} mlq_class_t;
+
+typedef struct {
+    mlq_class_t classes[MLQ_MAX_CLASSES];
+    int n;
+    size_t queued;           // processes in all class queues
+    mlq_arbiter_t arbiter;
+    int turn;                // MLQ_SLICE: class whose turn it is
+    unsigned long budget;    // MLQ_SLICE: ticks of work left in that turn
+} mlq_t;
+
+/* Parse a class list, "name:policy[:range[:share]]" separated by commas.
+ * policy is fcfs, sjf, srtf, priority, priority_p or rrN (quantum N);
+ * range is "lo..hi", "lo..", "..hi" or a single priority; share defaults
+ * to 10. Returns 0 on success, -1 on a malformed spec.
+ */
+int mlq_parse(const char *spec, mlq_t *m);
+
+/* "strict" / "slice", and parsing of --mlq-arbiter= (-1 if unknown) */
+const char *mlq_arbiter_name(mlq_arbiter_t a);
+int mlq_parse_arbiter(const char *name);
+const char *mlq_policy_name(const mlq_class_t *c);
+
+/* Index of the class called name, -1 if there is none */
+int mlq_find(const mlq_t *m, const char *name);
+
+/* Parse one policy name (len chars of s) into c->policy and c->quantum */
+int mlq_parse_policy(const char *s, size_t len, mlq_class_t *c);
+
+/* Class queues, also the leaf queues of the group scheduler (see group.h).
+ * mlq_enqueue() adds p at the tail, or at the head when p only gave way to
+ * another queue and keeps its place. mlq_peek() is the process c's policy
+ * runs next, and mlq_take() removes it, charging its time in the queue to
+ * waited_total. mlq_preempts() is 1 if a takes the CPU from b under a
+ * preemptive policy (srtf, priority_p; ties do not preempt).
+ */
+void mlq_enqueue(mlq_class_t *c, process_t *p, int at_head);
+process_t *mlq_peek(const mlq_class_t *c);
+process_t *mlq_take(struct scheduler_t *s, mlq_class_t *c);
+int mlq_preempts(const mlq_class_t *c, const process_t *a, const process_t *b);
+
+/* Per-tick handler (ALG_MLQ) */
+void mlq_tick(struct scheduler_t *s);
+
+/* Free every process left in the class queues (scheduler teardown) */
+void mlq_clear(struct scheduler_t *s);
+
+#endif // MLQ_H
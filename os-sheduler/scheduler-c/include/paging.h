@@ -0,0 +1,99 @@
+#ifndef PAGING_H
+#define PAGING_H
+
+#include "process.h"
+
+struct scheduler_t;
+
+/* Memory pressure on the single-CPU model. A job has a working set (pages,
+ * "working_set" in the workload; forked children have none) and the host
+ * capacity pages of memory. From its arrival until it finishes a job is
+ * loaded, its working set part of the demand on memory, unless it is
+ * swapped out; I/O does not unload it.
+ *
+ * While the demand exceeds the capacity the pages are shared out in
+ * proportion (global replacement): every loaded job has capacity/demand of
+ * its working set resident and faults on the rest. A tick of work by a job
+ * missing a fraction m of its working set costs fault_cost * m more ticks
+ * stalled on page faults, so past the capacity each job added slows down
+ * every job, and useful work collapses (thrashing).
+ *
+ * A swap policy keeps the demand within the capacity instead, by swapping
+ * out loaded jobs other than the running one (nor one still reading its
+ * working set back, nor the last loaded job):
+ *   none      never: every job stays loaded;
+ *   largest   the largest working set first;
+ *   newest    the latest arrival first;
+ *   priority  the worst priority first.
+ * Ties go to the latest arrival. A swapped-out job keeps its place in the
+ * policy's queues, but once dispatched it faults for a tick and blocks
+ * (PROC_WAITING, job_blocked "swapped"). Swapped-out jobs come back in the
+ * order they left, each when its working set fits in the free memory, or
+ * when nothing is runnable and the I/O device is idle (forced); one that had
+ * run first spends working_set / swap_rate ticks (rounded up) reading its
+ * working set back.
+ */
+
+#define PAGING_FAULT_COST_DEFAULT 10.0
+#define PAGING_SWAP_RATE_DEFAULT 8UL
+
+typedef enum {
+    SWAP_NONE,
+    SWAP_LARGEST,
+    SWAP_NEWEST,
+    SWAP_PRIORITY
+} swap_policy_t;
+
+typedef struct {
+    unsigned long capacity;  // pages (0 = memory is not modelled)
+    swap_policy_t policy;
+    double fault_cost;       // ticks stalled per tick of work with none of the working set resident
+    unsigned long swap_rate; // pages read back per tick (0 = swap-ins are free)
+
+    process_t **jobs;        // loaded or swapped out: arrived, not finished, with a working set
+    int njobs, cap;
+    unsigned long demand;    // working sets of the loaded jobs
+    int loaded;
+    process_t **out;         // swapped out, oldest first (ring)
+    int out_head, nout, out_cap;
+    process_t *parked;       // of those, the jobs blocked on it
+
+    /* results */
+    unsigned long demand_peak;
+    int loaded_peak;
+    unsigned long long loaded_sum;   // loaded jobs summed over the ticks
+    unsigned long over_ticks;        // ticks the demand exceeded the capacity
+    unsigned long fault_ticks;       // ticks stalled on page faults
+    unsigned long swap_ticks;        // ticks reading working sets back
+    unsigned long swap_outs;
+    unsigned long swap_ins;
+    unsigned long forced_ins;        // swap-ins that did not fit
+    unsigned long long pages_out;
+} paging_t;
+
+void paging_init(paging_t *m);
+
+/* "none", "largest", "newest" or "priority"; -1 if unknown */
+int paging_parse_policy(const char *name);
+const char *paging_policy_name(swap_policy_t p);
+
+/* p arrived: it is loaded */
+void paging_arrive(struct scheduler_t *s, process_t *p);
+
+/* p finished: its memory is freed */
+void paging_leave(struct scheduler_t *s, process_t *p);
+
+/* p is about to do a tick of work (scheduler_consume). Returns 1 if the
+ * tick is lost instead: p is swapped out, reading its working set back or
+ * faulting. */
+int paging_stall(struct scheduler_t *s, process_t *p);
+
+/* After the policy's tick: s->running blocks if it is swapped out, jobs are
+ * swapped out while the demand exceeds the capacity, and swapped back in
+ * while they fit */
+void paging_tick(struct scheduler_t *s);
+
+/* Free the jobs blocked on swap and the tables (scheduler teardown) */
+void paging_clear(struct scheduler_t *s);
+
+#endif // PAGING_H
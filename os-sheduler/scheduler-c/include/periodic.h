@@ -0,0 +1,72 @@
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+#include <stddef.h>
+#include "timer.h"
+#include "process.h"
+
+struct scheduler_t;
+
+/* A periodic task releases a job of wcet ticks every period ticks, starting
+ * at offset; each job should finish within deadline ticks of its release.
+ * Jobs are created one release at a time by the task's timer, so a long
+ * horizon costs nothing until it is simulated. All jobs of a task share
+ * its pid.
+ */
+typedef struct {
+    int pid;
+    int priority;
+    unsigned long period;
+    unsigned long wcet;
+    unsigned long offset;
+    unsigned long deadline;      // relative to the release
+    unsigned long wcrt;          // worst-case response time from the analysis (0 = above deadline)
+    unsigned long next_release;
+    unsigned long released;
+    unsigned long completed;
+    unsigned long missed;
+    unsigned long response_total;
+    unsigned long start_total;   // sum of start - release
+    unsigned long response_max;
+    timer_node_t timer;          // next release (TIMER_RELEASE)
+} periodic_task_t;
+
+/* Longest stretch of releases simulated by default: the hyperperiod, or
+ * this many ticks if the hyperperiod is longer */
+#define PERIODIC_HORIZON_MAX 2000000000UL
+
+/* Schedulability of the task set under rate-monotonic priorities */
+typedef struct {
+    size_t ntasks;
+    double utilization;          // sum of wcet / period
+    double ll_bound;             // Liu-Layland bound n (2^(1/n) - 1)
+    unsigned long long hyperperiod; // lcm of the periods (0 if above PERIODIC_HORIZON_MAX)
+    unsigned long max_offset;
+    int rta_schedulable;         // every task's wcrt is within its deadline
+} periodic_analysis_t;
+
+/* Analyse tasks[0..n) for rate-monotonic priorities (shorter period first,
+ * then lower pid): utilization against the Liu-Layland bound, and
+ * response-time analysis, which sets each task's wcrt; deadlines may
+ * exceed the period, the jobs of a task then running in release order. The
+ * analysis assumes a critical instant, so it ignores offsets.
+ */
+void periodic_analyze(periodic_task_t *tasks, size_t n, periodic_analysis_t *a);
+
+/* "pass" (U <= bound: RM-schedulable), "inconclusive" (bound < U <= 1) or
+ * "fail" (U > 1: no policy can meet every deadline) */
+const char *periodic_ll_verdict(const periodic_analysis_t *a);
+
+/* Hand tasks (ownership included) to s and arm their first releases; no
+ * job is released at or after horizon */
+void periodic_start(struct scheduler_t *s, periodic_task_t *tasks, size_t n, unsigned long horizon);
+
+/* TIMER_RELEASE handler: release the task's next job and re-arm */
+void periodic_release(struct scheduler_t *s, periodic_task_t *t);
+
+/* Account a finished job of a periodic task to the task, keeping its
+ * turnaround for the run's percentiles; returns 0 (and does nothing) for an
+ * aperiodic process */
+int periodic_job_done(struct scheduler_t *s, const process_t *p);
+
+#endif // PERIODIC_H
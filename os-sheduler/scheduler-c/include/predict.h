@@ -0,0 +1,39 @@
+#ifndef PREDICT_H
+#define PREDICT_H
+
+#include "scheduler.h"
+
+/* CPU-burst prediction for SJF/SRTF. With PREDICT_EXACT the policies see
+ * the true burst and remaining time; otherwise they see an estimate made
+ * when the burst starts:
+ *
+ *   PREDICT_EMA    per process: tau(n+1) = alpha * t(n) + (1 - alpha) * tau(n),
+ *                  with tau(0) = s->tau0 for every new process
+ *   PREDICT_CLASS  per priority class: the same average, but fed by every
+ *                  burst of every process of that priority (classes are
+ *                  priorities clamped to 0..PREDICT_CLASSES-1)
+ *
+ * The estimated remaining time is the estimate minus the ticks already
+ * run, but at least 1, so a job that outruns its estimate stays runnable.
+ */
+
+/* Called when p starts a CPU burst (scheduler_add_process) */
+void predict_burst_start(scheduler_t *s, process_t *p);
+
+/* Called when p completes a CPU burst: scores the estimate, feeds the average */
+void predict_burst_end(scheduler_t *s, process_t *p);
+
+/* What the policy may see of p's current burst */
+int predict_burst(const scheduler_t *s, const process_t *p);
+int predict_remaining(const scheduler_t *s, const process_t *p);
+
+/* Account the cost of a decision: chosen was dispatched while ready jobs
+ * with a shorter true remaining time waited (a no-op in exact mode).
+ */
+void predict_note_choice(scheduler_t *s, const process_t *chosen);
+
+/* Name used in the summary, and parsing of --predict= (-1 if unknown) */
+const char *predict_mode_name(predict_mode_t mode);
+int predict_parse_mode(const char *name);
+
+#endif // PREDICT_H
@@ -3,6 +3,8 @@
 
 #include <sys/types.h>
 #include <limits.h>
+#include "timer.h"
+#include "rbtree.h"
 
 typedef enum {
     PROC_NEW,
@@ -12,15 +14,31 @@ typedef enum {
     PROC_TERMINATED
 } proc_state_t;
 
+/* A critical section on a named resource (see lock.h) */
+typedef struct {
+    int resource;            // index in the scheduler's lock table
+    int at;                  // CPU ticks of work the job has done when it enters
+    int hold;                // CPU ticks of work done inside
+} crit_section_t;
+
+/* Children a job forks at a point of its CPU work (see spawn.h) */
+typedef struct {
+    int at;                  // CPU ticks of work the job has done when it forks
+    int burst;               // CPU burst of each child
+    int count;               // children forked
+    int wait;                // the job blocks until these children finish
+    int first_pid;           // pid of the first child; the others follow
+} fork_spec_t;
+
 typedef struct process_t {
     int pid;                 // logical PID used by scheduler (user-specified)
     unsigned int arrival;    // arrival time (ticks)
-    int burst;               // total CPU burst time (ticks)
-    int remaining;           // remaining time (ticks)
+    int burst;               // current CPU burst time (ticks); the only one for single-burst jobs
+    int remaining;           // remaining time of the current CPU burst (ticks)
     int priority;            // numerical priority (lower = higher priority)
     pid_t os_pid;            // actual OS PID (for real-process mode); 0 if unused
     proc_state_t state;      // current state
-    int quantum_left;        // remaining quantum (for RR / MLFQ)
+    int quantum_left;        // slice length given at dispatch (RR / MLFQ); 0 once the slice timer fired
     int mlfq_level;          // current MLFQ level (0 = highest priority)
     unsigned int waited;     // ticks waited in ready queue (aging) — legacy field
     unsigned int start_time; // first tick when process started running (UINT_MAX if not started)
@@ -30,12 +48,138 @@ typedef struct process_t {
     unsigned int waited_total;       // total time spent waiting (sum of ready intervals)
     unsigned int last_enqueued_tick; // tick when it was last put into ready queue (UINT_MAX if not in queue)
 
+    int cpu;                 // CPU the process is placed on (multi-CPU model); -1 if none
+    unsigned int work_acc;   // partial work unit accumulated on non-nominal cores (x100)
+    unsigned int run_ticks;  // ticks spent holding a CPU
+    int last_cpu;            // CPU of the last dispatch (-1 before the first)
+    unsigned long cache_mark;// CPU busy_ticks minus run_ticks at that dispatch
+
+    /* CPU/I-O burst sequence: bursts[] alternates CPU, I/O, CPU, ... and
+     * starts and ends with a CPU burst. NULL for single-burst jobs. */
+    int *bursts;
+    int nbursts;
+    int burst_idx;           // index of the current burst in bursts[]
+    int cpu_total;           // sum of CPU bursts
+    int io_total;            // sum of I/O bursts
+    int io_left;             // remaining service of the current I/O burst
+    unsigned int io_enqueued_tick; // tick it joined the I/O device queue
+    int *io_blocks;          // block address of each I/O burst (NULL: all block 0)
+    int nio_blocks;
+    int io_block;            // block of the current I/O request
+    timer_node_t timer;      // pending arrival or I/O completion
+    double tau;              // predicted length of the next CPU burst (-1 = no history)
+    int estimate;            // estimate of the current CPU burst (-1 = none)
+    rb_node_t rb;            // run-queue tree link (CFS, EEVDF)
+    unsigned long long vruntime; // weighted run time, 1/1024 ticks
+    unsigned int slice_ran;  // ticks run since the last dispatch
+    unsigned long long vdeadline;    // EEVDF virtual deadline, 1/1024 ticks
+    unsigned long long min_deadline; // earliest vdeadline in p's rq subtree (EEVDF)
+    long long vlag;          // EEVDF: V - vruntime when it last left the queue
+    double max_lag;          // largest |lag| seen when scheduled, in ticks of service
+    unsigned long wake_tick; // tick it last became runnable (arrival or I/O)
+    int woken;               // runnable since wake_tick, not dispatched yet
+    unsigned int wakeups;    // wake-to-dispatch latencies measured
+    unsigned long latency_total;
+    unsigned int latency_max;
+    unsigned int deadline;   // absolute tick to finish by (UINT_MAX = none)
+    size_t heap_idx;         // slot in a ready heap (see heap.h)
+    unsigned long period;    // period of its task (0 = aperiodic)
+    int task;                // index of its periodic task in s->tasks (-1 = aperiodic)
+    unsigned long job;       // release number within the task
+    unsigned long long pass; // stride: advances by STRIDE1 / tickets per tick run
+    double share_mark;       // lottery/stride: share clock when it last became runnable
+    double share_due;        // ticks of CPU its tickets entitled it to while runnable
+    unsigned long share_since;// tick it last became runnable
+    unsigned long share_ticks;// ticks it was runnable
+    int mlq_class;           // MLQ: index of its class (-1 = not resolved yet)
+    int group;               // HFS: index of its leaf group (-1 = none)
+
+    /* critical sections, ordered by at and not overlapping (see lock.h) */
+    crit_section_t *cs;
+    int ncs;
+    int cs_next;             // next section to enter
+    int cs_held;             // section it is in (-1 = none)
+    int cpu_done;            // CPU work done so far, over all bursts
+    int base_priority;       // priority without inheritance or ceiling boosts
+    unsigned long lock_since;// tick it blocked on a resource
+    unsigned int lock_blocked;   // ticks spent blocked on resources
+    unsigned int lock_inversion; // of those, ticks a lower-priority job other than the owner ran
+
+    /* job dependencies (see dag.h) */
+    int *after;              // pids of its predecessors
+    int nafter;
+    int dag_idx;             // index in the dependency graph (-1 = none)
+    unsigned long cp_rank;   // critical path from its start: own length plus the longest child path
+    unsigned int released;   // tick its last predecessor finished, or its arrival if later
+
+    /* forks (see spawn.h) */
+    fork_spec_t *forks;      // ordered by at
+    int nforks;
+    int fork_next;           // next fork to make
+    int fork_children;       // children it waits for that have not finished
+    int forked;              // children it forked
+    int ppid;                // pid of the job that forked it (-1 = none)
+    struct process_t *fork_parent; // that job, while it waits for this child
+    unsigned long fork_since;// tick it blocked waiting for children
+    unsigned int fork_wait;  // ticks spent waiting for children
+
+    /* gang scheduling (see gang.h) */
+    int width;               // CPUs it runs on at once (1 = an ordinary job)
+    int gang_row, gang_col;  // its cells in the matrix: row and first of width columns (-1 = none)
+    unsigned long gang_since;// tick it queued for room in the matrix
+    int gang_on;             // threads holding their CPU this tick
+
+    /* cluster batch jobs (see cluster.h) */
+    unsigned int walltime;   // requested run time (0 = its actual run time)
+
+    /* frequency scaling (see dvfs.h) */
+    double energy;           // joules of the CPU ticks it held
+
+    /* memory pressure (see paging.h) */
+    unsigned long working_set; // pages (0 = none)
+    int mem_slot;            // index in the scheduler's memory table (-1 = not in it)
+    int swapped;             // 1 swapped out, 2 and blocked on it
+    unsigned long swap_left; // ticks still to read its working set back
+    double fault_debt;       // page-fault ticks owed by its work so far
+    unsigned int fault_ticks;// ticks stalled on page faults and swap-ins
+    unsigned int swap_outs;
+
+    /* admission control (see admit.h) */
+    int admitted;            // 1 admitted, 2 and shed on its first tick
+
     struct process_t *next;  // linked-list pointer for queues
 } process_t;
 
 /* Create a new process (heap-allocated). Returns NULL on failure. */
 process_t *process_create(int pid, unsigned int arrival, int burst, int priority);
 
+/* Give p an alternating CPU/I-O burst sequence (copied). burst/remaining
+ * become the first CPU burst. Returns 0 on success, -1 on bad input or OOM.
+ */
+int process_set_bursts(process_t *p, const int *bursts, int n);
+
+/* Set the block addresses of p's I/O bursts, in order (copied). Bursts
+ * without an entry use block 0. Returns 0 on success, -1 on bad input or OOM.
+ */
+int process_set_blocks(process_t *p, const int *blocks, int n);
+
+/* Give p its critical sections (copied; n = 0 drops them). Sections must
+ * be ordered by at, not overlap, and start within p's CPU work. Returns 0
+ * on success, -1 on bad input or OOM.
+ */
+int process_set_sections(process_t *p, const crit_section_t *cs, int n);
+
+/* Set the pids of p's predecessors (copied; n = 0 drops them). Returns 0
+ * on success, -1 on OOM.
+ */
+int process_set_after(process_t *p, const int *pids, int n);
+
+/* Give p the forks it makes (copied; n = 0 drops them). Forks must be
+ * ordered by at, start within p's CPU work, and fork at least one child
+ * with a positive burst. Returns 0 on success, -1 on bad input or OOM.
+ */
+int process_set_forks(process_t *p, const fork_spec_t *forks, int n);
+
 /* Duplicate a process (shallow copy for simulation runs). */
 process_t *process_clone(const process_t *src);
 
@@ -0,0 +1,47 @@
+#ifndef RBTREE_H
+#define RBTREE_H
+
+#include <stddef.h>
+
+/* Intrusive red-black tree: embed an rb_node_t in the element and recover
+ * the element with rb_entry(). Insert and erase are O(log n); the leftmost
+ * node is cached so rb_first() is O(1). Equal keys are inserted after the
+ * existing ones, so they come out in insertion order.
+ *
+ * An optional augment callback keeps per-node subtree data (e.g. a subtree
+ * minimum): it recomputes a node from its own value and its children, and
+ * the tree calls it on every node whose subtree changed, bottom-up.
+ */
+
+typedef struct rb_node_t {
+    struct rb_node_t *parent;
+    struct rb_node_t *left;
+    struct rb_node_t *right;
+    int red;
+} rb_node_t;
+
+typedef int (*rb_less_fn)(const rb_node_t *a, const rb_node_t *b);
+typedef void (*rb_augment_fn)(rb_node_t *n);
+
+typedef struct {
+    rb_node_t *root;
+    rb_node_t *leftmost;
+    size_t count;
+    rb_less_fn less;
+    rb_augment_fn augment;   // NULL if the tree is not augmented
+} rb_tree_t;
+
+#define rb_entry(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+
+void rb_init(rb_tree_t *t, rb_less_fn less, rb_augment_fn augment);
+void rb_insert(rb_tree_t *t, rb_node_t *n);
+void rb_erase(rb_tree_t *t, rb_node_t *n);
+
+static inline rb_node_t *rb_first(const rb_tree_t *t) {
+    return t->leftmost;
+}
+
+/* In-order successor, NULL after the last node */
+rb_node_t *rb_next(const rb_node_t *n);
+
+#endif // RBTREE_H
@@ -2,6 +2,20 @@
 #define SCHEDULER_H
 
 #include "process.h"
+#include "timer.h"
+#include "rbtree.h"
+#include "heap.h"
+#include "fenwick.h"
+#include "kinetic.h"
+#include "periodic.h"
+#include "mlq.h"
+#include "group.h"
+#include "lock.h"
+#include "dag.h"
+#include "spawn.h"
+#include "dvfs.h"
+#include "paging.h"
+#include "admit.h"
 
 typedef enum {
     ALG_NONE,
@@ -11,9 +25,37 @@ typedef enum {
     ALG_PRIORITY,
     ALG_PRIORITY_P,
     ALG_RR,
-    ALG_MLFQ
+    ALG_MLFQ,
+    ALG_CFS,
+    ALG_EEVDF,
+    ALG_EDF,
+    ALG_RM,
+    ALG_LOTTERY,
+    ALG_STRIDE,
+    ALG_HRRN,
+    ALG_MLQ,
+    ALG_HFS,
+    ALG_CPF,
+    ALG_GANG,
+    ALG_EASY
 } sched_algo_t;
 
+/* I/O device request scheduling, see disk.h */
+typedef enum {
+    DISK_FIFO,
+    DISK_SCAN,
+    DISK_DEADLINE
+} disk_sched_t;
+
+/* CPU-burst knowledge of SJF/SRTF, see predict.h */
+typedef enum {
+    PREDICT_EXACT,
+    PREDICT_EMA,
+    PREDICT_CLASS
+} predict_mode_t;
+
+#define PREDICT_CLASSES 64
+
 typedef enum {
     EVT_TICK,
     EVT_JOB_STARTED,
@@ -21,9 +63,23 @@ typedef enum {
     EVT_JOB_RESUMED,
     EVT_JOB_FINISHED,
     EVT_CONTEXT_SWITCH,
-    EVT_GANTT_SLICE
+    EVT_GANTT_SLICE,
+    EVT_JOB_BLOCKED,
+    EVT_IO_COMPLETED,
+    EVT_IO_STARTED,
+    EVT_LOCK_ACQUIRED,
+    EVT_JOB_FORKED
 } event_type_t;
 
+/* Timers on scheduler_t.timers, by the kind field of the node. Timers due
+ * on the same tick fire in this order. */
+typedef enum {
+    TIMER_IO_DONE,           // data: process at the head of the I/O device
+    TIMER_SLICE_END,         // data: dispatch sequence number of the slice
+    TIMER_ARRIVAL,           // data: process to inject
+    TIMER_RELEASE            // data: periodic task releasing its next job
+} sched_timer_t;
+
 /* Simple completed-process summary stored by the scheduler for metrics. */
 typedef struct {
     int pid;
@@ -32,6 +88,27 @@ typedef struct {
     unsigned int start_time;
     unsigned int finish_time;
     int priority;
+    int io_time;             // total I/O service (0 for single-burst jobs)
+    unsigned int latency_max;// longest wake-to-dispatch latency
+    double latency_avg;
+    double max_lag;          // EEVDF: largest |lag| when scheduled
+    unsigned int deadline;   // absolute deadline (UINT_MAX = none)
+    unsigned long tickets;   // lottery/stride (0 otherwise)
+    double share_target;     // CPU share its tickets entitled it to while runnable
+    double share_achieved;   // CPU share it received while runnable
+    int mlq_class;           // MLQ: class it ran in (-1 otherwise)
+    int group;               // HFS: leaf group it ran in (-1 otherwise)
+    unsigned int lock_blocked;   // ticks blocked on resources
+    unsigned int lock_inversion; // of those, ticks of unbounded priority inversion
+    unsigned int released;   // tick its predecessors had all finished (UINT_MAX = it had none)
+    int ppid;                // pid of the job that forked it (-1 = none)
+    int forked;              // children it forked
+    unsigned int fork_wait;  // ticks it waited for them
+    int width;               // CPUs it ran on at once
+    double energy;           // joules of its busy ticks (DVFS runs)
+    unsigned long working_set;   // pages (0 = none)
+    unsigned int fault_ticks;    // ticks stalled on page faults and swap-ins
+    unsigned int swap_outs;      // times it was swapped out
 } completed_proc_t;
 
 typedef struct scheduler_t {
@@ -41,6 +118,152 @@ typedef struct scheduler_t {
     process_t *ready_head;
     process_t *running;
 
+    /* I/O device: processes in PROC_WAITING queue in io_head..io_tail (in
+     * arrival order) and disk_policy picks the next one to serve */
+    process_t *io_head;
+    process_t *io_tail;
+    process_t *io_active;          // request being served
+    unsigned long io_busy_ticks;   // ticks the device served a request
+    unsigned long overlap_ticks;   // ticks with both CPU and device busy
+    unsigned long io_busy_since;   // first tick io_active is served
+    disk_sched_t disk_policy;
+    long disk_pos;                 // head position (block)
+    int disk_dir;                  // elevator direction: 1 up, -1 down
+    unsigned long seek_rate;       // blocks the head crosses per tick (0 = seeks are free)
+    unsigned long io_deadline;     // ticks a request may queue before it is overdue
+    unsigned long io_requests;     // requests started
+    unsigned long io_wait_total;   // queueing before service
+    unsigned long io_wait_max;
+    unsigned long seek_distance;   // blocks travelled by the head
+    unsigned long seek_ticks;      // service ticks spent seeking
+    unsigned long io_overdue;      // requests started io_deadline ticks or more after they queued
+
+    /* arrivals, I/O completions and slice expiries. A timer due at tick t
+     * fires at the end of tick t, after the policy ran. */
+    timer_wheel_t timers;
+    timer_node_t slice_timer;      // slice of s->running (RR, MLFQ)
+    unsigned long dispatch_seq;    // bumped on every dispatch; stale slice timers are ignored
+    int slice_pending;             // dispatched, slice armed on its first consumed tick
+    size_t pending_arrivals;       // TIMER_ARRIVAL timers not yet fired
+
+    /* multi-CPU model (see smp.h); cpu_id is -1 for the classic single-CPU run */
+    int cpu_id;
+    unsigned int speed;      // work units per 100 ticks (100 = nominal core)
+    size_t nr_assigned;      // processes placed here and not yet completed
+    unsigned long assigned_work; // remaining work of those processes
+    unsigned long busy_ticks;// ticks in which a process held the CPU
+
+    /* fixed dispatch overhead: every switch to a different process holds the
+     * CPU for switch_cost ticks before the process makes progress */
+    unsigned long switch_cost;
+    unsigned long switch_left;
+    unsigned long switch_ticks;
+
+    /* cache-affinity model: a dispatched process that lost its working set
+     * stalls (holds the CPU without progress) for up to cache_warmup ticks,
+     * plus migration_cost ticks if it last ran on another CPU. Its cache is
+     * fully evicted after cache_size ticks of other processes' execution. */
+    unsigned long cache_warmup;
+    unsigned long cache_size;
+    unsigned long migration_cost;
+    unsigned long warmup_left;    // stall ticks still owed by s->running
+    unsigned long migration_left;
+    unsigned long warmup_ticks;   // stall ticks spent on cache refill
+    unsigned long migration_ticks;// stall ticks spent on cross-CPU moves
+
+    /* tree run queue of the fair policies: they move processes from
+     * ready_head into rq on every tick */
+    rb_tree_t rq;
+    unsigned long rq_weight;       // sum of the queued processes' weights
+    unsigned long long min_vruntime;
+    long long avg_vruntime;        // EEVDF: sum of (vruntime - min_vruntime) * weight over rq
+    unsigned long sched_latency;   // CFS target latency (ticks)
+    unsigned long min_granularity; // CFS minimum slice, EEVDF request size (ticks)
+
+    /* heap run queue of the deadline and fixed-priority policies, filled
+     * from ready_head */
+    heap_t heap;
+
+    /* response-ratio index of HRRN, filled from ready_head */
+    kinetic_t hrrn;
+
+    /* multi-level queue classes (see mlq.h), filled from ready_head */
+    mlq_t mlq;
+
+    /* hierarchical fair-share groups (see group.h), filled from ready_head */
+    group_tree_t groups;
+
+    /* resources of the jobs' critical sections (see lock.h) */
+    lock_table_t locks;
+
+    /* forks (see spawn.h): jobs blocked until their children finish */
+    process_t *fork_waiters;
+    unsigned long forked;          // children created
+    unsigned long fork_ticks;      // ticks jobs spent forking
+
+    /* gang scheduling (see gang.h): ticks threads held the CPU spinning
+     * while a thread of their job was off its CPU */
+    unsigned long sync_ticks;
+
+    /* frequency scaling and energy (see dvfs.h); freq.cfg is NULL without */
+    dvfs_cpu_t freq;
+
+    /* memory pressure (see paging.h); mem.capacity is 0 without */
+    paging_t mem;
+
+    /* admission control of arrivals (see admit.h); admit.on is 0 without */
+    admit_t admit;
+
+    /* job dependencies (see dag.h): the graph holds jobs back until their
+     * predecessors finish. The CPUs of the SMP model have no graph; they
+     * list the graph jobs that finished in dag_done (sized by smp_run), and
+     * smp_run releases their dependants at the epoch boundary. */
+    dag_t *dag;
+    int *dag_done;
+    size_t dag_done_len;
+
+    /* proportional share (see lottery.h): the lottery's ticket tree, and the
+     * entitlement clock of lottery and stride */
+    fenwick_t lottery;
+    unsigned long long rng;        // lottery draws (splitmix64 state)
+    unsigned long long global_pass;// stride: smallest pass of the runnable processes
+    unsigned long share_tickets;   // tickets of the runnable processes, running included
+    double share_clock;            // ticks of CPU owed per ticket so far
+    unsigned long share_run;       // busy ticks not yet added to share_clock
+
+    /* periodic tasks (see periodic.h); their jobs are released up to horizon */
+    periodic_task_t *tasks;
+    size_t ntasks;
+    unsigned long horizon;
+    unsigned int *periodic_turns;  // turnaround of each finished periodic job
+    size_t periodic_jobs, periodic_cap;
+    periodic_analysis_t analysis;
+
+    /* wake-to-dispatch latency of arrivals and I/O completions */
+    unsigned long wakeups;
+    unsigned long latency_total;
+    unsigned long latency_max;
+
+    /* burst prediction (SJF/SRTF) */
+    predict_mode_t predict;
+    double alpha;                  // weight of the last burst in the average
+    double tau0;                   // estimate for a burst with no history
+    double class_tau[PREDICT_CLASSES]; // PREDICT_CLASS averages (-1 = no history)
+    unsigned long predictions;     // bursts scored
+    unsigned long predict_abs_error;// sum of |estimate - actual|
+    long predict_bias;             // sum of estimate - actual
+    unsigned long inversions;      // dispatches that passed over a truly shorter job
+    unsigned long inversion_ticks; // sum of the chosen job's excess remaining time
+
+    /* event output: quiet drops the JSON stream (metrics still update),
+     * buffered collects it in event_buf until utils_flush_events() */
+    int quiet;
+    int buffered;
+    char *event_buf;
+    size_t event_buf_len;
+    size_t event_buf_cap;
+    unsigned long events_lost;     // not buffered for lack of memory, reported at the flush
+
     /* metrics/summary */
     unsigned long context_switches;
     completed_proc_t *completed;
@@ -62,6 +285,93 @@ process_t *scheduler_pop_head(scheduler_t *s);
 
 void scheduler_tick(scheduler_t *s);
 
+/* 1 if nothing is ready, running, queued for or using the I/O device */
+int scheduler_idle(const scheduler_t *s);
+
+/* 1 if a process is running or ready */
+int scheduler_runnable(const scheduler_t *s);
+
+/* Inject p (taking ownership) once current_tick reaches p->arrival:
+ * the job_resumed arrival event is emitted and p joins the ready queue.
+ */
+void scheduler_schedule_arrival(scheduler_t *s, process_t *p);
+
+/* Fire every timer due at or before current_tick. scheduler_tick() calls
+ * this after the policy; call it once before the first tick as well.
+ */
+void scheduler_fire_timers(scheduler_t *s);
+
+/* Move an idle scheduler forward to the next timer or to 'limit',
+ * whichever comes first, and fire what is due there. Equivalent to
+ * ticking through the gap, minus the tick events.
+ */
+void scheduler_skip_idle(scheduler_t *s, unsigned long limit);
+
+/* Quiet runs of EDF/RM/CPF: if s->running will hold the CPU with nothing to
+ * decide until its burst ends or a timer fires, jump to the tick before
+ * that, bumping the counters ticking would have. Returns 1 if it moved.
+ */
+int scheduler_fast_forward(scheduler_t *s);
+
+/* Ticks left in p's time slice after this tick (p->quantum_left at
+ * dispatch, less the ticks it has run since; stalls do not count).
+ */
+int scheduler_slice_left(const scheduler_t *s, const process_t *p);
+
+/* s->running finished its current CPU burst: it leaves its critical section
+ * if it is in one; if an I/O burst follows it blocks on the device
+ * (PROC_WAITING), otherwise it terminates, releases the jobs waiting on it
+ * (see dag.h) and wakes its parent if that waits for it (see spawn.h), and
+ * is recorded and freed. Clears s->running either way. Jobs of a periodic task
+ * are accounted to the task instead of being recorded one by one.
+ */
+void scheduler_finish_burst(scheduler_t *s);
+
+/* Policies with a run queue of their own (a heap, a tree, an index, class or
+ * group queues) move what lands on ready_head, arrivals and I/O completions,
+ * into it at the start of every tick, and dispatch from there.
+ * scheduler_take: p left that run queue; the ticks since it was queued
+ * (last_enqueued_tick) go to its waiting time. Returns p.
+ * scheduler_dispatch: p gets the CPU. It becomes s->running and gets its
+ * start time on its first dispatch; context_switch (charging the dispatch,
+ * see scheduler_charge_dispatch) and job_started or job_resumed are
+ * emitted. A policy sets p's slice, if it has one, before calling this.
+ */
+process_t *scheduler_take(scheduler_t *s, process_t *p);
+void scheduler_dispatch(scheduler_t *s, process_t *p);
+
+/* Charge one tick of CPU time to p (normally s->running). Progress scales
+ * with s->speed, so a 50% core needs two ticks per unit of burst. Every
+ * *_tick handler calls this instead of decrementing remaining itself.
+ * Under DVFS the governor sets the speed for the tick and p is charged
+ * its energy, stalled or not.
+ * Returns 1 if the tick was spent running p, 0 if p stalled (switch cost,
+ * migration, cache refill, paging, shedding, a fork, or a critical section whose resource is
+ * held: p then blocks once the policy is done, see lock.h); time-sliced policies
+ * do not count stall ticks against the slice.
+ */
+int scheduler_consume(scheduler_t *s, process_t *p);
+
+/* Ticks of s in which a process made progress (busy minus stalls, paging,
+ * shed dispatches, ticks lost finding a resource held, and gang threads
+ * spinning) */
+unsigned long scheduler_useful_ticks(const scheduler_t *s);
+
+/* Called on every EVT_CONTEXT_SWITCH for s->running: sets the switch cost
+ * and works out how cold its cache is, i.e. the stall it pays before making
+ * progress again. Re-dispatching the process that just ran is free. If the
+ * policy gave it a slice (quantum_left > 0), its first scheduler_consume()
+ * arms the slice timer, which zeroes quantum_left before the slice's last
+ * tick is checked. A process dispatched for the first time since it arrived
+ * or came back from I/O has its wake-to-dispatch latency recorded.
+ */
+void scheduler_charge_dispatch(scheduler_t *s);
+
+/* s->running stops being runnable without going to the I/O device (it
+ * blocked on a resource or on its children): settle what the policy keeps
+ * for runnable processes */
+void scheduler_leave(scheduler_t *s, process_t *p);
+
 /* add a completed process snapshot */
 void scheduler_record_completed(scheduler_t *s, const process_t *p);
 
@@ -0,0 +1,82 @@
+#ifndef SMP_H
+#define SMP_H
+
+#include "scheduler.h"
+
+/* Multi-CPU model: one scheduler_t (ready queue + running slot) per simulated
+ * CPU. A process is placed on a CPU when it arrives and stays there unless
+ * migrate-up moves it, so CPUs only interact at epoch boundaries. An epoch
+ * places the arrivals of the next window ticks, and ends at the next arrival
+ * after them (or the next migrate-up check): arrivals after its first tick
+ * are placed on the load the CPUs have then, and fire on their CPU's timers.
+ * Inside an epoch every CPU with work advances independently and those CPUs
+ * are partitioned across host threads, with a barrier at each boundary.
+ * Events are buffered per CPU and written CPU by CPU at the end of each
+ * epoch, so the output and metrics do not depend on the thread count.
+ *
+ * CPUs may differ in speed (scheduler_t.speed, 100 = nominal).
+ *
+ * With job dependencies (see dag.h) a job is injected once its arrival has
+ * come and its predecessors have finished, and the window is one tick. An
+ * epoch then also ends at the earliest tick a running job with dependants
+ * could finish, so its dependants are injected on the tick it finishes.
+ *
+ * Forked children (see spawn.h) arrive on their parent's CPU, and neither a
+ * job waiting for children nor those children are moved by migrate-up.
+ *
+ * Gang scheduling (see gang.h) replaces placement and epochs: jobs take
+ * cells of a matrix over the CPUs, and the CPUs advance together tick by
+ * tick on one host thread (every tick counts as an epoch).
+ */
+
+typedef enum {
+    PLACE_LEAST_LOADED,   // fewest assigned processes, lowest CPU id on ties
+    PLACE_ROUND_ROBIN,
+    PLACE_CAPACITY        // earliest expected finish: (assigned work + burst) / speed
+} placement_t;
+
+typedef struct smp_t {
+    int ncpus;
+    int nthreads;            // host threads (clamped to ncpus)
+    placement_t placement;
+    scheduler_t **cpus;
+    int next_cpu;            // round-robin placement cursor
+    unsigned long migrate_up;// move jobs that ran this many ticks on a slower CPU
+                             // to an idle faster one, checked every migrate_up ticks (0 = off)
+    unsigned long window;    // placement window in ticks (0 or 1 = each arrival tick)
+    unsigned long migrations;
+    unsigned long epochs;    // synchronization windows executed
+    dag_t *dag;              // job dependencies (NULL = none), not owned
+    struct gang_t *gang;     // gang scheduling matrix settings and results (NULL = none), not owned
+} smp_t;
+
+/* lifecycle */
+smp_t *smp_create(sched_algo_t algo, int ncpus, int nthreads);
+void smp_destroy(smp_t *m);
+
+/* Parse a CPU speed spec like "4x200,4x100" or "200,100": groups of
+ * [count x] percent, in CPU order. Sets speeds[0..n) for the CPUs it
+ * covers, and returns how many CPUs it lists (possibly more than n), or -1
+ * if it is malformed.
+ */
+long smp_parse_speeds(const char *spec, unsigned int *speeds, int n);
+
+/* Set the CPU speeds from a spec (see smp_parse_speeds); CPUs not covered
+ * stay at 100. Returns what smp_parse_speeds does, or -1 on OOM.
+ */
+long smp_set_speeds(smp_t *m, const char *spec);
+
+/* Run the workload to completion. Sorts pending by arrival (stable) and takes
+ * ownership of every process. Returns the number of processes injected.
+ */
+int smp_run(smp_t *m, process_t **pending, int count);
+
+/* Latest tick reached by any CPU */
+unsigned long smp_ticks(const smp_t *m);
+
+/* Build a summary scheduler holding the merged metrics of all CPUs
+ * (completed records in CPU order). Caller destroys it.
+ */
+scheduler_t *smp_collect(const smp_t *m);
+
+#endif // SMP_H
@@ -0,0 +1,49 @@
+#ifndef SPAWN_H
+#define SPAWN_H
+
+#include "process.h"
+
+struct scheduler_t;
+
+/* Programs that fork children as they run.
+ *
+ * A job lists its forks as offsets into its CPU work: "2+5x3w" forks three
+ * children with a 5-tick CPU burst once the job has done 2 ticks of CPU work,
+ * and waits for them; "8+4" forks one 4-tick child at 8 ticks and goes on.
+ * Forking holds the CPU for one tick in which the job makes no progress
+ * (fork_ticks). The children arrive at the end of that tick on the job's
+ * CPU, inherit its priority, MLQ class and HFS group, and are scheduled like
+ * any other arrival. Their pids follow the largest pid of the workload, in
+ * workload order, so they do not depend on the schedule.
+ *
+ * A job that waits blocks in PROC_WAITING (job_blocked, "children") after
+ * the fork tick until every child it waits for has finished, and is ready
+ * again on the tick the last one does (like waitpid on each of them). If the
+ * policy preempted it in the fork tick, it blocks on its next tick instead,
+ * which is also counted as a fork tick.
+ */
+
+#define SPAWN_MAX_FORKS 64
+#define SPAWN_MAX_COUNT 1024
+
+/* Parse a fork list, "AT+BURST[xCOUNT][w]" separated by commas, into out (at
+ * most max). Returns the number of forks, or -1 on a malformed spec.
+ */
+int spawn_parse(const char *spec, fork_spec_t *out, int max);
+
+/* p is about to do a tick of work (scheduler_consume) and has reached its
+ * next fork: fork the children. The tick is spent forking. Returns 1 if it
+ * forked, 0 if p has no fork due.
+ */
+int spawn_fork(struct scheduler_t *s, process_t *p);
+
+/* After the policy's tick: s->running blocks if it waits for children */
+void spawn_tick(struct scheduler_t *s);
+
+/* A child finished: wake its parent if it was the last one it waited for */
+void spawn_child_done(struct scheduler_t *s, process_t *child);
+
+/* Free the jobs still waiting for children (scheduler teardown) */
+void spawn_clear(struct scheduler_t *s);
+
+#endif // SPAWN_H
@@ -0,0 +1,69 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stddef.h>
+
+/* Hierarchical timing wheel. Level L has TW_SLOTS slots of 64^L ticks each,
+ * so it holds timers due within 64^(L+1) ticks; a timer is placed on the
+ * lowest level that covers it and moved down (cascaded) when the wheel
+ * reaches its slot. Scheduling and cancelling are O(1) and a timer is
+ * cascaded at most TW_LEVELS - 1 times. Timers beyond the top level's range
+ * are re-placed each time their top-level slot comes around.
+ *
+ * Timers with the same expiry fire in the order they were scheduled.
+ */
+
+#define TW_BITS 6
+#define TW_SLOTS (1 << TW_BITS)
+#define TW_MASK (TW_SLOTS - 1)
+#define TW_LEVELS 4
+
+struct timer_list_t;
+
+typedef struct timer_node_t {
+    unsigned long expires;
+    int kind;                    // owner-defined timer type
+    void *data;                  // owner-defined payload
+    int level;                   // wheel level, -1 for the due list
+    struct timer_list_t *list;   // list holding the node; NULL when not armed
+    struct timer_node_t *prev;
+    struct timer_node_t *next;   // also chains the nodes returned by tw_advance()
+} timer_node_t;
+
+typedef struct timer_list_t {
+    timer_node_t *head;
+    timer_node_t *tail;
+} timer_list_t;
+
+typedef struct {
+    unsigned long now;           // every timer with expires <= now has been returned
+    size_t count;                // armed timers
+    size_t level_count[TW_LEVELS];
+    timer_list_t due;            // scheduled at or before 'now', returned by the next advance
+    timer_list_t slots[TW_LEVELS][TW_SLOTS];
+} timer_wheel_t;
+
+void tw_init(timer_wheel_t *tw, unsigned long now);
+
+/* Arm t to expire at 'expires' (re-arms if already armed). */
+void tw_schedule(timer_wheel_t *tw, timer_node_t *t, unsigned long expires);
+
+/* Disarm t; no-op if it is not armed. */
+void tw_cancel(timer_wheel_t *tw, timer_node_t *t);
+
+static inline int tw_armed(const timer_node_t *t) {
+    return t->list != NULL;
+}
+
+/* Move the wheel forward to 'upto' and return the expired timers, disarmed
+ * and chained through next in expiry order. With stop_early set, stop at
+ * the first tick that expires anything (or at 'upto'); tw->now tells where.
+ * Empty stretches are skipped a whole slot of the lowest non-empty level at
+ * a time.
+ */
+timer_node_t *tw_advance(timer_wheel_t *tw, unsigned long upto, int stop_early);
+
+/* Disarm every timer and return them chained through next (for teardown). */
+timer_node_t *tw_detach_all(timer_wheel_t *tw);
+
+#endif // TIMER_H
@@ -12,4 +12,8 @@ char *utils_build_event(event_type_t type, const scheduler_t *sched, const proce
  */
 void utils_emit_event_and_free(char *event_json, event_type_t type, scheduler_t *sched);
 
+/* Write out and clear events collected while sched->buffered was set, and
+ * report any that could not be buffered. Main thread only. */
+void utils_flush_events(scheduler_t *s);
+
 #endif // UTILS_H
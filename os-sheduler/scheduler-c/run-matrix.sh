@@ -14,7 +14,7 @@ run_algo() {
   suffix="$algo"
   if [ $# -gt 0 ]; then
     # join args with underscores for filename
-    suffix="${algo}_$(printf '%s_' "$@" | sed 's/_$//; s/ /_/g; s/ /_/g')"
+    suffix="${algo}_$(printf '%s_' "$@" | sed 's/_$//; s/ /_/g; s/ /_/g; s#/#_#g')"
   fi
 
   out="$OUT_DIR/${suffix}.raw"
@@ -50,4 +50,15 @@ run_algo rr 2
 run_algo rr 4
 run_algo mlfq
 
+# Dispatch stalls as long as a slice (--min-granularity is 3 by default): the
+# policies must keep them out of the slice or these runs never finish. Quiet:
+# only the summary is kept
+STALLS=../test-stalls.json
+run_algo cfs "$STALLS" --quiet --switch-cost=3
+run_algo cfs "$STALLS" --quiet --cache-warmup=3 --cache-size=4
+run_algo eevdf "$STALLS" --quiet --switch-cost=6
+run_algo eevdf "$STALLS" --quiet --cache-warmup=3 --cache-size=4
+run_algo hfs "$STALLS" --quiet --switch-cost=3
+run_algo mlq "$STALLS" --quiet --mlq=ui:rr2:..1:1,batch:sjf::1 --mlq-arbiter=slice --switch-cost=2
+
 echo "All runs complete. Summaries in $OUT_DIR/"
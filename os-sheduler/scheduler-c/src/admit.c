@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/admit.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+void admit_init(admit_t *a) {
+    memset(a, 0, sizeof(*a));
+    a->burst = 1.0;
+}
+
+const char *admit_reason_name(int reason) {
+    switch (reason) {
+        case REJECT_QUEUE: return "queue";
+        case REJECT_RATE: return "rate";
+        case REJECT_DEADLINE: return "deadline";
+        default: return "shed";
+    }
+}
+
+/* Ticks s needs for work units of CPU work at its speed */
+static unsigned long work_ticks(const scheduler_t *s, unsigned long work) {
+    return (work * 100 + s->speed - 1) / s->speed;
+}
+
+/* Other jobs wait for p: it has predecessors or dependants in the graph,
+ * or its parent waits for it */
+static int bound(const scheduler_t *s, const process_t *p) {
+    if (p->nafter || p->fork_parent) return 1;
+    return s->dag && p->dag_idx >= 0 && s->dag->v[p->dag_idx].nchildren;
+}
+
+static void drop(scheduler_t *s, process_t *p, int reason) {
+    admit_t *a = &s->admit;
+    if (s->dag && p->dag_idx >= 0) dag_finish(s->dag, p->dag_idx, s->current_tick);  // releases none
+    if (a->ndropped == a->cap) {
+        size_t newcap = a->cap ? a->cap * 2 : 64;
+        dropped_job_t *v = (dropped_job_t *)realloc(a->dropped, newcap * sizeof(dropped_job_t));
+        if (v) {
+            a->dropped = v;
+            a->cap = newcap;
+        }
+    }
+    if (a->ndropped < a->cap) {
+        dropped_job_t *d = &a->dropped[a->ndropped++];
+        d->pid = p->pid;
+        d->arrival = p->arrival;
+        d->burst = p->cpu_total;
+        d->deadline = p->deadline;
+        d->reason = reason;
+        d->at = (unsigned int)s->current_tick;
+    }
+    p->state = PROC_TERMINATED;
+    p->finish_time = (unsigned int)s->current_tick;
+    char info[64];
+    snprintf(info, sizeof(info), "\"%s\":\"%s\"", reason < 0 ? "shed" : "rejected",
+             reason < 0 ? "deadline" : admit_reason_name(reason));
+    char *ev = utils_build_event(EVT_JOB_FINISHED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
+}
+
+int admit_arrive(scheduler_t *s, process_t *p) {
+    admit_t *a = &s->admit;
+    a->arrivals++;
+    int exempt = bound(s, p);
+    int reason = -1;
+    if (a->rate > 0.0) {
+        a->tokens += a->rate * (double)(s->current_tick - a->refill_tick);
+        if (a->tokens > a->burst) a->tokens = a->burst;
+        a->refill_tick = s->current_tick;
+    }
+    if (!exempt) {
+        if (a->max_queue > 0 && a->in_system >= a->max_queue) reason = REJECT_QUEUE;
+        else if (a->rate > 0.0 && a->tokens < 1.0) reason = REJECT_RATE;
+        else if (a->deadline && p->deadline != UINT_MAX &&
+                 s->current_tick + work_ticks(s, a->backlog + (unsigned long)p->cpu_total) > p->deadline)
+            reason = REJECT_DEADLINE;
+    }
+    if (reason >= 0) {
+        a->rejected[reason]++;
+        drop(s, p, reason);
+        process_free(p);
+        return 0;
+    }
+    if (a->rate > 0.0 && !exempt) a->tokens -= 1.0;
+    a->admitted++;
+    a->in_system++;
+    if (a->in_system > a->queue_peak) a->queue_peak = a->in_system;
+    a->backlog += (unsigned long)(p->cpu_total - p->cpu_done);
+    p->admitted = 1;
+    return 1;
+}
+
+int admit_shed(scheduler_t *s, process_t *p) {
+    if (p->run_ticks != 1 || p->deadline == UINT_MAX || bound(s, p)) return 0;
+    /* running from this tick on, it would finish need - 1 ticks later */
+    unsigned long need = work_ticks(s, (unsigned long)(p->cpu_total - p->cpu_done));
+    if (s->current_tick + need <= (unsigned long)p->deadline + 1) return 0;
+    p->admitted = 2;
+    s->admit.shed_ticks++;
+    return 1;
+}
+
+void admit_tick(scheduler_t *s) {
+    process_t *p = s->running;
+    if (!p || p->admitted != 2) return;
+    scheduler_leave(s, p);
+    s->running = NULL;
+    s->admit.shed++;
+    admit_leave(s, p);
+    drop(s, p, -1);
+    if (p->mem_slot >= 0) paging_leave(s, p);
+    if (s->nr_assigned > 0) s->nr_assigned--;
+    process_free(p);
+}
+
+void admit_leave(scheduler_t *s, process_t *p) {
+    admit_t *a = &s->admit;
+    unsigned long left = (unsigned long)(p->cpu_total - p->cpu_done);
+    a->backlog -= left < a->backlog ? left : a->backlog;
+    a->in_system--;
+    p->admitted = 0;
+}
+
+void admit_clear(scheduler_t *s) {
+    free(s->admit.dropped);
+    s->admit.dropped = NULL;
+    s->admit.ndropped = s->admit.cap = 0;
+}
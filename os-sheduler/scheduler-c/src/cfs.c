@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/cfs.h"
+#include "../include/utils.h"
+#include "../include/scheduler.h"
+
+/* Linux sched_prio_to_weight[], nice -20 .. 19: about 1.25x per nice level */
+static const unsigned long nice_weights[40] = {
+    88761, 71755, 56483, 46273, 36291,
+    29154, 23254, 18705, 14949, 11916,
+     9548,  7620,  6100,  4904,  3906,
+     3121,  2501,  1991,  1586,  1277,
+     1024,   820,   655,   526,   423,
+      335,   272,   215,   172,   137,
+      110,    87,    70,    56,    45,
+       36,    29,    23,    18,    15,
+};
+
+unsigned long cfs_weight(int priority) {
+    if (priority < -20) priority = -20;
+    if (priority > 19) priority = 19;
+    return nice_weights[priority + 20];
+}
+
+static unsigned long long to_vruntime(unsigned long long ticks_scaled, const process_t *p) {
+    return ticks_scaled * NICE_0_WEIGHT / cfs_weight(p->priority);
+}
+
+static int vruntime_less(const rb_node_t *a, const rb_node_t *b) {
+    return rb_entry(a, process_t, rb)->vruntime < rb_entry(b, process_t, rb)->vruntime;
+}
+
+static void enqueue(scheduler_t *s, process_t *p) {
+    p->state = PROC_READY;
+    p->last_enqueued_tick = (unsigned int)s->current_tick;
+    s->rq_weight += cfs_weight(p->priority);
+    rb_insert(&s->rq, &p->rb);
+}
+
+static process_t *dequeue(scheduler_t *s, process_t *p) {
+    rb_erase(&s->rq, &p->rb);
+    s->rq_weight -= cfs_weight(p->priority);
+    return scheduler_take(s, p);
+}
+
+static process_t *leftmost(const scheduler_t *s) {
+    rb_node_t *n = rb_first(&s->rq);
+    return n ? rb_entry(n, process_t, rb) : NULL;
+}
+
+/* p's share of the scheduling period, in 1/VR_SCALE ticks of wall time.
+ * 'joining' counts p in, for a process that is neither queued nor running.
+ */
+static unsigned long long sched_slice(const scheduler_t *s, const process_t *p, int joining) {
+    unsigned long nr = (unsigned long)s->rq.count + (s->running ? 1 : 0);
+    unsigned long total = s->rq_weight + (s->running ? cfs_weight(s->running->priority) : 0);
+    unsigned long w = cfs_weight(p->priority);
+    if (joining) {
+        nr++;
+        total += w;
+    }
+    unsigned long long period = s->sched_latency;
+    if (nr * s->min_granularity > period) period = nr * s->min_granularity;
+    return period * VR_SCALE * w / (total ? total : w);
+}
+
+static void update_min_vruntime(scheduler_t *s) {
+    process_t *left = leftmost(s);
+    unsigned long long vr = s->min_vruntime;
+    if (s->running) vr = s->running->vruntime;
+    if (left && (!s->running || left->vruntime < vr)) vr = left->vruntime;
+    if (vr > s->min_vruntime) s->min_vruntime = vr;
+}
+
+static void place(scheduler_t *s, process_t *p) {
+    if (p->run_ticks == 0) {
+        /* new: start a slice behind, so forking cannot starve the others */
+        p->vruntime = s->min_vruntime + to_vruntime(sched_slice(s, p, 1), p);
+    } else {
+        /* woken (or moved here from another CPU): limited sleeper credit */
+        unsigned long long credit = s->sched_latency * VR_SCALE / 2;
+        unsigned long long floor = s->min_vruntime > credit ? s->min_vruntime - credit : 0;
+        if (p->last_cpu != s->cpu_id || p->vruntime < floor) p->vruntime = floor;
+    }
+}
+
+static void dispatch(scheduler_t *s, process_t *p) {
+    p->slice_ran = 0;
+    scheduler_dispatch(s, p);
+}
+
+/* Put the running process back in the tree and run the leftmost one */
+static void preempt(scheduler_t *s, const char *reason) {
+    process_t *cur = s->running;
+    s->running = NULL;
+    enqueue(s, cur);
+    process_t *next = dequeue(s, leftmost(s));
+    if (next == cur) {
+        /* still the most deserving: keep running without a switch */
+        s->running = cur;
+        cur->state = PROC_RUNNING;
+        cur->slice_ran = 0;
+        return;
+    }
+    char info[128];
+    snprintf(info, sizeof(info), "\"reason\":\"%s\", \"preempted_by\":%d", reason, next->pid);
+    char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, cur, info);
+    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+    dispatch(s, next);
+}
+
+static int slice_expired(const scheduler_t *s, const process_t *cur, const process_t *left) {
+    unsigned long long ideal = sched_slice(s, cur, 0);
+    unsigned long long ran = (unsigned long long)cur->slice_ran * VR_SCALE;
+    if (ran >= ideal) return 1;
+    if (ran < s->min_granularity * VR_SCALE) return 0;
+    return cur->vruntime > left->vruntime && cur->vruntime - left->vruntime > ideal;
+}
+
+static int wakeup_preempts(const scheduler_t *s, const process_t *cur, const process_t *p) {
+    unsigned long long gran = to_vruntime(s->min_granularity * VR_SCALE, p);
+    return cur->vruntime > p->vruntime && cur->vruntime - p->vruntime > gran;
+}
+
+void cfs_tick(scheduler_t *s) {
+    if (!s) return;
+
+    int wakeup = 0;
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        s->ready_head = p->next;
+        p->next = NULL;
+        unsigned int queued = p->last_enqueued_tick;
+        place(s, p);
+        enqueue(s, p);
+        p->last_enqueued_tick = queued;
+        if (s->running && wakeup_preempts(s, s->running, p)) wakeup = 1;
+    }
+
+    process_t *left = leftmost(s);
+    if (s->running && left) {
+        if (wakeup) preempt(s, "wakeup");
+        else if (slice_expired(s, s->running, left)) preempt(s, "slice");
+    }
+    if (!s->running && left) dispatch(s, dequeue(s, left));
+
+    if (s->running) {
+        process_t *cur = s->running;
+        /* stalls hold the CPU, so they are charged, but do not use up the slice */
+        if (scheduler_consume(s, cur)) cur->slice_ran++;
+        cur->vruntime += to_vruntime(VR_SCALE, cur);
+        update_min_vruntime(s);
+
+        char info[128];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"vruntime\":%.3f",
+                 cur->pid, cur->remaining, (double)cur->vruntime / (double)VR_SCALE);
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) scheduler_finish_burst(s);
+    }
+}
+
+void cfs_init(scheduler_t *s) {
+    rb_init(&s->rq, vruntime_less, NULL);
+    s->rq_weight = 0;
+    s->min_vruntime = 0;
+}
+
+void cfs_clear(scheduler_t *s) {
+    if (!s) return;
+    while (s->rq.count) {
+        process_t *p = leftmost(s);
+        rb_erase(&s->rq, &p->rb);
+        process_free(p);
+    }
+    s->rq_weight = 0;
+}
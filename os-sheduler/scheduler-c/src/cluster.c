@@ -0,0 +1,436 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../include/cluster.h"
+#include "../include/utils.h"
+
+static unsigned long end_of(const cluster_job_t *j) {
+    return j->start + j->run;
+}
+
+static unsigned long limit_of(const cluster_job_t *j) {
+    return j->start + j->req;
+}
+
+static int end_less(const rb_node_t *a, const rb_node_t *b) {
+    return end_of(rb_entry(a, cluster_job_t, by_end)) < end_of(rb_entry(b, cluster_job_t, by_end));
+}
+
+static int limit_less(const rb_node_t *a, const rb_node_t *b) {
+    return limit_of(rb_entry(a, cluster_job_t, by_limit)) < limit_of(rb_entry(b, cluster_job_t, by_limit));
+}
+
+cluster_t *cluster_create(sched_algo_t algo, int nodes, int node_cpus) {
+    cluster_t *c = (cluster_t *)calloc(1, sizeof(cluster_t));
+    if (!c) return NULL;
+    c->nodes = nodes;
+    c->node_cpus = node_cpus;
+    c->alloc = ALLOC_SHARED;
+    c->backfill = (algo == ALG_EASY);
+    c->backfill_depth = 0;
+    c->tau = CLUSTER_TAU_DEFAULT;
+    rb_init(&c->running_end, end_less, NULL);
+    rb_init(&c->running_limit, limit_less, NULL);
+    c->node = (scheduler_t **)calloc((size_t)nodes, sizeof(scheduler_t *));
+    c->node_free = (int *)malloc((size_t)nodes * sizeof(int));
+    if (!c->node || !c->node_free) {
+        cluster_destroy(c);
+        return NULL;
+    }
+    for (int i = 0; i < nodes; ++i) {
+        c->node[i] = scheduler_create(algo);
+        if (!c->node[i]) {
+            cluster_destroy(c);
+            return NULL;
+        }
+        c->node_free[i] = node_cpus;
+    }
+    return c;
+}
+
+static void free_job(cluster_job_t *j) {
+    if (!j) return;
+    free(j->alloc);
+    free(j);
+}
+
+void cluster_destroy(cluster_t *c) {
+    if (!c) return;
+    cluster_job_t *j = c->head;
+    while (j) {
+        cluster_job_t *n = j->next;
+        free_job(j);
+        j = n;
+    }
+    rb_node_t *r;
+    while ((r = rb_first(&c->running_end))) {
+        rb_erase(&c->running_end, r);
+        free_job(rb_entry(r, cluster_job_t, by_end));
+    }
+    for (int i = 0; c->node && i < c->nodes; ++i) scheduler_destroy(c->node[i]);
+    free(c->node);
+    free(c->node_free);
+    free(c->waits);
+    free(c->bsld);
+    free(c);
+}
+
+const char *cluster_alloc_name(cluster_alloc_t a) {
+    return a == ALLOC_EXCLUSIVE ? "exclusive" : "shared";
+}
+
+int cluster_parse_alloc(const char *name) {
+    if (strcmp(name, "shared") == 0) return ALLOC_SHARED;
+    if (strcmp(name, "exclusive") == 0) return ALLOC_EXCLUSIVE;
+    return -1;
+}
+
+/* ---- job sources ---- */
+
+/* Read the next line that is not a comment into src->buf; 0 at the end */
+static int swf_line(cluster_source_t *src) {
+    while (fgets(src->buf, sizeof(src->buf), src->fp)) {
+        src->line++;
+        size_t len = strlen(src->buf);
+        /* a line longer than the buffer: drop the rest, its fields are beyond ours */
+        if (len && src->buf[len - 1] != '\n') {
+            int ch;
+            while ((ch = fgetc(src->fp)) != EOF && ch != '\n') {}
+        }
+        const char *p = src->buf;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == ';') {
+            if (sscanf(p, "; MaxNodes: %d", &src->max_nodes) != 1)
+                sscanf(p, "; MaxProcs: %d", &src->max_procs);
+            continue;
+        }
+        if (*p == '\n' || *p == '\r' || !*p) continue;
+        return 1;
+    }
+    return 0;
+}
+
+int cluster_open_swf(cluster_source_t *src, const char *path) {
+    memset(src, 0, sizeof(*src));
+    src->fp = fopen(path, "r");
+    if (!src->fp) return -1;
+    src->path = path;
+    /* the header is the comment block before the first job */
+    src->have_line = swf_line(src);
+    return 0;
+}
+
+static int by_submit(const void *a, const void *b) {
+    const cluster_job_t *x = *(cluster_job_t *const *)a, *y = *(cluster_job_t *const *)b;
+    if (x->submit != y->submit) return x->submit < y->submit ? -1 : 1;
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+static cluster_job_t *new_job(int id, unsigned long submit, unsigned long run, unsigned long req, int procs,
+                              cluster_source_t *src) {
+    cluster_job_t *j = (cluster_job_t *)calloc(1, sizeof(cluster_job_t));
+    if (!j) return NULL;
+    j->id = id;
+    j->submit = submit;
+    j->run = run;
+    j->req = req;
+    j->procs = procs;
+    if (run > req) {
+        j->run = req;
+        j->killed = 1;
+        src->truncated++;
+    }
+    return j;
+}
+
+int cluster_use_processes(cluster_source_t *src, process_t **procs, int n) {
+    memset(src, 0, sizeof(*src));
+    src->jobs = n ? (cluster_job_t **)malloc((size_t)n * sizeof(cluster_job_t *)) : NULL;
+    if (n && !src->jobs) return -1;
+    for (int i = 0; i < n; ++i) {
+        process_t *p = procs[i];
+        unsigned long run = (unsigned long)p->cpu_total + (unsigned long)p->io_total;
+        cluster_job_t *j = new_job(p->pid, p->arrival, run, p->walltime ? p->walltime : run, p->width, src);
+        if (!j) {
+            for (int k = i; k < n; ++k) process_free(procs[k]);
+            return -1;
+        }
+        src->jobs[src->njobs++] = j;
+        process_free(p);
+    }
+    qsort(src->jobs, (size_t)src->njobs, sizeof(cluster_job_t *), by_submit);
+    return 0;
+}
+
+void cluster_close(cluster_source_t *src) {
+    if (src->fp) fclose(src->fp);
+    for (int i = src->next; i < src->njobs; ++i) free_job(src->jobs[i]);
+    free(src->jobs);
+    memset(src, 0, sizeof(*src));
+}
+
+/* SWF fields 1..9: job, submit, wait, run time, allocated processors,
+ * average CPU time, memory, requested processors, requested time; -1 is
+ * "unknown". Requested processors fall back to the allocated ones, the
+ * requested time to the run time. Returns 1, 0 at the end, -1 on OOM. */
+static int swf_next(cluster_source_t *src, cluster_job_t **out) {
+    while (src->have_line || swf_line(src)) {
+        src->have_line = 0;
+        double f[9];
+        int nf = 0;
+        char *p = src->buf, *end;
+        while (nf < 9) {
+            f[nf] = strtod(p, &end);
+            if (end == p) break;
+            nf++;
+            p = end;
+        }
+        int procs = nf == 9 ? (int)(f[7] > 0 ? f[7] : f[4]) : 0;
+        if (nf < 9 || f[1] < 0 || f[3] < 0 || procs <= 0) {
+            src->invalid++;
+            continue;
+        }
+        unsigned long run = (unsigned long)f[3];
+        *out = new_job((int)f[0], (unsigned long)f[1], run, f[8] > 0 ? (unsigned long)f[8] : run, procs, src);
+        return *out ? 1 : -1;
+    }
+    return 0;
+}
+
+static int source_next(cluster_source_t *src, cluster_job_t **out) {
+    *out = NULL;
+    if (src->fp) return swf_next(src, out);
+    if (src->next == src->njobs) return 0;
+    *out = src->jobs[src->next++];
+    return 1;
+}
+
+/* ---- the cluster ---- */
+
+/* The next job c can run at all, submitted no earlier than now; NULL at the end */
+static int next_job(cluster_t *c, cluster_source_t *src, cluster_job_t **out) {
+    for (;;) {
+        int r = source_next(src, out);
+        if (r <= 0) return r;
+        cluster_job_t *j = *out;
+        if (j->procs > c->nodes * c->node_cpus) {
+            c->too_wide++;
+            free_job(j);
+            continue;
+        }
+        j->units = c->alloc == ALLOC_EXCLUSIVE ? (j->procs + c->node_cpus - 1) / c->node_cpus : j->procs;
+        if (j->submit < c->now) {
+            c->late++;
+            j->submit = c->now;
+        }
+        return 1;
+    }
+}
+
+static void enqueue(cluster_t *c, cluster_job_t *j) {
+    j->prev = c->tail;
+    j->next = NULL;
+    if (c->tail) c->tail->next = j;
+    else c->head = j;
+    c->tail = j;
+    if (++c->queued > c->queue_peak) c->queue_peak = c->queued;
+}
+
+static void dequeue(cluster_t *c, cluster_job_t *j) {
+    if (j->prev) j->prev->next = j->next;
+    else c->head = j->next;
+    if (j->next) j->next->prev = j->prev;
+    else c->tail = j->prev;
+    j->prev = j->next = NULL;
+    c->queued--;
+}
+
+/* Take j's CPUs: first fit over the nodes, whole free nodes if exclusive */
+static int allocate(cluster_t *c, cluster_job_t *j) {
+    int exclusive = c->alloc == ALLOC_EXCLUSIVE;
+    int nalloc = 0, need = exclusive ? j->units : j->procs;
+    for (int i = 0; i < c->nodes && need > 0; ++i) {
+        if (exclusive ? c->node_free[i] < c->node_cpus : !c->node_free[i]) continue;
+        need -= exclusive ? 1 : c->node_free[i];
+        nalloc++;
+    }
+    j->alloc = (int *)malloc((size_t)nalloc * 2 * sizeof(int));
+    if (!j->alloc) return -1;
+    j->nalloc = nalloc;
+
+    int left = j->procs, k = 0;
+    for (int i = 0; k < nalloc; ++i) {
+        if (exclusive ? c->node_free[i] < c->node_cpus : !c->node_free[i]) continue;
+        int take = c->node_free[i] < left ? c->node_free[i] : left;
+        j->alloc[2 * k] = i;
+        j->alloc[2 * k + 1] = take;
+        c->node_free[i] -= exclusive ? c->node_cpus : take;
+        left -= take;
+        k++;
+    }
+    return 0;
+}
+
+static int start_job(cluster_t *c, cluster_job_t *j, int backfilled) {
+    dequeue(c, j);
+    if (allocate(c, j) < 0) {
+        free_job(j);
+        return -1;
+    }
+    j->start = c->now;
+    j->backfilled = backfilled;
+    c->free_units -= j->units;
+    c->backfilled += (unsigned long)backfilled;
+    rb_insert(&c->running_end, &j->by_end);
+    rb_insert(&c->running_limit, &j->by_limit);
+
+    scheduler_t *s = c->node[j->alloc[0]];
+    s->current_tick = c->now;
+    char info[192];
+    snprintf(info, sizeof(info),
+             "\"pid\": %d, \"procs\": %d, \"node\": %d, \"nodes\": %d, \"wait\": %lu, \"limit\": %lu, \"backfilled\": %s",
+             j->id, j->procs, j->alloc[0], j->nalloc, j->start - j->submit, j->req, backfilled ? "true" : "false");
+    char *ev = utils_build_event(EVT_JOB_STARTED, s, NULL, info);
+    utils_emit_event_and_free(ev, EVT_JOB_STARTED, s);
+    return 0;
+}
+
+static int record(cluster_t *c, unsigned int wait, double bsld) {
+    if (c->nrec == c->caprec) {
+        size_t cap = c->caprec ? c->caprec * 2 : 1024;
+        unsigned int *w = (unsigned int *)realloc(c->waits, cap * sizeof(unsigned int));
+        if (!w) return -1;
+        c->waits = w;
+        double *b = (double *)realloc(c->bsld, cap * sizeof(double));
+        if (!b) return -1;
+        c->bsld = b;
+        c->caprec = cap;
+    }
+    c->waits[c->nrec] = wait;
+    c->bsld[c->nrec] = bsld;
+    c->nrec++;
+    return 0;
+}
+
+static int finish_job(cluster_t *c, cluster_job_t *j) {
+    rb_erase(&c->running_end, &j->by_end);
+    rb_erase(&c->running_limit, &j->by_limit);
+    int exclusive = c->alloc == ALLOC_EXCLUSIVE;
+    for (int k = 0; k < j->nalloc; ++k) {
+        scheduler_t *s = c->node[j->alloc[2 * k]];
+        int used = j->alloc[2 * k + 1];
+        c->node_free[j->alloc[2 * k]] += exclusive ? c->node_cpus : used;
+        s->busy_ticks += (unsigned long)used * j->run;
+        s->completed_count++;
+    }
+    c->free_units += j->units;
+    c->jobs++;
+    c->run_total += j->run;
+    c->used_ticks += (unsigned long long)j->procs * j->run;
+    c->held_ticks += (unsigned long long)(exclusive ? j->units * c->node_cpus : j->procs) * j->run;
+    if (end_of(j) > c->last_end) c->last_end = end_of(j);
+
+    unsigned long wait = j->start - j->submit;
+    double bsld = (double)(wait + j->run) / (double)(j->run > c->tau ? j->run : c->tau);
+    if (bsld < 1.0) bsld = 1.0;
+    int r = record(c, (unsigned int)wait, bsld);
+
+    scheduler_t *s = c->node[j->alloc[0]];
+    s->current_tick = c->now;
+    char info[160];
+    snprintf(info, sizeof(info), "\"pid\": %d, \"procs\": %d, \"run\": %lu, \"wait\": %lu, \"bounded_slowdown\": %.3f, \"killed\": %s",
+             j->id, j->procs, j->run, wait, bsld, j->killed ? "true" : "false");
+    char *ev = utils_build_event(EVT_JOB_FINISHED, s, NULL, info);
+    utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
+    free_job(j);
+    return r;
+}
+
+/* The queue head's reservation: when running jobs, ending at their limits,
+ * leave it enough units, and the units it leaves over then */
+static void reserve(cluster_t *c) {
+    int avail = c->free_units, need = c->head->units;
+    for (rb_node_t *r = rb_first(&c->running_limit); r; r = rb_next(r)) {
+        const cluster_job_t *j = rb_entry(r, cluster_job_t, by_limit);
+        avail += j->units;
+        if (avail >= need) {
+            c->shadow = limit_of(j);
+            c->extra = avail - need;
+            return;
+        }
+    }
+    /* cannot happen: jobs wider than the cluster never queue */
+    c->shadow = ULONG_MAX;
+    c->extra = 0;
+}
+
+/* Start what can start now. From the queue head: FCFS, then (EASY) a new
+ * reservation and backfilling behind it. From a job just submitted behind
+ * a blocked head (at position pos of the queue): only it and those after
+ * it can backfill, against the reservation already made. */
+static int schedule(cluster_t *c, cluster_job_t *from, int pos) {
+    if (from == c->head) {
+        while (c->head && c->head->units <= c->free_units) {
+            if (start_job(c, c->head, 0) < 0) return -1;
+        }
+        if (!c->head || !c->backfill) return 0;
+        reserve(c);
+        from = c->head->next;
+        pos = 1;
+    } else if (!c->backfill) {
+        return 0;
+    }
+    cluster_job_t *n;
+    for (cluster_job_t *j = from; j && c->free_units > 0; j = n, pos++) {
+        n = j->next;
+        if (c->backfill_depth && pos >= c->backfill_depth) break;
+        if (j->units > c->free_units) continue;
+        if (c->now + j->req <= c->shadow) {
+            if (start_job(c, j, 1) < 0) return -1;
+        } else if (j->units <= c->extra) {
+            c->extra -= j->units;
+            if (start_job(c, j, 1) < 0) return -1;
+        }
+    }
+    return 0;
+}
+
+long cluster_run(cluster_t *c, cluster_source_t *src) {
+    long submitted = 0;
+    c->units = c->alloc == ALLOC_EXCLUSIVE ? c->nodes : c->nodes * c->node_cpus;
+    c->free_units = c->units;
+
+    cluster_job_t *look;
+    if (next_job(c, src, &look) < 0) return -1;
+    if (look) c->now = c->first_submit = look->submit;
+
+    while (look || c->head || c->running_end.count) {
+        unsigned long t = look ? look->submit : ULONG_MAX;
+        rb_node_t *r = rb_first(&c->running_end);
+        if (r && end_of(rb_entry(r, cluster_job_t, by_end)) < t) t = end_of(rb_entry(r, cluster_job_t, by_end));
+        c->now = t;
+
+        int freed = 0;
+        while ((r = rb_first(&c->running_end)) && end_of(rb_entry(r, cluster_job_t, by_end)) <= t) {
+            if (finish_job(c, rb_entry(r, cluster_job_t, by_end)) < 0) return -1;
+            freed = 1;
+        }
+        cluster_job_t *fresh = NULL;
+        int pos = c->queued;
+        while (look && look->submit <= t) {
+            enqueue(c, look);
+            if (!fresh) fresh = look;
+            submitted++;
+            if (next_job(c, src, &look) < 0) return -1;
+        }
+
+        /* a job ending frees CPUs and can move the reservation: start over
+         * from the head; a submit alone only adds candidates */
+        int rc = 0;
+        if (freed || (fresh && fresh == c->head)) rc = schedule(c, c->head, 0);
+        else if (fresh) rc = schedule(c, fresh, pos);
+        if (rc < 0) return -1;
+    }
+    return submitted;
+}
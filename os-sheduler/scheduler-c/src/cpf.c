@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include "../include/cpf.h"
+#include "../include/utils.h"
+
+/* Critical path still ahead of p: its rank less the bursts it has done */
+static unsigned long path_left(const process_t *p) {
+    unsigned long rank = p->cp_rank ? p->cp_rank : (unsigned long)p->cpu_total + (unsigned long)p->io_total;
+    unsigned long done = (unsigned long)p->cpu_done;
+    for (int i = 1; p->bursts && i < p->burst_idx; i += 2) done += (unsigned long)p->bursts[i];
+    return rank > done ? rank - done : 0;
+}
+
+static int path_less(const process_t *a, const process_t *b) {
+    unsigned long pa = path_left(a), pb = path_left(b);
+    if (pa != pb) return pa > pb;
+    if (a->arrival != b->arrival) return a->arrival < b->arrival;
+    return a->pid < b->pid;
+}
+
+void cpf_tick(scheduler_t *s) {
+    if (!s) return;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        if (heap_push(&s->heap, p) < 0) break;   // out of memory: retry next tick
+        s->ready_head = p->next;
+        p->next = NULL;
+    }
+
+    if (!s->running && s->heap.len) scheduler_dispatch(s, scheduler_take(s, heap_pop(&s->heap)));
+
+    if (s->running) {
+        process_t *cur = s->running;
+        scheduler_consume(s, cur);
+
+        char info[128];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"path\":%lu",
+                 cur->pid, cur->remaining, path_left(cur));
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) scheduler_finish_burst(s);
+    }
+}
+
+void cpf_init(scheduler_t *s) {
+    heap_init(&s->heap, path_less);
+}
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../include/dag.h"
+
+/* pid -> job index, sorted by pid then workload order */
+typedef struct {
+    int pid;
+    int idx;
+} pid_key_t;
+
+static int cmp_pid(const void *a, const void *b) {
+    const pid_key_t *x = (const pid_key_t *)a, *y = (const pid_key_t *)b;
+    if (x->pid != y->pid) return x->pid < y->pid ? -1 : 1;
+    return x->idx - y->idx;
+}
+
+/* First job (in workload order) with this pid, -1 if none */
+static int lookup(const pid_key_t *keys, int n, int pid) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (keys[mid].pid < pid) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < n && keys[lo].pid == pid) ? keys[lo].idx : -1;
+}
+
+/* d->running is a min-heap of job indices on due, ties to the lower index */
+static int due_less(const dag_t *d, int a, int b) {
+    if (d->v[a].due != d->v[b].due) return d->v[a].due < d->v[b].due;
+    return a < b;
+}
+
+static void sift_down(dag_t *d, int k) {
+    for (;;) {
+        int l = 2 * k + 1, best = k;
+        if (l < d->nrunning && due_less(d, d->running[l], d->running[best])) best = l;
+        if (l + 1 < d->nrunning && due_less(d, d->running[l + 1], d->running[best])) best = l + 1;
+        if (best == k) return;
+        int t = d->running[k];
+        d->running[k] = d->running[best];
+        d->running[best] = t;
+        k = best;
+    }
+}
+
+/* Job idx can run and has dependants: each job comes here at most once, so
+ * the heap never outgrows the graph */
+static void push_running(dag_t *d, int idx) {
+    int k = d->nrunning++;
+    d->v[idx].due = 0;
+    while (k && due_less(d, idx, d->running[(k - 1) / 2])) {
+        d->running[k] = d->running[(k - 1) / 2];
+        k = (k - 1) / 2;
+    }
+    d->running[k] = idx;
+}
+
+/* Kahn's algorithm: fills order with the jobs reached
+ * (every job whose ancestors are acyclic) and returns how many there are */
+static int topo_order(int n, const int *pcount, const int *cstart, const int *children, int *indeg, int *order) {
+    int len = 0;
+    for (int i = 0; i < n; ++i) {
+        indeg[i] = pcount[i];
+        if (!indeg[i]) order[len++] = i;
+    }
+    for (int k = 0; k < len; ++k) {
+        int j = order[k];
+        for (int c = cstart[j]; c < cstart[j + 1]; ++c) {
+            if (--indeg[children[c]] == 0) order[len++] = children[c];
+        }
+    }
+    return len;
+}
+
+/* Children lists (CSR, in child order) from the parent lists; fill is n ints of scratch */
+static void link_children(int n, const int *pstart, const int *pcount, const int *parents,
+                          int *cstart, int *children, int *fill) {
+    memset(cstart, 0, (size_t)(n + 1) * sizeof(int));
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < pcount[i]; ++k) cstart[parents[pstart[i] + k] + 1]++;
+    }
+    for (int i = 0; i < n; ++i) cstart[i + 1] += cstart[i];
+    memcpy(fill, cstart, (size_t)n * sizeof(int));
+    for (int i = 0; i < n; ++i) {
+        for (int k = 0; k < pcount[i]; ++k) children[fill[parents[pstart[i] + k]]++] = i;
+    }
+}
+
+/* Tarjan's strongly connected components, without recursion: comp[i] is
+ * i's component. Returns how many jobs share a component with another,
+ * i.e. sit on a cycle, or -1 on OOM. */
+static int components(int n, const int *cstart, const int *children, int *comp) {
+    int *index = (int *)malloc((size_t)n * sizeof(int));
+    int *low = (int *)malloc((size_t)n * sizeof(int));
+    int *stack = (int *)malloc((size_t)n * sizeof(int));
+    int *calls = (int *)malloc((size_t)n * sizeof(int));
+    int *edge = (int *)malloc((size_t)n * sizeof(int));
+    int cyclic = -1;
+    if (!index || !low || !stack || !calls || !edge) goto out;
+
+    for (int i = 0; i < n; ++i) {
+        index[i] = -1;
+        comp[i] = -1;
+    }
+    int next = 0, sp = 0, ncomp = 0;
+    cyclic = 0;
+    for (int root = 0; root < n; ++root) {
+        if (index[root] >= 0) continue;
+        int depth = 0;
+        calls[depth++] = root;
+        index[root] = low[root] = next++;
+        edge[root] = cstart[root];
+        stack[sp++] = root;
+        while (depth) {
+            int v = calls[depth - 1];
+            if (edge[v] < cstart[v + 1]) {
+                int w = children[edge[v]++];
+                if (index[w] < 0) {
+                    index[w] = low[w] = next++;
+                    edge[w] = cstart[w];
+                    stack[sp++] = w;
+                    calls[depth++] = w;
+                } else if (comp[w] < 0 && index[w] < low[v]) {
+                    low[v] = index[w];   // w is still on the stack
+                }
+                continue;
+            }
+            depth--;
+            if (depth && low[v] < low[calls[depth - 1]]) low[calls[depth - 1]] = low[v];
+            if (low[v] != index[v]) continue;
+            int size = 0, w;
+            do {
+                w = stack[--sp];
+                comp[w] = ncomp;
+                size++;
+            } while (w != v);
+            if (size > 1) cyclic += size;
+            ncomp++;
+        }
+    }
+out:
+    free(index);
+    free(low);
+    free(stack);
+    free(calls);
+    free(edge);
+    return cyclic;
+}
+
+int dag_build(dag_t *d, process_t **jobs, int n) {
+    memset(d, 0, sizeof(*d));
+    if (n <= 0) return 0;
+
+    size_t total = 0;
+    for (int i = 0; i < n; ++i) total += (size_t)jobs[i]->nafter;
+    pid_key_t *keys = (pid_key_t *)malloc((size_t)n * sizeof(pid_key_t));
+    int *pstart = (int *)malloc((size_t)n * sizeof(int));
+    int *pcount = (int *)calloc((size_t)n, sizeof(int));
+    int *parents = (int *)malloc((total ? total : 1) * sizeof(int));
+    int *cstart = (int *)malloc((size_t)(n + 1) * sizeof(int));
+    int *children = (int *)malloc((total ? total : 1) * sizeof(int));
+    int *indeg = (int *)malloc((size_t)n * sizeof(int));
+    int *order = (int *)malloc((size_t)n * sizeof(int));
+    int *comp = (int *)malloc((size_t)n * sizeof(int));
+    unsigned long *ef = (unsigned long *)malloc((size_t)n * sizeof(unsigned long));
+    d->v = (dag_job_t *)calloc((size_t)n, sizeof(dag_job_t));
+    d->running = (int *)malloc((size_t)n * sizeof(int));
+    int rc = -1;
+    if (!keys || !pstart || !pcount || !parents || !cstart || !children || !indeg || !order || !comp || !ef || !d->v ||
+        !d->running)
+        goto out;
+
+    for (int i = 0; i < n; ++i) {
+        keys[i].pid = jobs[i]->pid;
+        keys[i].idx = i;
+    }
+    qsort(keys, (size_t)n, sizeof(pid_key_t), cmp_pid);
+
+    /* resolve each job's predecessors, dropping unknown pids, itself and repeats */
+    int at = 0;
+    for (int i = 0; i < n; ++i) {
+        process_t *p = jobs[i];
+        pstart[i] = at;
+        for (int k = 0; k < p->nafter; ++k) {
+            int j = lookup(keys, n, p->after[k]);
+            if (j < 0 || j == i) {
+                fprintf(stderr, "Warning: pid %d: ignoring predecessor %d (%s)\n", p->pid, p->after[k],
+                        j < 0 ? "not in the workload" : "itself");
+                continue;
+            }
+            int dup = 0;
+            for (int q = pstart[i]; q < at && !dup; ++q) dup = (parents[q] == j);
+            if (!dup) parents[at++] = j;
+        }
+        pcount[i] = at - pstart[i];
+    }
+
+    /* jobs Kahn cannot reach sit on or below a cycle: drop the edges inside
+     * each cycle (strongly connected component), which keeps the rest */
+    link_children(n, pstart, pcount, parents, cstart, children, indeg);
+    int len = topo_order(n, pcount, cstart, children, indeg, order);
+    if (len < n) {
+        int cyclic = components(n, cstart, children, comp);
+        if (cyclic < 0) goto out;
+        fprintf(stderr, "Warning: %d jobs form dependency cycles, dropping the dependencies among them\n", cyclic);
+        for (int i = 0; i < n; ++i) {
+            int kept = 0;
+            for (int k = 0; k < pcount[i]; ++k) {
+                int j = parents[pstart[i] + k];
+                if (comp[j] != comp[i]) parents[pstart[i] + kept++] = j;
+            }
+            pcount[i] = kept;
+        }
+        link_children(n, pstart, pcount, parents, cstart, children, indeg);
+        len = topo_order(n, pcount, cstart, children, indeg, order);
+    }
+
+    /* keep only the predecessors that count, so nafter tells dependent jobs apart */
+    for (int i = 0; i < n; ++i) {
+        process_t *p = jobs[i];
+        for (int k = 0; k < pcount[i]; ++k) p->after[k] = jobs[parents[pstart[i] + k]]->pid;
+        p->nafter = pcount[i];
+        if (!p->nafter) {
+            free(p->after);
+            p->after = NULL;
+        }
+    }
+
+    unsigned long first = ULONG_MAX, last = 0;
+    for (int k = 0; k < len; ++k) {
+        int i = order[k];
+        dag_job_t *j = &d->v[i];
+        j->arrival = jobs[i]->arrival;
+        j->length = (unsigned long)jobs[i]->cpu_total + (unsigned long)jobs[i]->io_total;
+        j->first = cstart[i];
+        j->nchildren = cstart[i + 1] - cstart[i];
+        j->waiting = pcount[i];
+        if (j->waiting) d->unreleased++;
+        d->work += (unsigned long)jobs[i]->cpu_total * (unsigned long)jobs[i]->width;
+
+        unsigned long es = j->arrival;
+        for (int q = 0; q < pcount[i]; ++q) {
+            if (ef[parents[pstart[i] + q]] > es) es = ef[parents[pstart[i] + q]];
+        }
+        ef[i] = es + j->length;
+        if (j->arrival < first) first = j->arrival;
+        if (ef[i] > last) last = ef[i];
+    }
+    d->path_bound = last - first;
+    for (int k = len - 1; k >= 0; --k) {
+        int i = order[k];
+        unsigned long down = 0;
+        for (int c = cstart[i]; c < cstart[i + 1]; ++c) {
+            if (jobs[children[c]]->cp_rank > down) down = jobs[children[c]]->cp_rank;
+        }
+        jobs[i]->cp_rank = d->v[i].length + down;
+        jobs[i]->dag_idx = i;
+    }
+
+    d->n = n;
+    d->nedges = cstart[n];
+    d->children = children;
+    children = NULL;
+    rc = 0;
+out:
+    free(keys);
+    free(pstart);
+    free(pcount);
+    free(parents);
+    free(cstart);
+    free(children);
+    free(indeg);
+    free(order);
+    free(comp);
+    free(ef);
+    if (rc < 0) {
+        free(d->v);
+        free(d->running);
+        memset(d, 0, sizeof(*d));
+    }
+    return rc;
+}
+
+int dag_arrive(dag_t *d, process_t *p) {
+    dag_job_t *j = &d->v[p->dag_idx];
+    j->proc = p;
+    j->arrived = 1;
+    if (j->waiting) return 0;
+    if (j->nchildren) push_running(d, p->dag_idx);
+    p->released = (unsigned int)(j->released > p->arrival ? j->released : p->arrival);
+    return 1;
+}
+
+process_t *dag_finish(dag_t *d, int idx, unsigned long now) {
+    dag_job_t *j = &d->v[idx];
+    process_t *head = NULL, **tail = &head;
+    j->finished = 1;
+    j->proc = NULL;
+    for (int c = j->first; c < j->first + j->nchildren; ++c) {
+        dag_job_t *k = &d->v[d->children[c]];
+        if (--k->waiting) continue;
+        k->released = now;
+        d->unreleased--;
+        if (!k->arrived) continue;
+        if (k->nchildren) push_running(d, d->children[c]);
+        process_t *p = k->proc;
+        p->released = (unsigned int)now;
+        p->next = NULL;
+        *tail = p;
+        tail = &p->next;
+    }
+    return head;
+}
+
+unsigned long dag_next_finish(dag_t *d, unsigned long now, unsigned int speed) {
+    if (!speed) return ULONG_MAX;
+    while (d->nrunning) {
+        dag_job_t *j = &d->v[d->running[0]];
+        if (j->finished) {
+            d->running[0] = d->running[--d->nrunning];
+            sift_down(d, 0);
+            continue;
+        }
+        /* the bound only grows: once the top's is current, it is the least */
+        const process_t *p = j->proc;
+        unsigned long work = (unsigned long)(p->cpu_total - p->cpu_done) * 100;
+        work = work > p->work_acc ? work - p->work_acc : 1;
+        unsigned long t = now + (work + speed - 1) / speed;
+        if (t == j->due) return t;
+        j->due = t;
+        sift_down(d, 0);
+    }
+    return ULONG_MAX;
+}
+
+void dag_free(dag_t *d) {
+    if (!d) return;
+    for (int i = 0; i < d->n; ++i) {
+        if (d->v[i].proc && d->v[i].waiting) process_free(d->v[i].proc);
+    }
+    free(d->v);
+    free(d->children);
+    free(d->running);
+    memset(d, 0, sizeof(*d));
+}
@@ -0,0 +1,76 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../include/disk.h"
+
+static long distance(long a, long b) {
+    return a > b ? a - b : b - a;
+}
+
+/* Unlink p (prev is its predecessor, NULL for the head) from the device queue */
+static process_t *unlink_request(scheduler_t *s, process_t *prev, process_t *p) {
+    if (prev) prev->next = p->next;
+    else s->io_head = p->next;
+    if (s->io_tail == p) s->io_tail = prev;
+    p->next = NULL;
+    return p;
+}
+
+/* LOOK: the closest request at or beyond the head in the current direction;
+ * if there is none, turn around. Equal blocks go in arrival order.
+ */
+static process_t *pick_elevator(scheduler_t *s) {
+    for (int pass = 0; pass < 2; ++pass) {
+        process_t *best = NULL, *best_prev = NULL, *prev = NULL;
+        for (process_t *p = s->io_head; p; prev = p, p = p->next) {
+            long d = (long)p->io_block - s->disk_pos;
+            if (s->disk_dir < 0) d = -d;
+            if (d < 0) continue;
+            if (!best || d < distance(best->io_block, s->disk_pos)) {
+                best = p;
+                best_prev = prev;
+            }
+        }
+        if (best) return unlink_request(s, best_prev, best);
+        s->disk_dir = -s->disk_dir;
+    }
+    return NULL;
+}
+
+process_t *disk_pick(scheduler_t *s) {
+    if (!s || !s->io_head) return NULL;
+    switch (s->disk_policy) {
+        case DISK_SCAN:
+            return pick_elevator(s);
+        case DISK_DEADLINE:
+            /* the queue is in arrival order, so its head is the oldest request */
+            if (s->current_tick - s->io_head->io_enqueued_tick >= s->io_deadline)
+                return unlink_request(s, NULL, s->io_head);
+            return pick_elevator(s);
+        case DISK_FIFO:
+        default:
+            return unlink_request(s, NULL, s->io_head);
+    }
+}
+
+unsigned long disk_seek_ticks(const scheduler_t *s, long block) {
+    if (!s || !s->seek_rate) return 0;
+    unsigned long d = (unsigned long)distance(block, s->disk_pos);
+    return (d + s->seek_rate - 1) / s->seek_rate;
+}
+
+const char *disk_policy_name(disk_sched_t policy) {
+    switch (policy) {
+        case DISK_SCAN: return "scan";
+        case DISK_DEADLINE: return "deadline";
+        case DISK_FIFO:
+        default: return "fifo";
+    }
+}
+
+int disk_parse_policy(const char *name) {
+    if (!name) return -1;
+    if (strcmp(name, "fifo") == 0) return DISK_FIFO;
+    if (strcmp(name, "scan") == 0) return DISK_SCAN;
+    if (strcmp(name, "deadline") == 0) return DISK_DEADLINE;
+    return -1;
+}
@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/dvfs.h"
+#include "../include/scheduler.h"
+
+void dvfs_init(dvfs_t *d) {
+    static const unsigned int levels[] = {40, 60, 80, 100};
+    memset(d, 0, sizeof(*d));
+    d->governor = GOV_SCHEDUTIL;
+    d->nlevels = (int)(sizeof(levels) / sizeof(levels[0]));
+    memcpy(d->levels, levels, sizeof(levels));
+    d->p_static = 0.3;
+    d->p_dynamic = 1.7;
+    d->p_idle = 0.05;
+}
+
+int dvfs_parse_governor(const char *name) {
+    if (strcmp(name, "performance") == 0) return GOV_PERFORMANCE;
+    if (strcmp(name, "powersave") == 0) return GOV_POWERSAVE;
+    if (strcmp(name, "schedutil") == 0) return GOV_SCHEDUTIL;
+    return -1;
+}
+
+const char *dvfs_governor_name(governor_t g) {
+    switch (g) {
+        case GOV_PERFORMANCE: return "performance";
+        case GOV_POWERSAVE: return "powersave";
+        default: return "schedutil";
+    }
+}
+
+static int cmp_level(const void *a, const void *b) {
+    unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
+}
+
+int dvfs_parse_levels(dvfs_t *d, const char *spec) {
+    unsigned int v[DVFS_MAX_LEVELS];
+    int n = 0;
+    const char *p = spec;
+    while (*p) {
+        char *end;
+        unsigned long f = strtoul(p, &end, 10);
+        if (end == p || f < 1 || f > 100 || n == DVFS_MAX_LEVELS) return -1;
+        v[n++] = (unsigned int)f;
+        p = end;
+        if (*p == ',') p++;
+        else if (*p) return -1;
+    }
+    if (!n) return -1;
+    qsort(v, (size_t)n, sizeof(v[0]), cmp_level);
+    int k = 0;
+    for (int i = 0; i < n; ++i) if (!k || v[i] != v[k - 1]) v[k++] = v[i];
+    if (v[k - 1] != 100) {
+        if (k == DVFS_MAX_LEVELS) return -1;
+        v[k++] = 100;
+    }
+    memcpy(d->levels, v, (size_t)k * sizeof(v[0]));
+    d->nlevels = k;
+    return 0;
+}
+
+int dvfs_parse_power(dvfs_t *d, const char *spec) {
+    double st, dyn, idle;
+    char tail;
+    if (sscanf(spec, "%lf,%lf,%lf%c", &st, &dyn, &idle, &tail) != 3) return -1;
+    if (st < 0 || dyn < 0 || idle < 0) return -1;
+    d->p_static = st;
+    d->p_dynamic = dyn;
+    d->p_idle = idle;
+    return 0;
+}
+
+void dvfs_attach(scheduler_t *s, const dvfs_t *d) {
+    dvfs_cpu_t *v = &s->freq;
+    memset(v, 0, sizeof(*v));
+    v->cfg = d;
+    v->capacity = s->speed;
+    v->level = d->governor == GOV_PERFORMANCE ? d->nlevels - 1 : 0;
+}
+
+/* The level the governor wants for the coming tick */
+static int pick(const dvfs_cpu_t *v) {
+    const dvfs_t *d = v->cfg;
+    if (d->governor == GOV_PERFORMANCE) return d->nlevels - 1;
+    if (d->governor == GOV_POWERSAVE) return 0;
+    double want = 1.25 * v->util * 100.0;
+    for (int i = 0; i < d->nlevels; ++i) {
+        if ((double)d->levels[i] >= want) return i;
+    }
+    return d->nlevels - 1;
+}
+
+unsigned int dvfs_charge(scheduler_t *s, process_t *p) {
+    dvfs_cpu_t *v = &s->freq;
+    const dvfs_t *d = v->cfg;
+    double decay = pow(0.5, 1.0 / DVFS_HALF_LIFE);
+
+    /* the idle ticks since the last busy one count as zeros */
+    if (s->current_tick > v->util_tick + 1) v->util *= pow(decay, (double)(s->current_tick - v->util_tick - 1));
+    int level = pick(v);
+    if (level != v->level) {
+        v->switches++;
+        v->level = level;
+    }
+    double f = d->levels[level] / 100.0;
+    v->util = v->util * decay + (1.0 - decay) * f;
+    v->util_tick = s->current_tick;
+    v->level_ticks[level]++;
+
+    double joules = v->capacity / 100.0 * (d->p_static + d->p_dynamic * f * f * f) * DVFS_TICK_SECONDS;
+    v->energy += joules;
+    if (p) p->energy += joules;
+
+    unsigned int speed = v->capacity * d->levels[level] / 100;
+    return speed ? speed : 1;
+}
+
+double dvfs_idle_power(const scheduler_t *s) {
+    return s->freq.cfg ? s->freq.capacity / 100.0 * s->freq.cfg->p_idle : 0.0;
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <limits.h>
+#include "../include/edf.h"
+#include "../include/utils.h"
+
+static int deadline_less(const process_t *a, const process_t *b) {
+    if (a->deadline != b->deadline) return a->deadline < b->deadline;
+    if (a->arrival != b->arrival) return a->arrival < b->arrival;
+    return a->pid < b->pid;
+}
+
+/* rate-monotonic: shorter period first, aperiodic jobs last in arrival order */
+static int period_less(const process_t *a, const process_t *b) {
+    unsigned long pa = a->period ? a->period : ULONG_MAX, pb = b->period ? b->period : ULONG_MAX;
+    if (pa != pb) return pa < pb;
+    if (a->period && a->pid != b->pid) return a->pid < b->pid;
+    if (a->arrival != b->arrival) return a->arrival < b->arrival;
+    return a->pid < b->pid;
+}
+
+void edf_tick(scheduler_t *s) {
+    if (!s) return;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        if (heap_push(&s->heap, p) < 0) break;   // out of memory: retry next tick
+        s->ready_head = p->next;
+        p->next = NULL;
+    }
+
+    process_t *top = heap_peek(&s->heap);
+    if (s->running && top && s->heap.less(top, s->running)) {
+        process_t *cur = s->running;
+        char info[128];
+        snprintf(info, sizeof(info), "\"reason\":\"%s\", \"preempted_by\":%d",
+                 s->algo == ALG_RM ? "priority" : "deadline", top->pid);
+        char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+
+        s->running = NULL;
+        scheduler_dispatch(s, scheduler_take(s, heap_pop(&s->heap)));
+        cur->state = PROC_READY;
+        cur->last_enqueued_tick = (unsigned int)s->current_tick;
+        if (heap_push(&s->heap, cur) < 0) scheduler_add_process(s, cur);
+    }
+    if (!s->running && top) scheduler_dispatch(s, scheduler_take(s, heap_pop(&s->heap)));
+
+    if (s->running) {
+        process_t *cur = s->running;
+        scheduler_consume(s, cur);
+
+        char info[128];
+        if (cur->deadline != UINT_MAX)
+            snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"deadline\":%u",
+                     cur->pid, cur->remaining, cur->deadline);
+        else
+            snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d", cur->pid, cur->remaining);
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) scheduler_finish_burst(s);
+    }
+}
+
+void edf_init(scheduler_t *s) {
+    heap_init(&s->heap, deadline_less);
+}
+
+void rm_init(scheduler_t *s) {
+    heap_init(&s->heap, period_less);
+}
+
+void edf_clear(scheduler_t *s) {
+    if (!s) return;
+    while (s->heap.len) process_free(heap_pop(&s->heap));
+    heap_free(&s->heap);
+}
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include "../include/eevdf.h"
+#include "../include/cfs.h"
+#include "../include/utils.h"
+
+static process_t *node_proc(const rb_node_t *n) {
+    return rb_entry(n, process_t, rb);
+}
+
+/* a process placed with positive lag can start below zero, so vruntimes
+ * and deadlines are compared by signed difference */
+static int before(unsigned long long a, unsigned long long b) {
+    return (long long)(a - b) < 0;
+}
+
+static int vruntime_less(const rb_node_t *a, const rb_node_t *b) {
+    return before(node_proc(a)->vruntime, node_proc(b)->vruntime);
+}
+
+static void min_deadline_update(rb_node_t *n) {
+    process_t *p = node_proc(n);
+    unsigned long long m = p->vdeadline;
+    if (n->left && before(node_proc(n->left)->min_deadline, m)) m = node_proc(n->left)->min_deadline;
+    if (n->right && before(node_proc(n->right)->min_deadline, m)) m = node_proc(n->right)->min_deadline;
+    p->min_deadline = m;
+}
+
+static unsigned long long to_vruntime(unsigned long long ticks_scaled, const process_t *p) {
+    return ticks_scaled * NICE_0_WEIGHT / cfs_weight(p->priority);
+}
+
+/* one request of min_granularity ticks of service, in vruntime */
+static unsigned long long vslice(const scheduler_t *s, const process_t *p) {
+    return to_vruntime(s->min_granularity * VR_SCALE, p);
+}
+
+static long long key(const scheduler_t *s, const process_t *p) {
+    return (long long)(p->vruntime - s->min_vruntime);
+}
+
+static void enqueue(scheduler_t *s, process_t *p) {
+    unsigned long w = cfs_weight(p->priority);
+    p->state = PROC_READY;
+    p->last_enqueued_tick = (unsigned int)s->current_tick;
+    s->rq_weight += w;
+    s->avg_vruntime += key(s, p) * (long long)w;
+    rb_insert(&s->rq, &p->rb);
+}
+
+static process_t *dequeue(scheduler_t *s, process_t *p) {
+    unsigned long w = cfs_weight(p->priority);
+    rb_erase(&s->rq, &p->rb);
+    s->rq_weight -= w;
+    s->avg_vruntime -= key(s, p) * (long long)w;
+    return scheduler_take(s, p);
+}
+
+static process_t *leftmost(const scheduler_t *s) {
+    rb_node_t *n = rb_first(&s->rq);
+    return n ? node_proc(n) : NULL;
+}
+
+/* V - min_vruntime as avg / load, with the running process counted in */
+static long long avg_load(const scheduler_t *s, long long *load) {
+    long long avg = s->avg_vruntime;
+    long long l = (long long)s->rq_weight;
+    if (s->running) {
+        long long w = (long long)cfs_weight(s->running->priority);
+        avg += key(s, s->running) * w;
+        l += w;
+    }
+    *load = l;
+    return avg;
+}
+
+static unsigned long long avg_vruntime(const scheduler_t *s) {
+    long long load;
+    long long avg = avg_load(s, &load);
+    if (load) {
+        if (avg < 0) avg -= load - 1;   // round down
+        avg /= load;
+    }
+    return s->min_vruntime + (unsigned long long)avg;
+}
+
+/* vruntime <= V, without the rounding of avg_vruntime() */
+static int eligible(const scheduler_t *s, const process_t *p) {
+    long long load;
+    long long avg = avg_load(s, &load);
+    return avg >= key(s, p) * load;
+}
+
+static void update_min_vruntime(scheduler_t *s) {
+    process_t *left = leftmost(s);
+    unsigned long long vr = s->min_vruntime;
+    if (s->running) vr = s->running->vruntime;
+    if (left && (!s->running || before(left->vruntime, vr))) vr = left->vruntime;
+    if (before(s->min_vruntime, vr)) {
+        /* keys are relative to min_vruntime */
+        s->avg_vruntime -= (long long)s->rq_weight * (long long)(vr - s->min_vruntime);
+        s->min_vruntime = vr;
+    }
+}
+
+/* Record p's lag at a scheduling point; keep it (bounded) for placement */
+static void update_lag(const scheduler_t *s, process_t *p) {
+    long long lag = (long long)(avg_vruntime(s) - p->vruntime);
+    double service = (double)(lag < 0 ? -lag : lag) * (double)cfs_weight(p->priority)
+                     / (double)NICE_0_WEIGHT / (double)VR_SCALE;
+    if (service > p->max_lag) p->max_lag = service;
+    long long limit = 2 * (long long)vslice(s, p);
+    if (lag > limit) lag = limit;
+    if (lag < -limit) lag = -limit;
+    p->vlag = lag;
+}
+
+/* Earliest eligible deadline: the running process, or a descent of s->rq.
+ * Eligibility only depends on vruntime, so an eligible node has an
+ * eligible left subtree, whose min_deadline tells if it holds the answer.
+ */
+static process_t *pick(const scheduler_t *s) {
+    process_t *curr = s->running;
+    if (curr && !eligible(s, curr)) curr = NULL;
+
+    process_t *best = NULL, *best_left = NULL;
+    rb_node_t *n = s->rq.root;
+    while (n) {
+        process_t *p = node_proc(n);
+        if (!eligible(s, p)) {
+            n = n->left;
+            continue;
+        }
+        if (!best || before(p->vdeadline, best->vdeadline)) best = p;
+        if (n->left) {
+            process_t *l = node_proc(n->left);
+            if (!best_left || before(l->min_deadline, best_left->min_deadline)) best_left = l;
+            if (l->min_deadline == p->min_deadline) break;
+        }
+        if (p->vdeadline == p->min_deadline) break;
+        n = n->right;
+    }
+    if (best_left && before(best_left->min_deadline, best->vdeadline)) {
+        /* walk down to the node the subtree minimum came from */
+        n = &best_left->rb;
+        for (;;) {
+            process_t *p = node_proc(n);
+            if (p->vdeadline == p->min_deadline) {
+                best = p;
+                break;
+            }
+            if (n->left && node_proc(n->left)->min_deadline == p->min_deadline) n = n->left;
+            else n = n->right;
+        }
+    }
+    /* something is always eligible; guard against rounding anyway */
+    if (!best && !curr) best = leftmost(s);
+    if (curr && (!best || !before(best->vdeadline, curr->vdeadline))) return curr;
+    return best;
+}
+
+static void place(scheduler_t *s, process_t *p) {
+    unsigned long long slice = vslice(s, p);
+    long long lag = 0;
+    if (p->run_ticks > 0 && p->last_cpu == s->cpu_id) {
+        /* joining raises the load V is averaged over; scale the lag so that
+         * V - vruntime comes out at what it was when p left */
+        long long load;
+        avg_load(s, &load);
+        lag = p->vlag;
+        if (load) lag = lag * (load + (long long)cfs_weight(p->priority)) / load;
+    }
+    p->vruntime = avg_vruntime(s) - (unsigned long long)lag;
+    /* a new process asks for half a request first, so it is picked sooner */
+    p->vdeadline = p->vruntime + (p->run_ticks == 0 ? slice / 2 : slice);
+}
+
+static void dispatch(scheduler_t *s, process_t *p) {
+    update_lag(s, p);
+    p->slice_ran = 0;
+    scheduler_dispatch(s, p);
+}
+
+static void preempt(scheduler_t *s, process_t *next, const char *reason) {
+    process_t *cur = s->running;
+    update_lag(s, cur);
+    s->running = NULL;
+    enqueue(s, cur);
+    dequeue(s, next);
+
+    char info[128];
+    snprintf(info, sizeof(info), "\"reason\":\"%s\", \"preempted_by\":%d", reason, next->pid);
+    char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, cur, info);
+    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+    dispatch(s, next);
+}
+
+void eevdf_tick(scheduler_t *s) {
+    if (!s) return;
+
+    const char *reason = NULL;
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        s->ready_head = p->next;
+        p->next = NULL;
+        unsigned int queued = p->last_enqueued_tick;
+        place(s, p);
+        enqueue(s, p);
+        p->last_enqueued_tick = queued;
+        reason = "wakeup";
+    }
+
+    process_t *cur = s->running;
+    if (cur && !before(cur->vruntime, cur->vdeadline)) {
+        /* request served: the next one gets a new deadline */
+        cur->vdeadline = cur->vruntime + vslice(s, cur);
+        reason = "deadline";
+    }
+    if (cur && reason && s->rq.count) {
+        process_t *next = pick(s);
+        if (next != cur) preempt(s, next, reason);
+    }
+    if (!s->running && s->rq.count) {
+        process_t *next = pick(s);
+        dispatch(s, dequeue(s, next));
+    }
+
+    if (s->running) {
+        cur = s->running;
+        /* a stall serves none of the request, so its deadline stays ahead */
+        if (scheduler_consume(s, cur)) {
+            cur->slice_ran++;
+            cur->vruntime += to_vruntime(VR_SCALE, cur);
+            update_min_vruntime(s);
+        }
+
+        char info[192];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"vruntime\":%.3f, \"deadline\":%.3f, \"lag\":%.3f",
+                 cur->pid, cur->remaining, (double)(long long)cur->vruntime / (double)VR_SCALE,
+                 (double)(long long)cur->vdeadline / (double)VR_SCALE,
+                 (double)(long long)(avg_vruntime(s) - cur->vruntime) / (double)VR_SCALE);
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) {
+            /* burst done: keep the lag for the next wakeup, then finish or block */
+            update_lag(s, cur);
+            scheduler_finish_burst(s);
+        }
+    }
+}
+
+void eevdf_leave(scheduler_t *s, process_t *p) {
+    if (s && p) update_lag(s, p);
+}
+
+void eevdf_init(scheduler_t *s) {
+    rb_init(&s->rq, vruntime_less, min_deadline_update);
+    s->rq_weight = 0;
+    s->min_vruntime = 0;
+    s->avg_vruntime = 0;
+}
@@ -30,21 +30,12 @@ void fcfs_tick(scheduler_t *s) {
     }
 
     if (s->running) {
-        if (s->running->remaining > 0) s->running->remaining -= 1;
+        scheduler_consume(s, s->running);
         char info[128];
         snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d", s->running->pid, s->running->remaining);
         char *ev = utils_build_event(EVT_GANTT_SLICE, s, s->running, info);
         utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
 
-        if (s->running->remaining <= 0) {
-            s->running->state = PROC_TERMINATED;
-            s->running->finish_time = s->current_tick;
-            ev = utils_build_event(EVT_JOB_FINISHED, s, s->running, NULL);
-            utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
-            /* record completed snapshot then free */
-            scheduler_record_completed(s, s->running);
-            process_free(s->running);
-            s->running = NULL;
-        }
+        if (s->running->remaining <= 0) scheduler_finish_burst(s);
     }
 }
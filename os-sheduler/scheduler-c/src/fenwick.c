@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include "../include/fenwick.h"
+
+void fenwick_init(fenwick_t *f) {
+    f->v = NULL;
+    f->w = NULL;
+    f->sum = NULL;
+    f->len = 0;
+    f->cap = 0;
+    f->total = 0;
+}
+
+static void add(fenwick_t *f, size_t slot, unsigned long d) {
+    for (size_t i = slot + 1; i <= f->cap; i += i & (~i + 1)) f->sum[i] += d;
+}
+
+static void sub(fenwick_t *f, size_t slot, unsigned long d) {
+    for (size_t i = slot + 1; i <= f->cap; i += i & (~i + 1)) f->sum[i] -= d;
+}
+
+/* Double the capacity and rebuild the partial sums in O(n) */
+static int grow(fenwick_t *f) {
+    size_t cap = f->cap ? f->cap * 2 : 16;
+    process_t **v = (process_t **)realloc(f->v, cap * sizeof(process_t *));
+    if (!v) return -1;
+    f->v = v;
+    unsigned long *w = (unsigned long *)realloc(f->w, cap * sizeof(unsigned long));
+    if (!w) return -1;
+    f->w = w;
+    unsigned long *sum = (unsigned long *)realloc(f->sum, (cap + 1) * sizeof(unsigned long));
+    if (!sum) return -1;
+    f->sum = sum;
+    f->cap = cap;
+
+    sum[0] = 0;
+    for (size_t i = 1; i <= cap; ++i) sum[i] = i <= f->len ? w[i - 1] : 0;
+    for (size_t i = 1; i <= cap; ++i) {
+        size_t up = i + (i & (~i + 1));
+        if (up <= cap) sum[up] += sum[i];
+    }
+    return 0;
+}
+
+int fenwick_push(fenwick_t *f, process_t *p, unsigned long tickets) {
+    if (f->len == f->cap && grow(f) < 0) return -1;
+    size_t i = f->len++;
+    f->v[i] = p;
+    f->w[i] = tickets;
+    add(f, i, tickets);
+    f->total += tickets;
+    return 0;
+}
+
+size_t fenwick_find(const fenwick_t *f, unsigned long r) {
+    /* descend from the largest power of two: sum[pos + step] covers the
+     * slots pos .. pos + step - 1 */
+    size_t pos = 0;
+    for (size_t step = f->cap; step; step >>= 1) {
+        if (pos + step <= f->cap && f->sum[pos + step] <= r) {
+            pos += step;
+            r -= f->sum[pos];
+        }
+    }
+    return pos;
+}
+
+process_t *fenwick_take(fenwick_t *f, size_t i) {
+    process_t *p = f->v[i];
+    size_t last = f->len - 1;
+    sub(f, i, f->w[i]);
+    f->total -= f->w[i];
+    if (i != last) {
+        sub(f, last, f->w[last]);
+        add(f, i, f->w[last]);
+        f->v[i] = f->v[last];
+        f->w[i] = f->w[last];
+    }
+    f->len--;
+    return p;
+}
+
+void fenwick_free(fenwick_t *f) {
+    free(f->v);
+    free(f->w);
+    free(f->sum);
+    fenwick_init(f);
+}
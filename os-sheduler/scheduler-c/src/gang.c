@@ -0,0 +1,576 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../include/gang.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+void gang_init(gang_t *g) {
+    memset(g, 0, sizeof(*g));
+    g->mode = COSCHED_FILL;
+    g->slice = GANG_SLICE_DEFAULT;
+}
+
+const char *gang_mode_name(cosched_t mode) {
+    switch (mode) {
+        case COSCHED_STRICT: return "strict";
+        case COSCHED_NONE: return "none";
+        default: return "fill";
+    }
+}
+
+int gang_parse_mode(const char *name) {
+    if (strcmp(name, "strict") == 0) return COSCHED_STRICT;
+    if (strcmp(name, "fill") == 0) return COSCHED_FILL;
+    if (strcmp(name, "none") == 0) return COSCHED_NONE;
+    return -1;
+}
+
+/* A job's thread in one cell, pinned to that column's CPU */
+typedef struct {
+    unsigned long work;      // work units done in the job's current burst
+    unsigned int ticks;      // ticks it held the CPU (run_ticks for scheduler_charge_dispatch)
+    unsigned long mark;      // and its cache_mark
+} thread_t;
+
+/* The Ousterhout matrix and the run's state */
+typedef struct {
+    smp_t *m;
+    gang_t *g;
+    int ncpus;
+    process_t **cell;        // rows x ncpus, row by row
+    thread_t *thread;        // per cell
+    int rows, cap;
+    int cur;                 // active row (strict, fill)
+    unsigned long left;      // ticks left in its slice
+    int *col_row;            // none: row each CPU runs
+    unsigned long *col_left; // none: ticks left in that CPU's slice
+    process_t **occ;         // job on each CPU this tick
+    process_t **prev;        // and the tick before
+    unsigned long *step;     // work each CPU's thread did this tick
+    unsigned char *stalled;  // and whether it stalled instead (switch, cache refill)
+    process_t *queue;        // waiting for room, in arrival order
+    process_t **queue_tail;
+    process_t *released;     // dependants released this tick (see dag.h)
+    process_t **released_tail;
+    int placed;              // jobs in the matrix
+    unsigned long now;
+} matrix_t;
+
+#define CELL(x, r, c) ((x)->cell[(size_t)(r) * (size_t)(x)->ncpus + (size_t)(c)])
+#define THREAD(x, r, c) ((x)->thread[(size_t)(r) * (size_t)(x)->ncpus + (size_t)(c)])
+
+static int runnable(const process_t *p) {
+    return p && p->state != PROC_WAITING;
+}
+
+/* The job at row r, column c, if its cells start there (each job once) */
+static process_t *job_at(const matrix_t *x, int r, int c) {
+    process_t *p = CELL(x, r, c);
+    return (p && p->gang_col == c) ? p : NULL;
+}
+
+/* Does row r have a runnable job (in column col, or any column if col < 0)? */
+static int row_runnable(const matrix_t *x, int r, int col) {
+    if (col >= 0) return runnable(CELL(x, r, col));
+    for (int c = 0; c < x->ncpus; ++c) {
+        if (runnable(CELL(x, r, c))) return 1;
+    }
+    return 0;
+}
+
+/* First row after r, cyclically and ending with r itself, with a runnable
+ * job (in column col if col >= 0); r if there is none */
+static int next_row(const matrix_t *x, int r, int col) {
+    for (int k = 1; k <= x->rows; ++k) {
+        int q = (r + k) % x->rows;
+        if (row_runnable(x, q, col)) return q;
+    }
+    return r;
+}
+
+static void switch_row(matrix_t *x) {
+    int r = next_row(x, x->cur, -1);
+    if (r != x->cur) x->g->row_switches++;
+    x->cur = r;
+    x->left = x->g->slice;
+}
+
+static int add_row(matrix_t *x) {
+    if (x->rows == x->cap) {
+        int cap = x->cap ? x->cap * 2 : 4;
+        process_t **cell = (process_t **)realloc(x->cell, (size_t)cap * (size_t)x->ncpus * sizeof(process_t *));
+        if (!cell) return -1;
+        x->cell = cell;
+        thread_t *thread = (thread_t *)realloc(x->thread, (size_t)cap * (size_t)x->ncpus * sizeof(thread_t));
+        if (!thread) return -1;
+        x->thread = thread;
+        x->cap = cap;
+    }
+    memset(&CELL(x, x->rows, 0), 0, (size_t)x->ncpus * sizeof(process_t *));
+    x->rows++;
+    if (x->rows > x->g->rows_peak) x->g->rows_peak = x->rows;
+    return 0;
+}
+
+/* Drop the rows that emptied, keeping the active row (or the one after it)
+ * and every CPU's row under 'none' */
+static void compact(matrix_t *x) {
+    int r = 0;
+    while (r < x->rows) {
+        int empty = 1;
+        for (int c = 0; c < x->ncpus && empty; ++c) empty = !CELL(x, r, c);
+        if (!empty) {
+            r++;
+            continue;
+        }
+        if (r + 1 < x->rows) {
+            size_t cells = (size_t)(x->rows - r - 1) * (size_t)x->ncpus;
+            memmove(&CELL(x, r, 0), &CELL(x, r + 1, 0), cells * sizeof(process_t *));
+            memmove(&THREAD(x, r, 0), &THREAD(x, r + 1, 0), cells * sizeof(thread_t));
+        }
+        x->rows--;
+        for (int q = r; q < x->rows; ++q) {
+            for (int c = 0; c < x->ncpus; ++c) {
+                if (job_at(x, q, c)) CELL(x, q, c)->gang_row = q;
+            }
+        }
+        if (x->cur > r) x->cur--;
+        else if (x->cur == r) x->left = x->g->slice;
+        for (int c = 0; x->col_row && c < x->ncpus; ++c) {
+            if (x->col_row[c] > r) x->col_row[c]--;
+            else if (x->col_row[c] == r) x->col_left[c] = x->g->slice;
+        }
+    }
+    if (x->cur >= x->rows) x->cur = 0;
+    for (int c = 0; x->col_row && c < x->ncpus; ++c) {
+        if (x->col_row[c] >= x->rows) x->col_row[c] = 0;
+    }
+}
+
+/* First fit: p takes width free cells side by side in the first row that
+ * has them, or in a new row. Returns 1 if placed, 0 if the matrix is full,
+ * -1 on OOM. */
+static int place(matrix_t *x, process_t *p) {
+    for (int r = 0; r <= x->rows; ++r) {
+        if (r == x->rows) {
+            if (x->g->max_rows && x->rows >= x->g->max_rows) return 0;
+            if (add_row(x) < 0) return -1;
+        }
+        int run = 0;
+        for (int c = 0; c < x->ncpus; ++c) {
+            run = CELL(x, r, c) ? 0 : run + 1;
+            if (run < p->width) continue;
+            p->gang_row = r;
+            p->gang_col = c - p->width + 1;
+            for (int k = 0; k < p->width; ++k) {
+                CELL(x, r, p->gang_col + k) = p;
+                memset(&THREAD(x, r, p->gang_col + k), 0, sizeof(thread_t));
+            }
+            p->state = PROC_READY;
+            x->placed++;
+
+            scheduler_t *s = x->m->cpus[p->gang_col];
+            char info[160];
+            int len = snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%u", p->pid, p->arrival);
+            if (p->nafter) len += snprintf(info + len, sizeof(info) - (size_t)len, ", \"released\":%u", p->released);
+            snprintf(info + len, sizeof(info) - (size_t)len, ", \"row\":%d, \"width\":%d", r, p->width);
+            char *ev = utils_build_event(EVT_JOB_RESUMED, s, p, info);
+            utils_emit_event_and_free(ev, EVT_JOB_RESUMED, s);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* p arrived (or was released) this tick: place it, or queue it */
+static int admit(matrix_t *x, process_t *p) {
+    int rc = place(x, p);
+    if (rc != 0) return rc;
+    p->gang_since = x->now;
+    p->next = NULL;
+    *x->queue_tail = p;
+    x->queue_tail = &p->next;
+    x->g->queued++;
+    return 0;
+}
+
+/* Place the queued jobs that fit now, oldest first */
+static int drain_queue(matrix_t *x) {
+    process_t **link = &x->queue;
+    while (*link) {
+        process_t *p = *link;
+        int rc = place(x, p);
+        if (rc < 0) return -1;
+        if (!rc) {
+            link = &p->next;
+            continue;
+        }
+        *link = p->next;
+        p->next = NULL;
+        unsigned long wait = x->now - p->gang_since;
+        x->g->queue_wait += wait;
+        if (wait > x->g->queue_wait_max) x->g->queue_wait_max = wait;
+    }
+    x->queue_tail = link;
+    return 0;
+}
+
+/* Who holds each CPU this tick */
+static void choose(matrix_t *x) {
+    memset(x->occ, 0, (size_t)x->ncpus * sizeof(process_t *));
+    if (!x->rows) return;
+    if (x->g->mode == COSCHED_NONE) {
+        for (int c = 0; c < x->ncpus; ++c) {
+            if (!row_runnable(x, x->col_row[c], c)) {
+                int r = next_row(x, x->col_row[c], c);
+                if (r != x->col_row[c]) x->col_left[c] = x->g->slice;
+                x->col_row[c] = r;
+            }
+            process_t *q = CELL(x, x->col_row[c], c);
+            if (runnable(q)) x->occ[c] = q;
+        }
+        return;
+    }
+
+    if (!row_runnable(x, x->cur, -1)) switch_row(x);
+    for (int c = 0; c < x->ncpus; ++c) {
+        process_t *q = CELL(x, x->cur, c);
+        if (runnable(q)) x->occ[c] = q;
+    }
+    if (x->g->mode != COSCHED_FILL) return;
+    /* alternates, nearest row first: jobs whose cells the active row leaves free */
+    for (int k = 1; k < x->rows; ++k) {
+        int r = (x->cur + k) % x->rows;
+        for (int c = 0; c < x->ncpus; ++c) {
+            process_t *q = job_at(x, r, c);
+            if (!runnable(q)) continue;
+            int fits = 1;
+            for (int j = c; j < c + q->width && fits; ++j) fits = !x->occ[j];
+            if (!fits) continue;
+            for (int j = c; j < c + q->width; ++j) x->occ[j] = q;
+        }
+    }
+}
+
+/* p finished its CPU burst this tick: on to I/O, keeping its cells, or done */
+static void burst_end(matrix_t *x, process_t *p) {
+    scheduler_t *s = x->m->cpus[p->gang_col];
+    if (p->bursts && p->burst_idx + 1 < p->nbursts) {
+        p->burst_idx++;
+        p->io_left = p->bursts[p->burst_idx];
+        p->state = PROC_WAITING;
+        p->io_enqueued_tick = (unsigned int)x->now;
+        char info[128];
+        snprintf(info, sizeof(info), "\"io\":%d, \"burst_index\":%d", p->io_left, p->burst_idx);
+        char *ev = utils_build_event(EVT_JOB_BLOCKED, s, p, info);
+        utils_emit_event_and_free(ev, EVT_JOB_BLOCKED, s);
+        return;
+    }
+
+    p->state = PROC_TERMINATED;
+    p->finish_time = (unsigned int)x->now;
+    char *ev = utils_build_event(EVT_JOB_FINISHED, s, p, NULL);
+    utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
+    for (int c = p->gang_col; c < p->gang_col + p->width; ++c) {
+        CELL(x, p->gang_row, c) = NULL;
+        if (x->occ[c] == p) x->occ[c] = NULL;
+    }
+    x->placed--;
+    if (x->m->dag && p->dag_idx >= 0) {
+        *x->released_tail = dag_finish(x->m->dag, p->dag_idx, x->now);
+        while (*x->released_tail) x->released_tail = &(*x->released_tail)->next;
+    }
+    scheduler_record_completed(s, p);
+    process_free(p);
+}
+
+/* The CPU is still switching to its thread or refilling the cache for it
+ * (set by scheduler_charge_dispatch): the tick is spent on that */
+static int stall(scheduler_t *s) {
+    if (s->switch_left > 0) {
+        s->switch_left--;
+        s->switch_ticks++;
+        return 1;
+    }
+    if (s->warmup_left > 0) {
+        s->warmup_left--;
+        s->warmup_ticks++;
+        return 1;
+    }
+    return 0;
+}
+
+/* q's thread in column c is dispatched: its CPU charges the switch and the
+ * cache refill as for a job of its own, the thread's ticks on that CPU
+ * standing for the job's. Threads are pinned, so they never migrate. */
+static void dispatch_thread(matrix_t *x, process_t *q, int c) {
+    scheduler_t *s = x->m->cpus[c];
+    thread_t *t = &THREAD(x, q->gang_row, c);
+    unsigned int run = q->run_ticks;
+    unsigned long mark = q->cache_mark;
+    int last = q->last_cpu;
+    q->run_ticks = t->ticks;
+    q->cache_mark = t->mark;
+    q->last_cpu = s->cpu_id;
+    s->running = q;
+    char *ev = utils_build_event(EVT_CONTEXT_SWITCH, s, q, NULL);
+    utils_emit_event_and_free(ev, EVT_CONTEXT_SWITCH, s);
+    s->running = NULL;
+    t->mark = q->cache_mark;
+    q->run_ticks = run;
+    q->cache_mark = mark;
+    q->last_cpu = last;
+}
+
+/* The threads of q that hold their CPU run for this tick. A thread does its
+ * CPU's speed in work units (under DVFS, its level's), or nothing while its
+ * CPU stalls, but ends the tick no more than a tick of work (100 units)
+ * ahead of q's slowest thread: one that is that far ahead spins. The burst
+ * advances with the slowest thread. */
+static void advance(matrix_t *x, process_t *q) {
+    thread_t *t = &THREAD(x, q->gang_row, q->gang_col);
+    unsigned long low = ULONG_MAX;
+    for (int k = 0; k < q->width; ++k) {
+        int c = q->gang_col + k;
+        scheduler_t *s = x->m->cpus[c];
+        /* step holds the CPU's speed for this tick until it is worked out */
+        if (x->occ[c] == q) {
+            x->step[c] = s->freq.cfg ? dvfs_charge(s, q) : s->speed;
+            x->stalled[c] = (unsigned char)stall(s);
+            if (x->stalled[c]) x->step[c] = 0;
+        }
+        unsigned long reach = t[k].work + (x->occ[c] == q ? x->step[c] : 0);
+        if (reach < low) low = reach;
+    }
+    for (int k = 0; k < q->width; ++k) {
+        int c = q->gang_col + k;
+        if (x->occ[c] != q) continue;
+        unsigned long reach = t[k].work + x->step[c];
+        if (reach > low + 100) reach = low + 100;
+        x->step[c] = reach > t[k].work ? reach - t[k].work : 0;
+        t[k].work += x->step[c];
+        t[k].ticks++;
+    }
+    int remaining = q->burst - (int)(low / 100);
+    if (remaining < 0) remaining = 0;
+    q->cpu_done += q->remaining - remaining;
+    q->remaining = remaining;
+    q->run_ticks++;
+}
+
+/* Run the chosen threads for this tick */
+static void run_jobs(matrix_t *x) {
+    for (int c = 0; c < x->ncpus; ++c) {
+        process_t *q = x->occ[c];
+        if (!q || q == x->prev[c]) continue;
+        dispatch_thread(x, q, c);
+    }
+
+    for (int r = 0; r < x->rows; ++r) {
+        for (int c = 0; c < x->ncpus; ++c) {
+            process_t *q = job_at(x, r, c);
+            if (!q || !runnable(q)) continue;
+            scheduler_t *s = x->m->cpus[c];
+            if (!q->gang_on) {
+                if (q->state == PROC_RUNNING) {
+                    q->state = PROC_READY;
+                    char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, q, "\"reason\":\"slice\"");
+                    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+                }
+                continue;
+            }
+            if (q->state != PROC_RUNNING) {
+                event_type_t type = q->start_time == UINT_MAX ? EVT_JOB_STARTED : EVT_JOB_RESUMED;
+                q->state = PROC_RUNNING;
+                if (q->start_time == UINT_MAX) q->start_time = (unsigned int)x->now;
+                char *ev = utils_build_event(type, s, q, NULL);
+                utils_emit_event_and_free(ev, type, s);
+            }
+
+            advance(x, q);
+            if (x->g->mode == COSCHED_FILL && r != x->cur) x->g->fill_ticks += (unsigned long)q->width;
+
+            for (int j = c; j < c + q->width; ++j) {
+                if (x->occ[j] != q) continue;
+                scheduler_t *t = x->m->cpus[j];
+                int spinning = !x->step[j] && !x->stalled[j];
+                if (spinning) t->sync_ticks++;
+                char info[128];
+                snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"thread\":%d%s",
+                         q->pid, q->remaining, j - c,
+                         spinning ? ", \"spinning\":true" : x->stalled[j] ? ", \"stalled\":true" : "");
+                char *ev = utils_build_event(EVT_GANTT_SLICE, t, q, info);
+                utils_emit_event_and_free(ev, EVT_GANTT_SLICE, t);
+            }
+            if (q->remaining <= 0) burst_end(x, q);
+        }
+    }
+}
+
+/* I/O bursts started before this tick are served during it */
+static void serve_io(matrix_t *x) {
+    for (int r = 0; r < x->rows; ++r) {
+        for (int c = 0; c < x->ncpus; ++c) {
+            process_t *q = job_at(x, r, c);
+            if (!q || q->state != PROC_WAITING || q->io_enqueued_tick == x->now) continue;
+            if (--q->io_left > 0) continue;
+            q->io_enqueued_tick = UINT_MAX;
+            q->burst_idx++;
+            q->burst = q->bursts[q->burst_idx];
+            q->remaining = q->burst;
+            q->state = PROC_READY;
+            for (int j = c; j < c + q->width; ++j) THREAD(x, r, j).work = 0;
+            char *ev = utils_build_event(EVT_IO_COMPLETED, x->m->cpus[c], q, NULL);
+            utils_emit_event_and_free(ev, EVT_IO_COMPLETED, x->m->cpus[c]);
+        }
+    }
+}
+
+/* Sort the idle CPUs of this tick into fragmented, held and idle */
+static void classify(matrix_t *x) {
+    int waiting = x->queue != NULL;
+    for (int r = 0; r < x->rows && !waiting; ++r) {
+        for (int c = 0; c < x->ncpus && !waiting; ++c) {
+            const process_t *q = job_at(x, r, c);
+            waiting = runnable(q) && q->gang_on < q->width;
+        }
+    }
+    for (int c = 0; c < x->ncpus; ++c) {
+        if (x->occ[c]) continue;
+        int r = x->g->mode == COSCHED_NONE ? x->col_row[c] : x->cur;
+        const process_t *q = x->rows ? CELL(x, r, c) : NULL;
+        if (q && q->state == PROC_WAITING) x->g->held_ticks++;
+        else if (waiting) x->g->frag_ticks++;
+        else x->g->idle_ticks++;
+    }
+}
+
+static void tick(matrix_t *x) {
+    x->now++;
+    for (int c = 0; c < x->ncpus; ++c) x->m->cpus[c]->current_tick = x->now;
+    if (x->rows) {
+        x->g->ticks++;
+        x->g->row_ticks += (unsigned long)x->rows;
+    }
+
+    choose(x);
+    for (int r = 0; r < x->rows; ++r) {
+        for (int c = 0; c < x->ncpus; ++c) {
+            if (job_at(x, r, c)) CELL(x, r, c)->gang_on = 0;
+        }
+    }
+    for (int c = 0; c < x->ncpus; ++c) {
+        if (x->occ[c]) x->occ[c]->gang_on++;
+    }
+    classify(x);
+    run_jobs(x);
+    serve_io(x);
+
+    /* slices end: the next row (or each CPU's next job) from the next tick.
+     * Ticks a CPU stalls do not count, or a switch cost as long as the
+     * slice would have the rows take turns without progress. */
+    if (x->g->mode == COSCHED_NONE) {
+        for (int c = 0; c < x->ncpus; ++c) {
+            if (!x->occ[c] || x->stalled[c] || --x->col_left[c] > 0) continue;
+            x->col_row[c] = x->rows ? next_row(x, x->col_row[c], c) : 0;
+            x->col_left[c] = x->g->slice;
+        }
+    } else if (x->rows) {
+        int ran = 0, stalled = 0;
+        for (int c = 0; c < x->ncpus; ++c) {
+            if (!x->occ[c] || x->occ[c]->gang_row != x->cur) continue;
+            if (x->stalled[c]) stalled++;
+            else ran++;
+        }
+        if ((ran || !stalled) && --x->left == 0) switch_row(x);
+    }
+    memcpy(x->prev, x->occ, (size_t)x->ncpus * sizeof(process_t *));
+    compact(x);
+}
+
+int gang_run(smp_t *m, process_t **pending, int count) {
+    matrix_t x;
+    memset(&x, 0, sizeof(x));
+    x.m = m;
+    x.g = m->gang;
+    m->nthreads = 1;   // the matrix moves in lockstep: one tick at a time on this thread
+    x.ncpus = m->ncpus;
+    x.queue_tail = &x.queue;
+    x.released_tail = &x.released;
+    x.left = x.g->slice;
+    x.occ = (process_t **)calloc((size_t)x.ncpus, sizeof(process_t *));
+    x.prev = (process_t **)calloc((size_t)x.ncpus, sizeof(process_t *));
+    x.col_row = (int *)calloc((size_t)x.ncpus, sizeof(int));
+    x.col_left = (unsigned long *)malloc((size_t)x.ncpus * sizeof(unsigned long));
+    x.step = (unsigned long *)calloc((size_t)x.ncpus, sizeof(unsigned long));
+    x.stalled = (unsigned char *)calloc((size_t)x.ncpus, 1);
+    int next = 0, injected = 0;
+    if (!x.occ || !x.prev || !x.col_row || !x.col_left || !x.step || !x.stalled) goto oom;
+    for (int c = 0; c < x.ncpus; ++c) x.col_left[c] = x.g->slice;
+
+    for (;;) {
+        /* the queue first, then this tick's releases and arrivals */
+        if (drain_queue(&x) < 0) goto oom;
+        while (x.released) {
+            process_t *p = x.released;
+            x.released = p->next;
+            p->next = NULL;
+            if (admit(&x, p) < 0) goto oom;
+            injected++;
+        }
+        x.released_tail = &x.released;
+        while (next < count && pending[next]->arrival <= x.now) {
+            process_t *p = pending[next++];
+            if (m->dag && p->dag_idx >= 0 && !dag_arrive(m->dag, p)) continue;   // held until its predecessors finish
+            if (admit(&x, p) < 0) {
+                process_free(p);
+                goto oom;
+            }
+            injected++;
+        }
+        for (int c = 0; c < x.ncpus; ++c) utils_flush_events(m->cpus[c]);
+
+        if (!x.placed && !x.queue) {
+            if (next >= count) break;
+            /* nothing to run until the next arrival */
+            unsigned long gap = pending[next]->arrival - 1 - x.now;
+            x.g->idle_ticks += gap * (unsigned long)x.ncpus;
+            x.now += gap;
+        }
+        tick(&x);
+        m->epochs++;
+    }
+    goto out;
+
+oom:
+    fprintf(stderr, "Error: out of memory growing the gang matrix\n");
+    for (int r = 0; r < x.rows; ++r) {
+        for (int c = 0; c < x.ncpus; ++c) {
+            if (job_at(&x, r, c)) process_free(CELL(&x, r, c));
+        }
+    }
+    while (x.queue) {
+        process_t *p = x.queue;
+        x.queue = p->next;
+        process_free(p);
+    }
+    while (x.released) {
+        process_t *p = x.released;
+        x.released = p->next;
+        process_free(p);
+    }
+    while (next < count) process_free(pending[next++]);
+out:
+    for (int c = 0; c < x.ncpus; ++c) utils_flush_events(m->cpus[c]);
+    free(x.cell);
+    free(x.thread);
+    free(x.occ);
+    free(x.step);
+    free(x.stalled);
+    free(x.prev);
+    free(x.col_row);
+    free(x.col_left);
+    return injected;
+}
@@ -0,0 +1,417 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/group.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+/* vruntime added per tick held, at weight 1 */
+#define GROUP_SCALE (1ULL << 32)
+
+void group_init(group_tree_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->policy.policy = MLQ_RR;
+    t->policy.quantum = 4;
+    t->slice = 3;
+}
+
+static int add(group_tree_t *t, const char *path, int parent) {
+    if (t->n == t->cap) {
+        int cap = t->cap ? t->cap * 2 : 8;
+        group_t *v = (group_t *)realloc(t->v, (size_t)cap * sizeof(group_t));
+        if (!v) return -1;
+        t->v = v;
+        t->cap = cap;
+    }
+    int i = t->n++;
+    group_t *g = &t->v[i];
+    memset(g, 0, sizeof(*g));
+    snprintf(g->path, sizeof(g->path), "%s", path);
+    g->parent = parent;
+    g->first_child = -1;
+    g->next_sibling = -1;
+    g->weight = GROUP_WEIGHT_DEFAULT;
+    g->period = GROUP_PERIOD_DEFAULT;
+    g->leaf.policy = t->policy.policy;
+    g->leaf.quantum = t->policy.quantum;
+    if (parent >= 0) {
+        /* children stay in creation order */
+        int *link = &t->v[parent].first_child;
+        while (*link >= 0) link = &t->v[*link].next_sibling;
+        *link = i;
+    }
+    return i;
+}
+
+int group_lookup(group_tree_t *t, const char *path, int create) {
+    if (!t->n && (!create || add(t, "", -1) < 0)) return -1;
+    char prefix[GROUP_PATH_MAX];
+    size_t plen = 0;
+    int g = 0;
+    const char *s = path;
+    while (*s) {
+        while (*s == '/') s++;
+        if (!*s) break;
+        const char *e = s;
+        while (*e && *e != '/') e++;
+        size_t len = (size_t)(e - s);
+        if (plen + (plen ? 1 : 0) + len >= sizeof(prefix)) return -1;
+        if (plen) prefix[plen++] = '/';
+        memcpy(prefix + plen, s, len);
+        plen += len;
+        prefix[plen] = '\0';
+
+        int c = t->v[g].first_child;
+        while (c >= 0 && strcmp(t->v[c].path, prefix) != 0) c = t->v[c].next_sibling;
+        if (c < 0) {
+            if (!create) return -1;
+            c = add(t, prefix, g);
+            if (c < 0) return -1;
+        }
+        g = c;
+        s = e;
+    }
+    return g;
+}
+
+int group_leaf(group_tree_t *t, int g) {
+    while (g >= 0 && t->v[g].first_child >= 0) {
+        char path[GROUP_PATH_MAX + 2];
+        snprintf(path, sizeof(path), "%s/.", t->v[g].path);
+        g = group_lookup(t, path, 1);
+    }
+    return g;
+}
+
+int group_parse_max(const char *s, unsigned long *quota, unsigned long *period) {
+    char *end;
+    while (*s == ' ') s++;
+    if (strncmp(s, "max", 3) == 0) {
+        *quota = 0;
+        end = (char *)s + 3;
+    } else {
+        long q = strtol(s, &end, 10);
+        if (end == s || q < 1) return -1;
+        *quota = (unsigned long)q;
+    }
+    *period = GROUP_PERIOD_DEFAULT;
+    s = end;
+    while (*s == ' ' || *s == '/') s++;
+    if (*s) {
+        long p = strtol(s, &end, 10);
+        if (end == s || p < 1) return -1;
+        *period = (unsigned long)p;
+        s = end;
+        while (*s == ' ') s++;
+        if (*s) return -1;
+    }
+    return 0;
+}
+
+void group_set_max(group_tree_t *t, int g, unsigned long quota, unsigned long period) {
+    t->v[g].quota = quota;
+    t->v[g].period = period ? period : GROUP_PERIOD_DEFAULT;
+    t->v[g].runtime = quota;
+    t->bandwidth = 0;
+    for (int i = 0; i < t->n; ++i) {
+        if (t->v[i].quota) t->bandwidth = 1;
+    }
+}
+
+int group_apply_max(group_tree_t *t, const char *spec) {
+    while (spec && *spec) {
+        const char *end = strchr(spec, ',');
+        if (!end) end = spec + strlen(spec);
+        char entry[GROUP_PATH_MAX + 48];
+        size_t len = (size_t)(end - spec);
+        if (len >= sizeof(entry)) return -1;
+        memcpy(entry, spec, len);
+        entry[len] = '\0';
+        char *eq = strrchr(entry, '=');
+        unsigned long quota, period;
+        if (!eq) return -1;
+        *eq = '\0';
+        if (group_parse_max(eq + 1, &quota, &period) < 0) return -1;
+        int g = group_lookup(t, entry, 0);
+        if (g < 0) fprintf(stderr, "Warning: --cpu-max: no group \"%s\" in the workload\n", entry);
+        else group_set_max(t, g, quota, period);
+        spec = *end ? end + 1 : end;
+    }
+    return 0;
+}
+
+int group_copy(group_tree_t *dst, const group_tree_t *src) {
+    free(dst->v);
+    *dst = *src;
+    dst->v = NULL;
+    dst->cap = dst->n;
+    if (src->n) {
+        dst->v = (group_t *)malloc((size_t)src->n * sizeof(group_t));
+        if (!dst->v) {
+            dst->n = dst->cap = 0;
+            return -1;
+        }
+        memcpy(dst->v, src->v, (size_t)src->n * sizeof(group_t));
+    }
+    for (int i = 0; i < dst->n; ++i) {
+        group_t *g = &dst->v[i];
+        g->vruntime = 0;
+        g->nr_runnable = 0;
+        g->leaf.head = NULL;
+        g->leaf.queued = 0;
+        g->leaf.policy = src->policy.policy;
+        g->leaf.quantum = src->policy.quantum;
+        g->runtime = g->quota;
+        g->period_idx = 0;
+        g->throttled = 0;
+    }
+    dst->queued = 0;
+    dst->slice_left = 0;
+    return 0;
+}
+
+/* ---- runnable set ---- */
+
+/* g's subtree became runnable: start it no lower than its runnable siblings */
+static void place(group_tree_t *t, int g) {
+    int parent = t->v[g].parent;
+    if (parent < 0) return;
+    int found = 0;
+    unsigned long long min = 0;
+    for (int c = t->v[parent].first_child; c >= 0; c = t->v[c].next_sibling) {
+        if (c == g || !t->v[c].nr_runnable) continue;
+        if (!found || t->v[c].vruntime < min) min = t->v[c].vruntime;
+        found = 1;
+    }
+    if (found && t->v[g].vruntime < min) t->v[g].vruntime = min;
+}
+
+static void join(scheduler_t *s, process_t *p) {
+    group_tree_t *t = &s->groups;
+    if (p->group < 0 || p->group >= t->n) {
+        /* released at run time without a group (periodic jobs): the root's */
+        p->group = group_leaf(t, group_lookup(t, "", 1));
+        if (p->group < 0) p->group = 0;
+    }
+    for (int g = p->group; g >= 0; g = t->v[g].parent) {
+        if (t->v[g].nr_runnable++ == 0) place(t, g);
+    }
+    mlq_enqueue(&t->v[p->group].leaf, p, 0);
+    t->queued++;
+}
+
+void hfs_leave(scheduler_t *s, process_t *p) {
+    group_tree_t *t = &s->groups;
+    if (p->group < 0 || p->group >= t->n) return;
+    for (int g = p->group; g >= 0; g = t->v[g].parent) t->v[g].nr_runnable--;
+}
+
+/* ---- bandwidth control ---- */
+
+/* Start the period holding tick now: quotas are refilled and throttled
+ * groups released */
+static void refresh(group_tree_t *t, unsigned long now) {
+    if (!t->bandwidth) return;
+    for (int i = 0; i < t->n; ++i) {
+        group_t *g = &t->v[i];
+        if (!g->quota || now / g->period == g->period_idx) continue;
+        if (g->throttled) {
+            g->throttled_ticks += (g->period_idx + 1) * g->period - g->throttled_since;
+            g->throttled = 0;
+        }
+        g->runtime = g->quota;
+        g->period_idx = now / g->period;
+    }
+}
+
+/* g may take the CPU at tick now; a group out of quota is throttled */
+static int eligible(group_tree_t *t, int g, unsigned long now) {
+    group_t *x = &t->v[g];
+    if (!x->quota || x->runtime) return 1;
+    if (!x->throttled) {
+        x->throttled = 1;
+        x->throttled_since = now;
+        x->nr_throttled++;
+    }
+    return 0;
+}
+
+static int path_eligible(group_tree_t *t, int g, unsigned long now) {
+    int ok = 1;
+    for (; g >= 0; g = t->v[g].parent) {
+        if (!eligible(t, g, now)) ok = 0;
+    }
+    return ok;
+}
+
+/* The leaf the CPU goes to at tick now: the runnable, unthrottled child
+ * with the smallest vruntime at every level, -1 if there is none */
+static int pick(group_tree_t *t, unsigned long now) {
+    if (!t->n || !t->v[0].nr_runnable || !eligible(t, 0, now)) return -1;
+    int g = 0;
+    while (t->v[g].first_child >= 0) {
+        int best = -1;
+        for (int c = t->v[g].first_child; c >= 0; c = t->v[c].next_sibling) {
+            if (!t->v[c].nr_runnable || !eligible(t, c, now)) continue;
+            if (best < 0 || t->v[c].vruntime < t->v[best].vruntime) best = c;
+        }
+        if (best < 0) return -1;
+        g = best;
+    }
+    return g;
+}
+
+/* One tick of entitlement: every runnable group is owed its weight's part
+ * of its parent's share, split among the parent's runnable children */
+static void accrue(group_tree_t *t) {
+    if (!t->n || !t->v[0].nr_runnable) return;
+    /* parents come before children, so one pass in index order does */
+    t->v[0].runnable_ticks++;
+    t->v[0].due += 1.0;
+    t->v[0].share = 1.0;
+    for (int i = 0; i < t->n; ++i) {
+        const group_t *g = &t->v[i];
+        if (!g->nr_runnable || g->first_child < 0) continue;
+        unsigned long total = 0;
+        for (int c = g->first_child; c >= 0; c = t->v[c].next_sibling)
+            if (t->v[c].nr_runnable) total += t->v[c].weight;
+        for (int c = g->first_child; c >= 0; c = t->v[c].next_sibling) {
+            if (!t->v[c].nr_runnable) continue;
+            t->v[c].share = g->share * (double)t->v[c].weight / (double)total;
+            t->v[c].due += t->v[c].share;
+            t->v[c].runnable_ticks++;
+        }
+    }
+}
+
+/* ---- dispatch ---- */
+
+static process_t *take(scheduler_t *s, group_t *g) {
+    process_t *p = mlq_take(s, &g->leaf);
+    if (p) s->groups.queued--;
+    return p;
+}
+
+static void dispatch(scheduler_t *s, process_t *p) {
+    const mlq_class_t *leaf = &s->groups.v[p->group].leaf;
+    p->quantum_left = leaf->policy == MLQ_RR ? leaf->quantum : 0;
+    scheduler_dispatch(s, p);
+}
+
+/* Put s->running back in its leaf queue, at the head if it only gave way
+ * to another group */
+static void preempt(scheduler_t *s, const char *reason, int to_head) {
+    process_t *cur = s->running;
+    group_t *g = &s->groups.v[cur->group];
+    char info[160];
+    snprintf(info, sizeof(info), "\"reason\":\"%s\", \"group\":\"%s\"", reason, g->path);
+    char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, cur, info);
+    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+
+    s->running = NULL;
+    cur->state = PROC_READY;
+    cur->last_enqueued_tick = (unsigned int)s->current_tick;
+    mlq_enqueue(&g->leaf, cur, to_head);
+    s->groups.queued++;
+}
+
+void hfs_tick(scheduler_t *s) {
+    if (!s) return;
+    group_tree_t *t = &s->groups;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        s->ready_head = p->next;
+        p->next = NULL;
+        join(s, p);
+    }
+
+    unsigned long now = s->current_tick;
+    refresh(t, now);
+
+    /* a group on the running job's path ran out of quota last tick */
+    if (s->running && t->bandwidth && !path_eligible(t, s->running->group, now))
+        preempt(s, "throttled", 1);
+
+    /* at the end of a group slice, walk the tree again */
+    if (s->running && !t->slice_left) {
+        int g = pick(t, now);
+        if (g != s->running->group) preempt(s, "group", 1);
+        else t->slice_left = t->slice;
+    }
+
+    if (s->running) {
+        /* the preemptive leaf policies */
+        group_t *g = &t->v[s->running->group];
+        process_t *top = mlq_peek(&g->leaf);
+        if (top && mlq_preempts(&g->leaf, top, s->running)) {
+            preempt(s, g->leaf.policy == MLQ_SRTF ? "srtf" : "priority", 0);
+            dispatch(s, take(s, g));
+        }
+    }
+    if (!s->running) {
+        int g = pick(t, now);
+        if (g >= 0) {
+            dispatch(s, take(s, &t->v[g]));
+            t->slice_left = t->slice;
+        } else if (t->queued) {
+            t->throttled_idle++;
+        }
+    }
+
+    accrue(t);
+
+    if (s->running) {
+        process_t *cur = s->running;
+        int ran = scheduler_consume(s, cur);
+        for (int g = cur->group; g >= 0; g = t->v[g].parent) {
+            group_t *x = &t->v[g];
+            x->vruntime += GROUP_SCALE / x->weight;
+            x->cpu_ticks++;
+            if (x->quota && x->runtime) {
+                if (x->runtime == x->quota) x->nr_periods++;
+                x->runtime--;
+            }
+        }
+        /* the groups are charged for a stall, but it leaves the slice alone */
+        if (ran && t->slice_left) t->slice_left--;
+
+        char info[160];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"group\":\"%s\"",
+                 cur->pid, cur->remaining, t->v[cur->group].path);
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) {
+            hfs_leave(s, cur);
+            scheduler_finish_burst(s);
+        } else if (t->v[cur->group].leaf.policy == MLQ_RR && cur->quantum_left <= 0) {
+            /* the slice timer zeroes quantum_left; stall ticks do not use up the slice */
+            preempt(s, "quantum", 0);
+            /* the next job runs from the next tick on */
+            refresh(t, now + 1);
+            int g = t->slice_left && path_eligible(t, cur->group, now + 1) ? cur->group : pick(t, now + 1);
+            if (g >= 0) {
+                dispatch(s, take(s, &t->v[g]));
+                if (g != cur->group || !t->slice_left) t->slice_left = t->slice;
+            }
+        }
+    }
+}
+
+void group_clear(scheduler_t *s) {
+    if (!s) return;
+    group_tree_t *t = &s->groups;
+    for (int i = 0; i < t->n; ++i) {
+        process_t *cur = t->v[i].leaf.head;
+        while (cur) {
+            process_t *n = cur->next;
+            process_free(cur);
+            cur = n;
+        }
+    }
+    free(t->v);
+    t->v = NULL;
+    t->n = t->cap = 0;
+    t->queued = 0;
+}
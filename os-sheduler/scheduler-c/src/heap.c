@@ -0,0 +1,79 @@
+#include <stdlib.h>
+#include "../include/heap.h"
+
+void heap_init(heap_t *h, heap_less_fn less) {
+    h->v = NULL;
+    h->len = 0;
+    h->cap = 0;
+    h->less = less;
+}
+
+static void set(heap_t *h, size_t i, process_t *p) {
+    h->v[i] = p;
+    p->heap_idx = i;
+}
+
+static void sift_up(heap_t *h, size_t i) {
+    process_t *p = h->v[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!h->less(p, h->v[parent])) break;
+        set(h, i, h->v[parent]);
+        i = parent;
+    }
+    set(h, i, p);
+}
+
+static void sift_down(heap_t *h, size_t i) {
+    process_t *p = h->v[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= h->len) break;
+        if (child + 1 < h->len && h->less(h->v[child + 1], h->v[child])) child++;
+        if (!h->less(h->v[child], p)) break;
+        set(h, i, h->v[child]);
+        i = child;
+    }
+    set(h, i, p);
+}
+
+int heap_push(heap_t *h, process_t *p) {
+    if (h->len == h->cap) {
+        size_t cap = h->cap ? h->cap * 2 : 16;
+        process_t **v = (process_t **)realloc(h->v, cap * sizeof(process_t *));
+        if (!v) return -1;
+        h->v = v;
+        h->cap = cap;
+    }
+    set(h, h->len++, p);
+    sift_up(h, h->len - 1);
+    return 0;
+}
+
+process_t *heap_pop(heap_t *h) {
+    if (!h->len) return NULL;
+    process_t *top = h->v[0];
+    heap_remove(h, top);
+    return top;
+}
+
+void heap_remove(heap_t *h, process_t *p) {
+    size_t i = p->heap_idx;
+    process_t *last = h->v[--h->len];
+    if (i < h->len) {
+        set(h, i, last);
+        heap_fix(h, last);
+    }
+}
+
+void heap_fix(heap_t *h, process_t *p) {
+    size_t i = p->heap_idx;
+    if (i > 0 && h->less(p, h->v[(i - 1) / 2])) sift_up(h, i);
+    else sift_down(h, i);
+}
+
+void heap_free(heap_t *h) {
+    free(h->v);
+    h->v = NULL;
+    h->len = h->cap = 0;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include "../include/hrrn.h"
+#include "../include/utils.h"
+
+void hrrn_tick(scheduler_t *s) {
+    if (!s) return;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        if (kinetic_push(&s->hrrn, p, p->last_enqueued_tick, (unsigned long)p->burst, s->current_tick) < 0)
+            break;   // out of memory: retry next tick
+        s->ready_head = p->next;
+        p->next = NULL;
+    }
+
+    if (!s->running && s->hrrn.len) scheduler_dispatch(s, scheduler_take(s, kinetic_pop(&s->hrrn, s->current_tick)));
+
+    if (s->running) {
+        process_t *cur = s->running;
+        scheduler_consume(s, cur);
+
+        char info[128];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d", cur->pid, cur->remaining);
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) scheduler_finish_burst(s);
+    }
+}
+
+void hrrn_clear(scheduler_t *s) {
+    if (!s) return;
+    while (s->hrrn.len) process_free(kinetic_take_last(&s->hrrn));
+    kinetic_free(&s->hrrn);
+}
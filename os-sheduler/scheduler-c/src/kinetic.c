@@ -0,0 +1,163 @@
+#include <stdlib.h>
+#include <limits.h>
+#include "../include/kinetic.h"
+
+#define NONE ((size_t)-1)
+
+/* Certificates further out than this are cut short and re-checked then, so
+ * that (t - since) * burst stays well inside 64 bits */
+#define FAR (1UL << 32)
+
+void kinetic_init(kinetic_t *k) {
+    k->v = NULL;
+    k->since = NULL;
+    k->burst = NULL;
+    k->win = NULL;
+    k->expire = NULL;
+    k->min_expire = NULL;
+    k->len = 0;
+    k->cap = 0;
+    k->now = 0;
+}
+
+/* Slot a is ahead of slot b at tick t: (t - e_a) / b_a > (t - e_b) / b_b */
+static int leads(const kinetic_t *k, size_t a, size_t b, unsigned long t) {
+    unsigned long long ra = (unsigned long long)(t - k->since[a]) * k->burst[b];
+    unsigned long long rb = (unsigned long long)(t - k->since[b]) * k->burst[a];
+    if (ra != rb) return ra > rb;
+    if (k->since[a] != k->since[b]) return k->since[a] < k->since[b];
+    const process_t *pa = k->v[a], *pb = k->v[b];
+    if (pa->arrival != pb->arrival) return pa->arrival < pb->arrival;
+    return pa->pid < pb->pid;
+}
+
+/* First tick after k->now at which l leads w, which leads now. Only a
+ * shorter burst ever catches up; the lines meet at
+ * t = (e_l b_w - e_w b_l) / (b_w - b_l), which long double holds exactly
+ * up to the final division, and the exact test settles the rounding. */
+static unsigned long overtake(const kinetic_t *k, size_t w, size_t l) {
+    if (k->burst[l] >= k->burst[w]) return ULONG_MAX;
+    unsigned long now = k->now;
+    long double meet = ((long double)k->since[l] * k->burst[w] - (long double)k->since[w] * k->burst[l]) /
+                       (long double)(k->burst[w] - k->burst[l]);
+    if (meet >= (long double)now + FAR) return now + FAR;
+    unsigned long t = now + 1;
+    if (meet > (long double)t) t = (unsigned long)meet;
+    while (t > now + 1 && leads(k, l, w, t - 1)) t--;
+    while (!leads(k, l, w, t)) t++;
+    return t;
+}
+
+/* Recompute internal node x from its children, which are valid at k->now */
+static void pull(kinetic_t *k, size_t x) {
+    size_t a = k->win[2 * x], b = k->win[2 * x + 1];
+    unsigned long exp = ULONG_MAX;
+    if (a == NONE) k->win[x] = b;
+    else if (b == NONE) k->win[x] = a;
+    else {
+        size_t w = leads(k, a, b, k->now) ? a : b;
+        k->win[x] = w;
+        exp = overtake(k, w, w == a ? b : a);
+    }
+    k->expire[x] = exp;
+    unsigned long m = exp;
+    if (k->min_expire[2 * x] < m) m = k->min_expire[2 * x];
+    if (k->min_expire[2 * x + 1] < m) m = k->min_expire[2 * x + 1];
+    k->min_expire[x] = m;
+}
+
+static void set_leaf(kinetic_t *k, size_t slot, size_t win) {
+    size_t x = k->cap + slot;
+    k->win[x] = win;
+    k->expire[x] = ULONG_MAX;
+    k->min_expire[x] = ULONG_MAX;
+    for (x /= 2; x; x /= 2) pull(k, x);
+}
+
+/* Replay the expired certificates below x, children first */
+static void replay(kinetic_t *k, size_t x) {
+    if (x >= k->cap) return;
+    if (k->min_expire[2 * x] <= k->now) replay(k, 2 * x);
+    if (k->min_expire[2 * x + 1] <= k->now) replay(k, 2 * x + 1);
+    pull(k, x);
+}
+
+static void advance(kinetic_t *k, unsigned long now) {
+    if (now > k->now) k->now = now;
+    if (k->cap && k->min_expire[1] <= k->now) replay(k, 1);
+}
+
+/* Double the capacity and rebuild every node at k->now in O(n) */
+static int grow(kinetic_t *k) {
+    size_t cap = k->cap ? k->cap * 2 : 16;
+    process_t **v = (process_t **)realloc(k->v, cap * sizeof(process_t *));
+    if (!v) return -1;
+    k->v = v;
+    unsigned long *since = (unsigned long *)realloc(k->since, cap * sizeof(unsigned long));
+    if (!since) return -1;
+    k->since = since;
+    unsigned long *burst = (unsigned long *)realloc(k->burst, cap * sizeof(unsigned long));
+    if (!burst) return -1;
+    k->burst = burst;
+    size_t *win = (size_t *)realloc(k->win, 2 * cap * sizeof(size_t));
+    if (!win) return -1;
+    k->win = win;
+    unsigned long *expire = (unsigned long *)realloc(k->expire, 2 * cap * sizeof(unsigned long));
+    if (!expire) return -1;
+    k->expire = expire;
+    unsigned long *min_expire = (unsigned long *)realloc(k->min_expire, 2 * cap * sizeof(unsigned long));
+    if (!min_expire) return -1;
+    k->min_expire = min_expire;
+    k->cap = cap;
+
+    for (size_t i = 0; i < cap; ++i) {
+        k->win[cap + i] = i < k->len ? i : NONE;
+        k->expire[cap + i] = k->min_expire[cap + i] = ULONG_MAX;
+    }
+    for (size_t x = cap - 1; x; --x) pull(k, x);
+    return 0;
+}
+
+int kinetic_push(kinetic_t *k, process_t *p, unsigned long since, unsigned long burst, unsigned long now) {
+    advance(k, now);
+    if (k->len == k->cap && grow(k) < 0) return -1;
+    size_t i = k->len++;
+    k->v[i] = p;
+    k->since[i] = since;
+    k->burst[i] = burst ? burst : 1;
+    set_leaf(k, i, i);
+    return 0;
+}
+
+static process_t *take(kinetic_t *k, size_t i) {
+    process_t *p = k->v[i];
+    size_t last = --k->len;
+    set_leaf(k, last, NONE);
+    if (i != last) {
+        k->v[i] = k->v[last];
+        k->since[i] = k->since[last];
+        k->burst[i] = k->burst[last];
+        set_leaf(k, i, i);
+    }
+    return p;
+}
+
+process_t *kinetic_pop(kinetic_t *k, unsigned long now) {
+    if (!k->len) return NULL;
+    advance(k, now);
+    return take(k, k->win[1]);
+}
+
+process_t *kinetic_take_last(kinetic_t *k) {
+    return k->len ? take(k, k->len - 1) : NULL;
+}
+
+void kinetic_free(kinetic_t *k) {
+    free(k->v);
+    free(k->since);
+    free(k->burst);
+    free(k->win);
+    free(k->expire);
+    free(k->min_expire);
+    kinetic_init(k);
+}
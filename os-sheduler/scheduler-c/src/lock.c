@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "../include/lock.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+void lock_init(lock_table_t *t) {
+    memset(t, 0, sizeof(*t));
+    t->protocol = LOCK_NONE;
+}
+
+static int lookup(lock_table_t *t, const char *name, size_t len) {
+    for (int i = 0; i < t->n; ++i) {
+        if (strlen(t->v[i].name) == len && strncmp(t->v[i].name, name, len) == 0) return i;
+    }
+    if (t->n == t->cap) {
+        int cap = t->cap ? t->cap * 2 : 8;
+        resource_t *v = (resource_t *)realloc(t->v, (size_t)cap * sizeof(resource_t));
+        if (!v) return -1;
+        t->v = v;
+        t->cap = cap;
+    }
+    resource_t *r = &t->v[t->n];
+    memset(r, 0, sizeof(*r));
+    memcpy(r->name, name, len);
+    r->name[len] = '\0';
+    r->ceiling = INT_MAX;
+    return t->n++;
+}
+
+int lock_parse_sections(lock_table_t *t, const char *spec, int priority, crit_section_t *out, int max) {
+    int n = 0;
+    const char *p = spec;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+        const char *name = p;
+        while (*p && (isalnum((unsigned char)*p) || *p == '_' || *p == '-' || *p == '.')) p++;
+        size_t len = (size_t)(p - name);
+        if (!len || len >= LOCK_NAME_MAX || *p != '@' || n == max) return -1;
+        char *end;
+        long at = strtol(p + 1, &end, 10);
+        if (end == p + 1 || *end != '+' || at < 0) return -1;
+        p = end + 1;
+        long hold = strtol(p, &end, 10);
+        if (end == p || hold < 1) return -1;
+        p = end;
+        while (*p == ' ') p++;
+        if (*p && *p != ',') return -1;
+
+        int r = lookup(t, name, len);
+        if (r < 0) return -1;
+        if (priority < t->v[r].ceiling) t->v[r].ceiling = priority;
+        out[n].resource = r;
+        out[n].at = (int)at;
+        out[n].hold = (int)hold;
+        n++;
+    }
+    return n;
+}
+
+const char *lock_protocol_name(lock_protocol_t p) {
+    switch (p) {
+        case LOCK_INHERIT: return "inherit";
+        case LOCK_CEILING: return "ceiling";
+        default: return "none";
+    }
+}
+
+int lock_parse_protocol(const char *name) {
+    if (strcmp(name, "none") == 0) return LOCK_NONE;
+    if (strcmp(name, "inherit") == 0) return LOCK_INHERIT;
+    if (strcmp(name, "ceiling") == 0) return LOCK_CEILING;
+    return -1;
+}
+
+/* Only the priority policies hand resources over by priority and apply a protocol */
+static int by_priority(const scheduler_t *s) {
+    return s->algo == ALG_PRIORITY || s->algo == ALG_PRIORITY_P;
+}
+
+/* Priority p runs at while it holds r: its own, lowered to the ceiling
+ * or to its best waiter's */
+static void boost(scheduler_t *s, process_t *p, const resource_t *r) {
+    int prio = p->base_priority;
+    if (s->locks.protocol == LOCK_CEILING && r->ceiling < prio) prio = r->ceiling;
+    if (s->locks.protocol == LOCK_INHERIT) {
+        for (const process_t *w = r->waiters; w; w = w->next) {
+            if (w->priority < prio) prio = w->priority;
+        }
+    }
+    p->priority = prio;
+}
+
+/* p holds r from tick 'from' on */
+static void acquire(scheduler_t *s, process_t *p, resource_t *r, unsigned long from) {
+    r->owner = p;
+    r->acquired_at = from;
+    r->acquisitions++;
+    p->cs_held = p->cs_next++;
+    if (by_priority(s)) boost(s, p, r);
+}
+
+/* The section p has reached, if it is not in one: -1 if none */
+static int reached(const process_t *p) {
+    if (p->cs_held >= 0 || p->cs_next >= p->ncs || p->cpu_done < p->cs[p->cs_next].at) return -1;
+    return p->cs[p->cs_next].resource;
+}
+
+/* Hand r over to its next waiter, which becomes ready */
+static void hand_over(scheduler_t *s, resource_t *r) {
+    process_t **link = &r->waiters, **best = link;
+    if (by_priority(s)) {
+        for (; *link; link = &(*link)->next) {
+            if ((*link)->priority < (*best)->priority) best = link;
+        }
+    }
+    process_t *w = *best;
+    *best = w->next;
+    w->next = NULL;
+    s->locks.blocked--;
+
+    unsigned long waited = s->current_tick - w->lock_since;
+    w->lock_blocked += (unsigned int)waited;
+    r->blocked_ticks += waited;
+    if (waited > r->blocked_max) r->blocked_max = waited;
+    acquire(s, w, r, s->current_tick + 1);
+
+    char info[96];
+    snprintf(info, sizeof(info), "\"resource\":\"%s\", \"waited\":%lu", r->name, waited);
+    char *ev = utils_build_event(EVT_LOCK_ACQUIRED, s, w, info);
+    utils_emit_event_and_free(ev, EVT_LOCK_ACQUIRED, s);
+    scheduler_add_process(s, w);
+}
+
+static void release(scheduler_t *s, process_t *p) {
+    resource_t *r = &s->locks.v[p->cs[p->cs_held].resource];
+    r->owner = NULL;
+    r->hold_ticks += s->current_tick - r->acquired_at + 1;
+    p->cs_held = -1;
+    p->priority = p->base_priority;
+    if (r->waiters) hand_over(s, r);
+}
+
+int lock_enter(scheduler_t *s, process_t *p) {
+    int r = reached(p);
+    if (r < 0) return 1;
+    if (s->locks.v[r].owner) return 0;
+    acquire(s, p, &s->locks.v[r], s->current_tick);
+    return 1;
+}
+
+void lock_progress(scheduler_t *s, process_t *p) {
+    if (p->cs_held >= 0 && p->cpu_done >= p->cs[p->cs_held].at + p->cs[p->cs_held].hold) release(s, p);
+}
+
+void lock_charge(scheduler_t *s, const process_t *p) {
+    lock_table_t *t = &s->locks;
+    for (int i = 0; i < t->n; ++i) {
+        resource_t *r = &t->v[i];
+        if (r->owner == p) continue;
+        for (process_t *w = r->waiters; w; w = w->next) {
+            if (p->base_priority > w->base_priority) {
+                w->lock_inversion++;
+                r->inversion_ticks++;
+            }
+        }
+    }
+}
+
+void lock_tick(scheduler_t *s) {
+    process_t *p = s->running;
+    if (!p || !p->ncs) return;
+    int i = reached(p);
+    if (i < 0) return;
+    resource_t *r = &s->locks.v[i];
+    if (!r->owner) {
+        acquire(s, p, r, s->current_tick + 1);
+        return;
+    }
+
+    scheduler_leave(s, p);
+    s->running = NULL;
+    p->state = PROC_WAITING;
+    char info[96];
+    snprintf(info, sizeof(info), "\"resource\":\"%s\", \"owner\":%d", r->name, r->owner->pid);
+    char *ev = utils_build_event(EVT_JOB_BLOCKED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_BLOCKED, s);
+    p->lock_since = s->current_tick;
+    p->next = NULL;
+    process_t **link = &r->waiters;
+    while (*link) link = &(*link)->next;
+    *link = p;
+    r->contended++;
+    s->locks.blocked++;
+    if (by_priority(s) && s->locks.protocol == LOCK_INHERIT && p->priority < r->owner->priority)
+        r->owner->priority = p->priority;
+}
+
+void lock_burst_end(scheduler_t *s, process_t *p) {
+    if (p->cs_held >= 0) release(s, p);
+}
+
+void lock_clear(scheduler_t *s) {
+    if (!s) return;
+    for (int i = 0; i < s->locks.n; ++i) {
+        process_t *w = s->locks.v[i].waiters;
+        while (w) {
+            process_t *n = w->next;
+            process_free(w);
+            w = n;
+        }
+    }
+    free(s->locks.v);
+    lock_init(&s->locks);
+}
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include "../include/lottery.h"
+#include "../include/cfs.h"
+#include "../include/utils.h"
+
+unsigned long lottery_tickets(int priority) {
+    return cfs_weight(priority);
+}
+
+static unsigned long long stride_of(const process_t *p) {
+    return STRIDE1 / lottery_tickets(p->priority);
+}
+
+static int pass_less(const process_t *a, const process_t *b) {
+    if (a->pass != b->pass) return a->pass < b->pass;
+    if (a->arrival != b->arrival) return a->arrival < b->arrival;
+    return a->pid < b->pid;
+}
+
+/* splitmix64 */
+static unsigned long long next_random(scheduler_t *s) {
+    unsigned long long z = (s->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int slice(const scheduler_t *s) {
+    return s->quantum > 0 ? (int)s->quantum : 1;
+}
+
+/* share_clock advances by 1 / share_tickets per busy tick; the ticks are
+ * counted in share_run and folded in only when share_tickets changes or the
+ * clock is read, so long runs do not accumulate rounding per tick */
+static void sync_clock(scheduler_t *s) {
+    if (s->share_run && s->share_tickets)
+        s->share_clock += (double)s->share_run / (double)s->share_tickets;
+    s->share_run = 0;
+}
+
+static void join(scheduler_t *s, process_t *p) {
+    sync_clock(s);
+    p->share_mark = s->share_clock;
+    p->share_since = s->current_tick;
+    s->share_tickets += lottery_tickets(p->priority);
+}
+
+void lottery_leave(scheduler_t *s, process_t *p) {
+    if (!s || !p) return;
+    sync_clock(s);
+    unsigned long w = lottery_tickets(p->priority);
+    p->share_due += (double)w * (s->share_clock - p->share_mark);
+    p->share_ticks += s->current_tick - p->share_since + 1;
+    s->share_tickets -= w;
+}
+
+static process_t *draw(scheduler_t *s) {
+    /* total is far below 2^64, so the modulo bias is negligible */
+    unsigned long r = (unsigned long)(next_random(s) % s->lottery.total);
+    return scheduler_take(s, fenwick_take(&s->lottery, fenwick_find(&s->lottery, r)));
+}
+
+static process_t *take_min_pass(scheduler_t *s) {
+    return scheduler_take(s, heap_pop(&s->heap));
+}
+
+static void dispatch(scheduler_t *s, process_t *p) {
+    p->quantum_left = slice(s);
+    scheduler_dispatch(s, p);
+}
+
+/* cur's quantum is over and next was chosen over it (cur is queued again) */
+static void switch_to(scheduler_t *s, process_t *cur, process_t *next) {
+    if (next == cur) {
+        /* chosen again: a new quantum without a switch */
+        scheduler_take(s, cur);
+        s->running = cur;
+        cur->state = PROC_RUNNING;
+        cur->quantum_left = slice(s);
+        s->slice_pending = 1;
+        return;
+    }
+    char info[128];
+    snprintf(info, sizeof(info), "\"reason\":\"quantum\", \"preempted_by\":%d", next->pid);
+    char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, cur, info);
+    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+    dispatch(s, next);
+}
+
+static void requeue(scheduler_t *s, process_t *cur) {
+    s->running = NULL;
+    cur->state = PROC_READY;
+    cur->last_enqueued_tick = (unsigned int)s->current_tick;
+}
+
+/* Charge this tick to s->running and finish its burst if it is done */
+static void run(scheduler_t *s) {
+    process_t *cur = s->running;
+    s->share_run++;
+    scheduler_consume(s, cur);
+    if (s->algo == ALG_STRIDE) cur->pass += stride_of(cur);
+
+    char info[160];
+    if (s->algo == ALG_STRIDE)
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"tickets\":%lu, \"pass\":%llu",
+                 cur->pid, cur->remaining, lottery_tickets(cur->priority), cur->pass);
+    else
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"tickets\":%lu",
+                 cur->pid, cur->remaining, lottery_tickets(cur->priority));
+    char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+    utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+    if (cur->remaining <= 0) {
+        lottery_leave(s, cur);
+        scheduler_finish_burst(s);
+    }
+}
+
+void lottery_tick(scheduler_t *s) {
+    if (!s) return;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        if (fenwick_push(&s->lottery, p, lottery_tickets(p->priority)) < 0) break;   // out of memory: retry next tick
+        s->ready_head = p->next;
+        p->next = NULL;
+        join(s, p);
+    }
+
+    if (!s->running && s->lottery.len) dispatch(s, draw(s));
+    if (s->running) run(s);
+
+    /* end of the quantum: draw again, cur included */
+    if (s->running && s->running->quantum_left <= 0) {
+        process_t *cur = s->running;
+        requeue(s, cur);
+        if (fenwick_push(&s->lottery, cur, lottery_tickets(cur->priority)) < 0) switch_to(s, cur, cur);
+        else switch_to(s, cur, draw(s));
+    }
+}
+
+static void update_global_pass(scheduler_t *s) {
+    process_t *top = heap_peek(&s->heap);
+    unsigned long long pass;
+    if (s->running) pass = top && top->pass < s->running->pass ? top->pass : s->running->pass;
+    else if (top) pass = top->pass;
+    else return;
+    if (pass > s->global_pass) s->global_pass = pass;
+}
+
+void stride_tick(scheduler_t *s) {
+    if (!s) return;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        if (p->pass < s->global_pass) p->pass = s->global_pass;
+        if (heap_push(&s->heap, p) < 0) break;   // out of memory: retry next tick
+        s->ready_head = p->next;
+        p->next = NULL;
+        join(s, p);
+    }
+
+    if (!s->running && s->heap.len) dispatch(s, take_min_pass(s));
+    if (s->running) run(s);
+
+    /* end of the quantum: the smallest pass runs next, cur included */
+    if (s->running && s->running->quantum_left <= 0) {
+        process_t *cur = s->running;
+        requeue(s, cur);
+        if (heap_push(&s->heap, cur) < 0) switch_to(s, cur, cur);
+        else switch_to(s, cur, take_min_pass(s));
+    }
+    update_global_pass(s);
+}
+
+void stride_init(scheduler_t *s) {
+    heap_init(&s->heap, pass_less);
+}
+
+void lottery_clear(scheduler_t *s) {
+    if (!s) return;
+    while (s->lottery.len) process_free(fenwick_take(&s->lottery, s->lottery.len - 1));
+    fenwick_free(&s->lottery);
+    while (s->heap.len) process_free(heap_pop(&s->heap));
+    heap_free(&s->heap);
+}
@@ -7,8 +7,225 @@
 #include "../include/scheduler.h"
 #include "../include/process.h"
 #include "../include/utils.h"
+#include "../include/smp.h"
+#include "../include/disk.h"
+#include "../include/predict.h"
+#include "../include/gang.h"
+#include "../include/cluster.h"
 
-#define MAX_PROCESSES 1000
+/* Command-line options given as --key=value (positional args keep their old meaning) */
+typedef struct {
+    int cpus;                // simulated CPUs; > 1 selects the multi-CPU model
+    int threads;             // host threads for the multi-CPU model
+    placement_t placement;
+    const char *speeds;      // per-CPU speed spec, see smp_set_speeds()
+    unsigned long migrate_up;
+    unsigned long window;    // multi-CPU placement window (ticks)
+    unsigned long switch_cost;   // dispatch overhead in ticks
+    unsigned long cache_warmup;  // cache-affinity model, see scheduler_t
+    unsigned long cache_size;
+    unsigned long migration_cost;
+    disk_sched_t disk;           // I/O request scheduling, see disk.h
+    unsigned long seek_rate;
+    unsigned long io_deadline;
+    predict_mode_t predict;      // what SJF/SRTF know of bursts, see predict.h
+    double alpha;
+    double tau0;
+    unsigned long sched_latency; // CFS knobs, see cfs.h
+    unsigned long min_granularity;
+    unsigned long horizon;       // periodic releases stop here (0 = hyperperiod), see periodic.h
+    unsigned long long seed;     // lottery draws, see lottery.h
+    mlq_t mlq;                   // MLQ classes and arbiter, see mlq.h
+    mlq_class_t group_policy;    // HFS leaf policy and group slice, see group.h
+    unsigned long group_slice;
+    const group_tree_t *groups;  // HFS groups of the workload
+    const char *cpu_max;         // HFS bandwidth limits overriding the workload's
+    lock_protocol_t lock_protocol;   // priority inversion control, see lock.h
+    cosched_t cosched;           // gang: how rows share the CPUs, see gang.h
+    int gang_rows;
+    int nodes;                   // cluster mode, see cluster.h (0 = from the trace)
+    int node_cpus;               // (0 = from the trace, else 1)
+    cluster_alloc_t alloc;
+    int backfill_depth;
+    unsigned long bsld_tau;
+    dvfs_t dvfs;                 // frequency levels, governor and power curve, see dvfs.h
+    int dvfs_on;
+    paging_t mem;                // memory capacity, swap policy and paging costs, see paging.h
+    admit_t admit;               // admission control of arrivals, see admit.h
+    int quiet;               // summary only, no event stream
+} run_opts_t;
+
+/* Two classes: priority 1 and better interactive under RR, the rest batch */
+#define MLQ_DEFAULT "interactive:rr4:..1,batch:fcfs"
+
+static void parse_options(int argc, char *argv[], run_opts_t *o) {
+    const char *mlq_spec = MLQ_DEFAULT;
+    mlq_arbiter_t mlq_arbiter = MLQ_STRICT;
+    o->cpus = 1;
+    o->threads = 1;
+    o->placement = PLACE_LEAST_LOADED;
+    o->speeds = NULL;
+    o->migrate_up = 0;
+    o->window = 1;
+    o->switch_cost = 0;
+    o->cache_warmup = 0;
+    o->cache_size = 0;
+    o->migration_cost = 0;
+    o->disk = DISK_FIFO;
+    o->seek_rate = 0;
+    o->io_deadline = 100;
+    o->predict = PREDICT_EXACT;
+    o->alpha = 0.5;
+    o->tau0 = 10.0;
+    o->sched_latency = 24;
+    o->min_granularity = 3;
+    o->horizon = 0;
+    o->seed = 1;
+    o->quiet = 0;
+    memset(&o->group_policy, 0, sizeof(o->group_policy));
+    o->group_policy.policy = MLQ_RR;
+    o->group_policy.quantum = 4;
+    o->group_slice = 3;
+    o->groups = NULL;
+    o->cpu_max = NULL;
+    o->lock_protocol = LOCK_NONE;
+    o->cosched = COSCHED_FILL;
+    o->gang_rows = 0;
+    o->nodes = 0;
+    o->node_cpus = 0;
+    o->alloc = ALLOC_SHARED;
+    o->backfill_depth = 0;
+    o->bsld_tau = CLUSTER_TAU_DEFAULT;
+    dvfs_init(&o->dvfs);
+    o->dvfs_on = 0;
+    paging_init(&o->mem);
+    admit_init(&o->admit);
+    for (int i = 2; i < argc; i++) {
+        const char *a = argv[i];
+        if (strncmp(a, "--", 2) != 0) continue;
+        if (strncmp(a, "--cpus=", 7) == 0) o->cpus = atoi(a + 7);
+        else if (strncmp(a, "--threads=", 10) == 0) o->threads = atoi(a + 10);
+        else if (strcmp(a, "--placement=round-robin") == 0) o->placement = PLACE_ROUND_ROBIN;
+        else if (strcmp(a, "--placement=least-loaded") == 0) o->placement = PLACE_LEAST_LOADED;
+        else if (strcmp(a, "--placement=capacity") == 0) o->placement = PLACE_CAPACITY;
+        else if (strncmp(a, "--speeds=", 9) == 0) o->speeds = a + 9;
+        else if (strncmp(a, "--migrate-up=", 13) == 0) o->migrate_up = strtoul(a + 13, NULL, 10);
+        else if (strncmp(a, "--window=", 9) == 0) o->window = strtoul(a + 9, NULL, 10);
+        else if (strncmp(a, "--switch-cost=", 14) == 0) o->switch_cost = strtoul(a + 14, NULL, 10);
+        else if (strncmp(a, "--cache-warmup=", 15) == 0) o->cache_warmup = strtoul(a + 15, NULL, 10);
+        else if (strncmp(a, "--cache-size=", 13) == 0) o->cache_size = strtoul(a + 13, NULL, 10);
+        else if (strncmp(a, "--migration-cost=", 17) == 0) o->migration_cost = strtoul(a + 17, NULL, 10);
+        else if (strncmp(a, "--disk=", 7) == 0) {
+            int d = disk_parse_policy(a + 7);
+            if (d < 0) fprintf(stderr, "Warning: unknown disk policy %s, using fifo\n", a + 7);
+            else o->disk = (disk_sched_t)d;
+        }
+        else if (strncmp(a, "--seek-rate=", 12) == 0) o->seek_rate = strtoul(a + 12, NULL, 10);
+        else if (strncmp(a, "--io-deadline=", 14) == 0) o->io_deadline = strtoul(a + 14, NULL, 10);
+        else if (strncmp(a, "--predict=", 10) == 0) {
+            int m = predict_parse_mode(a + 10);
+            if (m < 0) fprintf(stderr, "Warning: unknown prediction mode %s, using exact\n", a + 10);
+            else o->predict = (predict_mode_t)m;
+        }
+        else if (strncmp(a, "--alpha=", 8) == 0) o->alpha = strtod(a + 8, NULL);
+        else if (strncmp(a, "--tau0=", 7) == 0) o->tau0 = strtod(a + 7, NULL);
+        else if (strncmp(a, "--sched-latency=", 16) == 0) o->sched_latency = strtoul(a + 16, NULL, 10);
+        else if (strncmp(a, "--min-granularity=", 18) == 0) o->min_granularity = strtoul(a + 18, NULL, 10);
+        else if (strncmp(a, "--horizon=", 10) == 0) o->horizon = strtoul(a + 10, NULL, 10);
+        else if (strncmp(a, "--seed=", 7) == 0) o->seed = strtoull(a + 7, NULL, 10);
+        else if (strncmp(a, "--mlq=", 6) == 0) mlq_spec = a + 6;
+        else if (strncmp(a, "--mlq-arbiter=", 14) == 0) {
+            int arb = mlq_parse_arbiter(a + 14);
+            if (arb < 0) fprintf(stderr, "Warning: unknown MLQ arbiter %s, using strict\n", a + 14);
+            else mlq_arbiter = (mlq_arbiter_t)arb;
+        }
+        else if (strncmp(a, "--group-policy=", 15) == 0) {
+            mlq_class_t c = o->group_policy;
+            if (mlq_parse_policy(a + 15, strlen(a + 15), &c) < 0)
+                fprintf(stderr, "Warning: unknown group policy %s, using rr4\n", a + 15);
+            else o->group_policy = c;
+        }
+        else if (strncmp(a, "--group-slice=", 14) == 0) o->group_slice = strtoul(a + 14, NULL, 10);
+        else if (strncmp(a, "--cpu-max=", 10) == 0) o->cpu_max = a + 10;
+        else if (strncmp(a, "--lock-protocol=", 16) == 0) {
+            int lp = lock_parse_protocol(a + 16);
+            if (lp < 0) fprintf(stderr, "Warning: unknown lock protocol %s, using none\n", a + 16);
+            else o->lock_protocol = (lock_protocol_t)lp;
+        }
+        else if (strncmp(a, "--coschedule=", 13) == 0) {
+            int cm = gang_parse_mode(a + 13);
+            if (cm < 0) fprintf(stderr, "Warning: unknown coscheduling mode %s, using fill\n", a + 13);
+            else o->cosched = (cosched_t)cm;
+        }
+        else if (strncmp(a, "--gang-rows=", 12) == 0) o->gang_rows = atoi(a + 12);
+        else if (strncmp(a, "--nodes=", 8) == 0) o->nodes = atoi(a + 8);
+        else if (strncmp(a, "--node-cpus=", 12) == 0) o->node_cpus = atoi(a + 12);
+        else if (strncmp(a, "--allocation=", 13) == 0) {
+            int al = cluster_parse_alloc(a + 13);
+            if (al < 0) fprintf(stderr, "Warning: unknown allocation %s, using shared\n", a + 13);
+            else o->alloc = (cluster_alloc_t)al;
+        }
+        else if (strncmp(a, "--backfill-depth=", 17) == 0) o->backfill_depth = atoi(a + 17);
+        else if (strncmp(a, "--bsld-tau=", 11) == 0) o->bsld_tau = strtoul(a + 11, NULL, 10);
+        else if (strncmp(a, "--governor=", 11) == 0) {
+            int g = dvfs_parse_governor(a + 11);
+            if (g < 0) fprintf(stderr, "Warning: unknown governor %s, using schedutil\n", a + 11);
+            else o->dvfs.governor = (governor_t)g;
+            o->dvfs_on = 1;
+        }
+        else if (strncmp(a, "--freqs=", 8) == 0) {
+            if (dvfs_parse_levels(&o->dvfs, a + 8) < 0)
+                fprintf(stderr, "Warning: invalid --freqs spec %s, using 40,60,80,100\n", a + 8);
+            o->dvfs_on = 1;
+        }
+        else if (strncmp(a, "--power=", 8) == 0) {
+            if (dvfs_parse_power(&o->dvfs, a + 8) < 0)
+                fprintf(stderr, "Warning: invalid --power spec %s, using 0.3,1.7,0.05\n", a + 8);
+            o->dvfs_on = 1;
+        }
+        else if (strncmp(a, "--memory=", 9) == 0) o->mem.capacity = strtoul(a + 9, NULL, 10);
+        else if (strncmp(a, "--swap=", 7) == 0) {
+            int sp = paging_parse_policy(a + 7);
+            if (sp < 0) fprintf(stderr, "Warning: unknown swap policy %s, using none\n", a + 7);
+            else o->mem.policy = (swap_policy_t)sp;
+        }
+        else if (strncmp(a, "--fault-cost=", 13) == 0) o->mem.fault_cost = strtod(a + 13, NULL);
+        else if (strncmp(a, "--swap-rate=", 12) == 0) o->mem.swap_rate = strtoul(a + 12, NULL, 10);
+        else if (strncmp(a, "--max-queue=", 12) == 0) o->admit.max_queue = atoi(a + 12);
+        else if (strncmp(a, "--admit-rate=", 13) == 0) o->admit.rate = strtod(a + 13, NULL);
+        else if (strncmp(a, "--admit-burst=", 14) == 0) o->admit.burst = strtod(a + 14, NULL);
+        else if (strcmp(a, "--admit-deadline") == 0) o->admit.deadline = 1;
+        else if (strcmp(a, "--shed-late") == 0) o->admit.shed_late = 1;
+        else if (strcmp(a, "--quiet") == 0) o->quiet = 1;
+        else fprintf(stderr, "Warning: ignoring unknown option %s\n", a);
+    }
+    if (o->cpus < 1) o->cpus = 1;
+    if (o->threads < 1) o->threads = 1;
+    if (o->gang_rows < 0) o->gang_rows = 0;
+    if (o->nodes < 0) o->nodes = 0;
+    if (o->node_cpus < 0) o->node_cpus = 0;
+    if (o->backfill_depth < 0) o->backfill_depth = 0;
+    if (o->bsld_tau < 1) o->bsld_tau = 1;
+    if (o->alpha < 0.0 || o->alpha > 1.0) {
+        fprintf(stderr, "Warning: --alpha must be in [0,1], using 0.5\n");
+        o->alpha = 0.5;
+    }
+    if (o->tau0 < 1.0) o->tau0 = 1.0;
+    if (o->mem.fault_cost < 0.0) o->mem.fault_cost = 0.0;
+    if (o->admit.max_queue < 0) o->admit.max_queue = 0;
+    if (o->admit.rate < 0.0) o->admit.rate = 0.0;
+    if (o->admit.burst < 1.0) o->admit.burst = 1.0;
+    o->admit.tokens = o->admit.burst;
+    o->admit.on = o->admit.max_queue || o->admit.rate > 0.0 || o->admit.deadline || o->admit.shed_late;
+    if (o->min_granularity < 1) o->min_granularity = 1;
+    if (o->sched_latency < o->min_granularity) o->sched_latency = o->min_granularity;
+    if (o->group_slice < 1) o->group_slice = 1;
+    if (mlq_parse(mlq_spec, &o->mlq) < 0) {
+        fprintf(stderr, "Warning: invalid --mlq spec %s, using %s\n", mlq_spec, MLQ_DEFAULT);
+        mlq_parse(MLQ_DEFAULT, &o->mlq);
+    }
+    o->mlq.arbiter = mlq_arbiter;
+}
 
 static sched_algo_t parse_algo(const char *name) {
     if (!name) return ALG_FCFS;
@@ -19,11 +236,127 @@ static sched_algo_t parse_algo(const char *name) {
     if (strcmp(name, "priority_p") == 0) return ALG_PRIORITY_P;
     if (strcmp(name, "rr") == 0) return ALG_RR;
     if (strcmp(name, "mlfq") == 0) return ALG_MLFQ;
+    if (strcmp(name, "cfs") == 0) return ALG_CFS;
+    if (strcmp(name, "eevdf") == 0) return ALG_EEVDF;
+    if (strcmp(name, "edf") == 0) return ALG_EDF;
+    if (strcmp(name, "rm") == 0) return ALG_RM;
+    if (strcmp(name, "lottery") == 0) return ALG_LOTTERY;
+    if (strcmp(name, "stride") == 0) return ALG_STRIDE;
+    if (strcmp(name, "hrrn") == 0) return ALG_HRRN;
+    if (strcmp(name, "mlq") == 0) return ALG_MLQ;
+    if (strcmp(name, "hfs") == 0) return ALG_HFS;
+    if (strcmp(name, "cpf") == 0) return ALG_CPF;
+    if (strcmp(name, "gang") == 0) return ALG_GANG;
+    if (strcmp(name, "easy") == 0) return ALG_EASY;
     return ALG_FCFS;
 }
 
-/* Simple JSON parser for workload file */
-static int parse_workload_json(const char *filename, process_t **processes, int *count) {
+/* Settings shared by the single scheduler and every CPU of the multi-CPU model */
+static void apply_cpu_options(scheduler_t *s, const run_opts_t *o, unsigned long quantum) {
+    s->quantum = quantum;
+    s->quiet = o->quiet;
+    s->switch_cost = o->switch_cost;
+    s->cache_warmup = o->cache_warmup;
+    s->cache_size = o->cache_size;
+    s->migration_cost = o->migration_cost;
+    s->disk_policy = o->disk;
+    s->seek_rate = o->seek_rate;
+    s->io_deadline = o->io_deadline;
+    /* only SJF and SRTF select on burst length */
+    s->predict = (s->algo == ALG_SJF || s->algo == ALG_SRTF) ? o->predict : PREDICT_EXACT;
+    s->alpha = o->alpha;
+    s->tau0 = o->tau0;
+    s->sched_latency = o->sched_latency;
+    s->min_granularity = o->min_granularity;
+    /* every CPU draws from its own stream, so runs repeat for any --threads */
+    s->rng = o->seed + (unsigned long long)(s->cpu_id + 1);
+    if (s->algo == ALG_MLQ) s->mlq = o->mlq;
+    if (s->algo == ALG_HFS && o->groups && group_copy(&s->groups, o->groups) < 0)
+        fprintf(stderr, "Warning: out of memory copying the groups\n");
+}
+
+/* Append to the growable workload array */
+static int push_process(process_t ***processes, int *count, int *capacity, process_t *p) {
+    if (*count == *capacity) {
+        int newcap = *capacity ? *capacity * 2 : 64;
+        process_t **arr = (process_t **)realloc(*processes, (size_t)newcap * sizeof(process_t *));
+        if (!arr) return -1;
+        *processes = arr;
+        *capacity = newcap;
+    }
+    (*processes)[(*count)++] = p;
+    return 0;
+}
+
+static int push_task(periodic_task_t **tasks, int *count, int *capacity, const periodic_task_t *t) {
+    if (*count == *capacity) {
+        int newcap = *capacity ? *capacity * 2 : 16;
+        periodic_task_t *arr = (periodic_task_t *)realloc(*tasks, (size_t)newcap * sizeof(periodic_task_t));
+        if (!arr) return -1;
+        *tasks = arr;
+        *capacity = newcap;
+    }
+    (*tasks)[(*count)++] = *t;
+    return 0;
+}
+
+/* Parse a JSON array of integers at 'key' inside obj, e.g. "bursts":[5,2,3].
+ * Returns the number of values stored in out (at most max), 0 if absent.
+ */
+static int parse_int_array(const char *obj, const char *key, int *out, int max) {
+    const char *a = strstr(obj, key);
+    if (!a) return 0;
+    a = strchr(a, '[');
+    if (!a) return 0;
+    a++;
+    int n = 0;
+    while (*a && *a != ']' && n < max) {
+        char *end;
+        long v = strtol(a, &end, 10);
+        if (end == a) {
+            a++;
+            continue;
+        }
+        out[n++] = (int)v;
+        a = end;
+    }
+    return n;
+}
+
+/* Copy the JSON string at 'key' inside obj, e.g. "class":"batch", to out
+ * (at most max - 1 chars). Returns 1 if found, 0 if absent or too long.
+ */
+static int parse_string(const char *obj, const char *key, char *out, size_t max) {
+    const char *a = strstr(obj, key);
+    if (!a) return 0;
+    a = strchr(a + strlen(key), '"');
+    if (!a) return 0;
+    const char *end = strchr(++a, '"');
+    if (!end || (size_t)(end - a) >= max) return 0;
+    memcpy(out, a, (size_t)(end - a));
+    out[end - a] = '\0';
+    return 1;
+}
+
+#define MAX_BURSTS 255
+#define MAX_LOCKS_SPEC 1024
+#define MAX_AFTER 128
+#define MAX_FORKS_SPEC 1024
+
+/* Simple JSON parser for workload file. Objects with a "period" are
+ * periodic tasks and go to tasks instead of processes. A "class" tag is
+ * looked up in mlq (MLQ runs only, NULL otherwise). A "group" path is
+ * added to groups (HFS runs only, NULL otherwise); objects with a "group"
+ * but no "pid" set that group's "weight" and "cpu_max" (bandwidth limit).
+ * A job's "locks" name its critical sections, whose resources are added to
+ * locks. A job's "after" lists the pids it depends on (see dag.h), and its
+ * "forks" the children it forks as it runs (see spawn.h), its "cpus"
+ * how many CPUs it runs on at once (see gang.h), its "walltime" the
+ * run time it asks for as a batch job (see cluster.h), and its
+ * "working_set" the pages it needs resident (see paging.h). */
+static int parse_workload_json(const char *filename, process_t ***processes, int *count,
+                               periodic_task_t **tasks, int *ntasks, const mlq_t *mlq,
+                               group_tree_t *groups, lock_table_t *locks) {
     FILE *fp = fopen(filename, "r");
     if (!fp) {
         fprintf(stderr, "Error: Cannot open workload file: %s\n", filename);
@@ -44,7 +377,10 @@ static int parse_workload_json(const char *filename, process_t **processes, int
     fclose(fp);
 
     /* Simple JSON array parser - assumes format: [{"pid":1,"arrival_time":0,"burst_time":5,"priority":1},...] */
-    int proc_count = 0;
+    int proc_count = 0, proc_capacity = 0;
+    int task_count = 0, task_capacity = 0;
+    *processes = NULL;
+    *tasks = NULL;
     char *p = strchr(content, '[');
     if (!p) {
         free(content);
@@ -53,13 +389,18 @@ static int parse_workload_json(const char *filename, process_t **processes, int
     }
     p++; /* skip '[' */
 
-    while (*p && proc_count < MAX_PROCESSES) {
+    while (*p) {
         /* Skip whitespace */
         while (*p && isspace(*p)) p++;
         if (*p == ']') break;
         if (*p != '{') break;
 
-        int pid = -1, arrival = 0, burst = 1, priority = 1;
+        /* Limit key lookups to this object so a missing key is not taken from the next one */
+        char *obj_end = strchr(p, '}');
+        if (!obj_end) break;
+        *obj_end = '\0';
+
+        int pid = -1, arrival = 0, burst = 1, priority = 1, deadline = -1, width = 1;
         
         /* Find pid */
         char *pid_str = strstr(p, "\"pid\"");
@@ -95,26 +436,225 @@ static int parse_workload_json(const char *filename, process_t **processes, int
             if (priority_str) priority = atoi(priority_str + 1);
         }
 
+        /* Optional deadline, in ticks after arrival */
+        char *deadline_str = strstr(p, "\"deadline\"");
+        if (deadline_str) {
+            deadline_str = strchr(deadline_str, ':');
+            if (deadline_str) deadline = atoi(deadline_str + 1);
+        }
+
+        /* Optional parallel job: "cpus", the CPUs it needs at once */
+        char *width_str = strstr(p, "\"cpus\"");
+        if (width_str) {
+            width_str = strchr(width_str, ':');
+            if (width_str) width = atoi(width_str + 1);
+        }
+
+        /* Optional batch job limit: "walltime", the run time it asks for */
+        long walltime = 0;
+        char *walltime_str = strstr(p, "\"walltime\"");
+        if (walltime_str) {
+            walltime_str = strchr(walltime_str, ':');
+            if (walltime_str) walltime = atol(walltime_str + 1);
+        }
+
+        /* Optional memory footprint: "working_set", in pages */
+        long working_set = 0;
+        char *ws_str = strstr(p, "\"working_set\"");
+        if (ws_str) {
+            ws_str = strchr(ws_str, ':');
+            if (ws_str) working_set = atol(ws_str + 1);
+        }
+
+        /* Periodic task: "period", "wcet" (or burst) and "offset" (or arrival) */
+        long period = -1, wcet = burst, offset = arrival;
+        char *period_str = strstr(p, "\"period\"");
+        if (period_str) {
+            period_str = strchr(period_str, ':');
+            if (period_str) period = atol(period_str + 1);
+        }
+        char *wcet_str = strstr(p, "\"wcet\"");
+        if (wcet_str) {
+            wcet_str = strchr(wcet_str, ':');
+            if (wcet_str) wcet = atol(wcet_str + 1);
+        }
+        char *offset_str = strstr(p, "\"offset\"");
+        if (offset_str) {
+            offset_str = strchr(offset_str, ':');
+            if (offset_str) offset = atol(offset_str + 1);
+        }
+        if (period_str) {
+            *obj_end = '}';
+            if (pid >= 0 && period > 0 && wcet > 0 && offset >= 0 && (unsigned long)offset < PERIODIC_HORIZON_MAX) {
+                periodic_task_t t;
+                memset(&t, 0, sizeof(t));
+                t.pid = pid;
+                t.priority = priority;
+                t.period = (unsigned long)period;
+                t.wcet = (unsigned long)wcet;
+                t.offset = (unsigned long)offset;
+                t.deadline = deadline > 0 ? (unsigned long)deadline : t.period;
+                if (push_task(tasks, &task_count, &task_capacity, &t) < 0) {
+                    free(content);
+                    fprintf(stderr, "Error: out of memory loading workload\n");
+                    return -1;
+                }
+            } else {
+                fprintf(stderr, "Warning: pid %d: skipping periodic task (needs pid >= 0, period > 0, wcet > 0, 0 <= offset < %lu)\n",
+                        pid, PERIODIC_HORIZON_MAX);
+            }
+            p = obj_end + 1;
+            while (*p && (isspace(*p) || *p == ',')) p++;
+            continue;
+        }
+
+        /* Optional MLQ class tag: "class":"name" */
+        int mlq_class = -1;
+        char name[GROUP_PATH_MAX];
+        if (mlq && parse_string(p, "\"class\"", name, sizeof(name))) {
+            mlq_class = mlq_find(mlq, name);
+            if (mlq_class < 0)
+                fprintf(stderr, "Warning: pid %d: unknown class \"%s\", placing it by priority\n", pid, name);
+        }
+
+        /* Optional fair-share group: "group":"tenant/service", and group
+         * settings: {"group":"tenant","weight":200,"cpu_max":"50 100"} */
+        int group = 0;
+        if (groups && parse_string(p, "\"group\"", name, sizeof(name))) {
+            group = group_lookup(groups, name, 1);
+            if (group < 0) {
+                fprintf(stderr, "Warning: group \"%s\": path too long, using the root group\n", name);
+                group = 0;
+            } else if (!strstr(p, "\"pid\"")) {
+                char *weight_str = strstr(p, "\"weight\"");
+                if (weight_str) {
+                    weight_str = strchr(weight_str, ':');
+                    long w = weight_str ? atol(weight_str + 1) : 0;
+                    if (w >= 1 && w <= GROUP_WEIGHT_MAX) groups->v[group].weight = (unsigned long)w;
+                    else fprintf(stderr, "Warning: group \"%s\": \"weight\" must be 1..%d\n", name, GROUP_WEIGHT_MAX);
+                }
+                char max[48];
+                unsigned long quota, period;
+                if (parse_string(p, "\"cpu_max\"", max, sizeof(max))) {
+                    if (group_parse_max(max, &quota, &period) == 0) group_set_max(groups, group, quota, period);
+                    else fprintf(stderr, "Warning: group \"%s\": \"cpu_max\" must be \"QUOTA [PERIOD]\" or \"max [PERIOD]\"\n", name);
+                }
+            }
+        }
+
+        /* Optional CPU/I-O burst sequence: "bursts":[cpu, io, cpu, ...] */
+        int bursts[MAX_BURSTS];
+        int nbursts = parse_int_array(p, "\"bursts\"", bursts, MAX_BURSTS);
+        if (nbursts > 0) burst = bursts[0];
+        /* Optional block address per I/O burst: "blocks":[b1, b2, ...] */
+        int blocks[MAX_BURSTS / 2];
+        int nblocks = parse_int_array(p, "\"blocks\"", blocks, MAX_BURSTS / 2);
+        /* Optional critical sections: "locks":"db@2+5,log@10+3" */
+        char locks_spec[MAX_LOCKS_SPEC];
+        crit_section_t sections[LOCK_MAX_SECTIONS];
+        int nsections = 0;
+        if (parse_string(p, "\"locks\"", locks_spec, sizeof(locks_spec))) {
+            nsections = lock_parse_sections(locks, locks_spec, priority, sections, LOCK_MAX_SECTIONS);
+            if (nsections < 0) {
+                fprintf(stderr, "Warning: pid %d: ignoring \"locks\" (expected \"RESOURCE@AT+HOLD,...\")\n", pid);
+                nsections = 0;
+            }
+        }
+
+        /* Optional predecessors: "after":[pid, ...] */
+        int after[MAX_AFTER];
+        int nafter = parse_int_array(p, "\"after\"", after, MAX_AFTER);
+        /* Optional forks: "forks":"2+5x3w,8+4" */
+        char forks_spec[MAX_FORKS_SPEC];
+        fork_spec_t forks[SPAWN_MAX_FORKS];
+        int nforks = 0;
+        if (parse_string(p, "\"forks\"", forks_spec, sizeof(forks_spec))) {
+            nforks = spawn_parse(forks_spec, forks, SPAWN_MAX_FORKS);
+            if (nforks < 0) {
+                fprintf(stderr, "Warning: pid %d: ignoring \"forks\" (expected \"AT+BURST[xCOUNT][w],...\")\n", pid);
+                nforks = 0;
+            }
+        }
+
+        *obj_end = '}';
+
         if (pid >= 0 && burst > 0) {
-            processes[proc_count] = process_create(pid, arrival, burst, priority);
-            proc_count++;
+            process_t *proc = process_create(pid, arrival, burst, priority);
+            if (proc && nbursts > 0 && process_set_bursts(proc, bursts, nbursts) < 0) {
+                fprintf(stderr, "Warning: pid %d: \"bursts\" must be an odd-length list of positive ticks, using %d\n",
+                        pid, burst);
+            }
+            if (proc && nblocks > 0 && process_set_blocks(proc, blocks, nblocks) < 0) {
+                fprintf(stderr, "Warning: pid %d: ignoring \"blocks\" (block addresses must be >= 0)\n", pid);
+            }
+            if (proc && nsections > 0 && process_set_sections(proc, sections, nsections) < 0) {
+                fprintf(stderr, "Warning: pid %d: ignoring \"locks\" (sections must be in order, not overlap "
+                        "and start within the job's CPU time)\n", pid);
+            }
+            if (proc && nforks > 0 && process_set_forks(proc, forks, nforks) < 0) {
+                fprintf(stderr, "Warning: pid %d: ignoring \"forks\" (forks must be in order and start within "
+                        "the job's CPU time)\n", pid);
+            }
+            if (proc && nafter > 0 && process_set_after(proc, after, nafter) < 0) {
+                process_free(proc);
+                proc = NULL;
+            }
+            if (proc && deadline_str) {
+                if (deadline > 0) proc->deadline = (unsigned int)arrival + (unsigned int)deadline;
+                else fprintf(stderr, "Warning: pid %d: ignoring \"deadline\" (must be > 0)\n", pid);
+            }
+            if (proc && width_str) {
+                if (width > 0) proc->width = width;
+                else fprintf(stderr, "Warning: pid %d: ignoring \"cpus\" (must be > 0)\n", pid);
+            }
+            if (proc && walltime_str) {
+                if (walltime > 0 && walltime <= INT_MAX) proc->walltime = (unsigned int)walltime;
+                else fprintf(stderr, "Warning: pid %d: ignoring \"walltime\" (must be > 0)\n", pid);
+            }
+            if (proc && ws_str) {
+                if (working_set >= 0) proc->working_set = (unsigned long)working_set;
+                else fprintf(stderr, "Warning: pid %d: ignoring \"working_set\" (must be >= 0)\n", pid);
+            }
+            if (proc) {
+                proc->mlq_class = mlq_class;
+                if (groups) proc->group = group;
+            }
+            if (!proc || push_process(processes, &proc_count, &proc_capacity, proc) < 0) {
+                process_free(proc);
+                free(content);
+                fprintf(stderr, "Error: out of memory loading workload\n");
+                return -1;
+            }
         }
 
         /* Move to next object */
-        p = strchr(p, '}');
-        if (!p) break;
-        p++;
+        p = obj_end + 1;
         while (*p && (isspace(*p) || *p == ',')) p++;
     }
 
     free(content);
     *count = proc_count;
+    *ntasks = task_count;
     fprintf(stderr, "Loaded %d processes from %s\n", proc_count, filename);
+    if (task_count) fprintf(stderr, "Loaded %d periodic tasks\n", task_count);
     return 0;
 }
 
+static int cmp_uint(const void *a, const void *b) {
+    unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+    return (x > y) - (x < y);
+}
+
+/* nearest-rank percentile of an ascending array */
+static unsigned int percentile(const unsigned int *sorted, size_t n, double pct) {
+    if (!n) return 0;
+    size_t rank = (size_t)ceil(pct / 100.0 * (double)n);
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
 /* helper to compute metrics and print JSON summary (single-line for proper parsing) */
-static void print_metrics_summary(scheduler_t *sched, const char *algo_name, int injected) {
+static void print_metrics_summary(scheduler_t *sched, const char *algo_name, int injected, const smp_t *smp) {
     if (!sched) return;
     size_t n = sched->completed_count;
     double total_wait = 0.0, total_turn = 0.0, total_resp = 0.0;
@@ -122,37 +662,665 @@ static void print_metrics_summary(scheduler_t *sched, const char *algo_name, int
     unsigned long context_switches = sched->context_switches;
 
     /* Print single-line JSON */
-    printf("{\"algorithm\":\"%s\",\"injected\":%d,\"ticks\":%lu,\"context_switches\":%lu,\"processes\":[", 
+    printf("{\"algorithm\":\"%s\",\"injected\":%d,\"ticks\":%lu,\"context_switches\":%lu,", 
            algo_name, injected, total_exec_time, context_switches);
 
+    /* multi-CPU runs: per-CPU load, useful to check placement balance */
+    if (smp) {
+        printf("\"cpus\":%d,\"threads\":%d,\"epochs\":%lu,\"migrations\":%lu,\"per_cpu\":[",
+               smp->ncpus, smp->nthreads, smp->epochs, smp->migrations);
+        for (int i = 0; i < smp->ncpus; ++i) {
+            const scheduler_t *c = smp->cpus[i];
+            double util = total_exec_time ? (double)c->busy_ticks / (double)total_exec_time : 0.0;
+            printf("{\"cpu\":%d,\"speed\":%u,\"completed\":%zu,\"busy_ticks\":%lu,\"utilization\":%.3f",
+                   i, c->speed, c->completed_count, c->busy_ticks, util);
+            if (c->freq.cfg)
+                printf(",\"energy\":%.6f", c->freq.energy +
+                       (double)(total_exec_time - c->busy_ticks) * dvfs_idle_power(c) * DVFS_TICK_SECONDS);
+            printf("}%s", (i + 1 == smp->ncpus) ? "" : ",");
+        }
+        printf("],");
+    }
+    printf("\"processes\":[");
+
+    const scheduler_t *cpu0 = smp ? smp->cpus[0] : sched;
+    int dvfs_on = cpu0->freq.cfg != NULL;
+    /* periodic jobs are not listed, but count in the averages, percentiles
+     * and throughput with the rest */
+    size_t nturns = n + sched->periodic_jobs, counted = n;
+    unsigned int *turns = nturns ? (unsigned int *)malloc(nturns * sizeof(unsigned int)) : NULL;
     for (size_t i = 0; i < n; ++i) {
         completed_proc_t *c = &sched->completed[i];
         unsigned int start = c->start_time;
         unsigned int finish = c->finish_time;
         if (start == UINT_MAX) start = finish; /* defensive */
         unsigned int turnaround = finish - c->arrival;
-        int waiting = (int)turnaround - c->burst;
+        int waiting = (int)turnaround - c->burst - c->io_time;
         unsigned int response = start - c->arrival;
         total_wait += waiting;
         total_turn += turnaround;
         total_resp += response;
-        printf("{\"pid\":%d,\"arrival\":%u,\"burst\":%d,\"priority\":%d,\"start\":%u,\"finish\":%u,\"waiting\":%d,\"turnaround\":%u,\"response\":%u}%s",
-               c->pid, c->arrival, c->burst, c->priority, start, finish, waiting, turnaround, response, (i+1==n) ? "" : ",");
+        if (turns) turns[i] = turnaround;
+        printf("{\"pid\":%d,\"arrival\":%u,\"burst\":%d,\"priority\":%d,\"start\":%u,\"finish\":%u,\"waiting\":%d,\"turnaround\":%u,\"response\":%u",
+               c->pid, c->arrival, c->burst, c->priority, start, finish, waiting, turnaround, response);
+        if (c->io_time) printf(",\"io\":%d", c->io_time);
+        /* the fair policies trade latency for fairness: show both per job */
+        if (sched->algo == ALG_CFS || sched->algo == ALG_EEVDF)
+            printf(",\"latency\":{\"avg\":%.3f,\"max\":%u}", c->latency_avg, c->latency_max);
+        if (sched->algo == ALG_EEVDF) printf(",\"max_lag\":%.3f", c->max_lag);
+        if (c->deadline != UINT_MAX)
+            printf(",\"deadline\":%u,\"lateness\":%ld", c->deadline, (long)finish - (long)c->deadline);
+        if (c->tickets)
+            printf(",\"share\":{\"tickets\":%lu,\"target\":%.6f,\"achieved\":%.6f}",
+                   c->tickets, c->share_target, c->share_achieved);
+        if (c->mlq_class >= 0) printf(",\"class\":\"%s\"", sched->mlq.classes[c->mlq_class].name);
+        if (c->group >= 0 && c->group < sched->groups.n)
+            printf(",\"group\":\"%s\"", sched->groups.v[c->group].path);
+        if (sched->locks.n) printf(",\"blocked\":%u,\"inversion\":%u", c->lock_blocked, c->lock_inversion);
+        if (c->released != UINT_MAX) printf(",\"released\":%u", c->released);
+        if (c->ppid >= 0) printf(",\"ppid\":%d", c->ppid);
+        if (c->forked) printf(",\"forked\":%d,\"fork_wait\":%u", c->forked, c->fork_wait);
+        if (c->width > 1) printf(",\"cpus\":%d", c->width);
+        if (dvfs_on) printf(",\"energy\":%.6f", c->energy);
+        if (sched->mem.capacity)
+            printf(",\"working_set\":%lu,\"fault_ticks\":%u,\"swap_outs\":%u", c->working_set, c->fault_ticks, c->swap_outs);
+        printf("}%s", (i+1==n) ? "" : ",");
+    }
+    for (size_t i = 0; i < sched->ntasks; ++i) {
+        const periodic_task_t *t = &sched->tasks[i];
+        counted += t->completed;
+        total_turn += (double)t->response_total;
+        total_wait += (double)t->response_total - (double)(t->completed * t->wcet);
+        total_resp += (double)t->start_total;
     }
-    double avg_wait = n ? total_wait / (double)n : 0.0;
-    double avg_turn = n ? total_turn / (double)n : 0.0;
-    double avg_resp = n ? total_resp / (double)n : 0.0;
-    printf("],\"averages\":{\"waiting_time\":%.3f,\"turnaround_time\":%.3f,\"response_time\":%.3f}}\n",
+    if (turns && sched->periodic_jobs)
+        memcpy(turns + n, sched->periodic_turns, sched->periodic_jobs * sizeof(unsigned int));
+    double avg_wait = counted ? total_wait / (double)counted : 0.0;
+    double avg_turn = counted ? total_turn / (double)counted : 0.0;
+    double avg_resp = counted ? total_resp / (double)counted : 0.0;
+    printf("],\"averages\":{\"waiting_time\":%.3f,\"turnaround_time\":%.3f,\"response_time\":%.3f}",
            avg_wait, avg_turn, avg_resp);
+
+    /* tail latency and throughput (completed jobs per tick) */
+    if (turns) qsort(turns, nturns, sizeof(unsigned int), cmp_uint);
+    printf(",\"turnaround_percentiles\":{\"p50\":%u,\"p95\":%u,\"p99\":%u},\"throughput\":%.4f",
+           percentile(turns, turns ? nturns : 0, 50), percentile(turns, turns ? nturns : 0, 95),
+           percentile(turns, turns ? nturns : 0, 99),
+           total_exec_time ? (double)counted / (double)total_exec_time : 0.0);
+    free(turns);
+
+    /* busy time that made no progress: dispatch cost, cold caches, migration */
+    unsigned long useful = scheduler_useful_ticks(sched);
+    unsigned long stall = sched->busy_ticks - useful;
+    printf(",\"switch_overhead\":{\"switch_ticks\":%lu,\"warmup_ticks\":%lu,\"migration_ticks\":%lu,\"busy_share\":%.4f}",
+           sched->switch_ticks, sched->warmup_ticks, sched->migration_ticks,
+           sched->busy_ticks ? (double)stall / (double)sched->busy_ticks : 0.0);
+
+    /* effective CPU efficiency: useful ticks over all CPU ticks of the run */
+    unsigned long cpu_ticks = total_exec_time * (unsigned long)(smp ? smp->ncpus : 1);
+    printf(",\"useful_ticks\":%lu,\"cpu_efficiency\":%.4f",
+           useful, cpu_ticks ? (double)useful / (double)cpu_ticks : 0.0);
+
+    /* CPU vs I/O device activity (one device per CPU), and how the device
+     * scheduler served its queue */
+    printf(",\"io\":{\"cpu_utilization\":%.4f,\"device_utilization\":%.4f,\"overlap\":%.4f",
+           cpu_ticks ? (double)sched->busy_ticks / (double)cpu_ticks : 0.0,
+           cpu_ticks ? (double)sched->io_busy_ticks / (double)cpu_ticks : 0.0,
+           cpu_ticks ? (double)sched->overlap_ticks / (double)cpu_ticks : 0.0);
+    printf(",\"disk\":{\"policy\":\"%s\",\"requests\":%lu,\"avg_queue_wait\":%.3f,\"max_queue_wait\":%lu,"
+           "\"seek_distance\":%lu,\"seek_ticks\":%lu,\"overdue\":%lu}}",
+           disk_policy_name(sched->disk_policy), sched->io_requests,
+           sched->io_requests ? (double)sched->io_wait_total / (double)sched->io_requests : 0.0,
+           sched->io_wait_max, sched->seek_distance, sched->seek_ticks, sched->io_overdue);
+
+    /* ticks from arrival or I/O completion to the next dispatch */
+    printf(",\"wakeup_latency\":{\"wakeups\":%lu,\"avg\":%.3f,\"max\":%lu}",
+           sched->wakeups, sched->wakeups ? (double)sched->latency_total / (double)sched->wakeups : 0.0,
+           sched->latency_max);
+
+    /* jobs with a deadline: misses, tardiness (lateness, floored at 0) and
+     * a histogram of lateness; bucket i counts lateness in
+     * (lateness_bounds[i-1], lateness_bounds[i]], the last one the rest */
+    static const long lateness_bounds[] = {-64, -16, -4, 0, 4, 16, 64, 256, 1024};
+    enum { NBOUNDS = sizeof(lateness_bounds) / sizeof(lateness_bounds[0]) };
+    unsigned int *tardy = n ? (unsigned int *)malloc(n * sizeof(unsigned int)) : NULL;
+    size_t nd = 0, missed = 0;
+    unsigned long hist[NBOUNDS + 1] = {0};
+    double total_tardy = 0.0;
+    for (size_t i = 0; tardy && i < n; ++i) {
+        const completed_proc_t *c = &sched->completed[i];
+        if (c->deadline == UINT_MAX) continue;
+        long late = (long)c->finish_time - (long)c->deadline;
+        int b = 0;
+        while (b < NBOUNDS && late > lateness_bounds[b]) b++;
+        hist[b]++;
+        if (late > 0) missed++;
+        tardy[nd++] = late > 0 ? (unsigned int)late : 0;
+        total_tardy += late > 0 ? (double)late : 0.0;
+    }
+    if (nd) {
+        qsort(tardy, nd, sizeof(unsigned int), cmp_uint);
+        printf(",\"deadlines\":{\"jobs\":%zu,\"missed\":%zu,\"miss_rate\":%.4f,"
+               "\"tardiness\":{\"avg\":%.3f,\"p50\":%u,\"p95\":%u,\"p99\":%u,\"max\":%u},"
+               "\"lateness_histogram\":{\"bounds\":[",
+               nd, missed, (double)missed / (double)nd, total_tardy / (double)nd,
+               percentile(tardy, nd, 50), percentile(tardy, nd, 95), percentile(tardy, nd, 99), tardy[nd - 1]);
+        for (int b = 0; b < NBOUNDS; ++b) printf("%s%ld", b ? "," : "", lateness_bounds[b]);
+        printf("],\"counts\":[");
+        for (int b = 0; b <= NBOUNDS; ++b) printf("%s%lu", b ? "," : "", hist[b]);
+        printf("]}}");
+    }
+    free(tardy);
+
+    /* proportional share: how far each job's CPU share, over the ticks it
+     * was runnable, ended up from what its tickets entitled it to, in
+     * absolute terms and relative to the entitlement */
+    if (sched->algo == ALG_LOTTERY || sched->algo == ALG_STRIDE) {
+        size_t ns = 0;
+        double total_err = 0.0, max_err = 0.0, total_rel = 0.0, max_rel = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            const completed_proc_t *c = &sched->completed[i];
+            if (!c->tickets || c->share_target <= 0.0) continue;
+            double err = fabs(c->share_achieved - c->share_target);
+            double rel = err / c->share_target;
+            total_err += err;
+            total_rel += rel;
+            if (err > max_err) max_err = err;
+            if (rel > max_rel) max_rel = rel;
+            ns++;
+        }
+        printf(",\"share\":{\"jobs\":%zu,\"mean_abs_error\":%.6f,\"max_abs_error\":%.6f,"
+               "\"mean_rel_error\":%.4f,\"max_rel_error\":%.4f}",
+               ns, ns ? total_err / (double)ns : 0.0, max_err, ns ? total_rel / (double)ns : 0.0, max_rel);
+    }
+
+    /* MLQ: what each class got of the CPU and what its jobs saw */
+    if (sched->algo == ALG_MLQ) {
+        const mlq_t *m = &sched->mlq;
+        unsigned long class_ticks = 0;
+        for (int k = 0; k < m->n; ++k) class_ticks += m->classes[k].cpu_ticks;
+        printf(",\"mlq\":{\"arbiter\":\"%s\",\"classes\":[", mlq_arbiter_name(m->arbiter));
+        for (int k = 0; k < m->n; ++k) {
+            const mlq_class_t *cl = &m->classes[k];
+            size_t jobs = 0;
+            double wait = 0.0, turn = 0.0, resp = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                const completed_proc_t *c = &sched->completed[i];
+                if (c->mlq_class != k) continue;
+                unsigned int start = c->start_time == UINT_MAX ? c->finish_time : c->start_time;
+                unsigned int turnaround = c->finish_time - c->arrival;
+                wait += (double)((int)turnaround - c->burst - c->io_time);
+                turn += turnaround;
+                resp += start - c->arrival;
+                jobs++;
+            }
+            printf("{\"name\":\"%s\",\"policy\":\"%s\"", cl->name, mlq_policy_name(cl));
+            if (cl->policy == MLQ_RR) printf(",\"quantum\":%d", cl->quantum);
+            if (m->arbiter == MLQ_SLICE) printf(",\"share\":%lu", cl->share);
+            printf(",\"jobs\":%zu,\"cpu_ticks\":%lu,\"cpu_share\":%.4f,"
+                   "\"avg_waiting\":%.3f,\"avg_turnaround\":%.3f,\"avg_response\":%.3f}%s",
+                   jobs, cl->cpu_ticks, class_ticks ? (double)cl->cpu_ticks / (double)class_ticks : 0.0,
+                   jobs ? wait / (double)jobs : 0.0, jobs ? turn / (double)jobs : 0.0,
+                   jobs ? resp / (double)jobs : 0.0, (k + 1 == m->n) ? "" : ",");
+        }
+        printf("]}");
+    }
+
+    /* HFS: per group (subtree), the CPU share its weight entitled it to
+     * while runnable next to the one it got, and what its jobs saw */
+    if (sched->algo == ALG_HFS && sched->groups.n) {
+        const group_tree_t *t = &sched->groups;
+        printf(",\"groups\":{\"policy\":\"%s\"", mlq_policy_name(&t->policy));
+        if (t->policy.policy == MLQ_RR) printf(",\"quantum\":%d", t->policy.quantum);
+        printf(",\"slice\":%lu,", t->slice);
+        if (t->bandwidth) printf("\"throttled_idle_ticks\":%lu,", t->throttled_idle);
+        printf("\"nodes\":[");
+        unsigned int *group_turns = n ? (unsigned int *)malloc(n * sizeof(unsigned int)) : NULL;
+        int first = 1;
+        for (int g = 0; g < t->n; ++g) {
+            const group_t *node = &t->v[g];
+            /* the root is the whole CPU; show it only when it is the one group */
+            if (g == 0 && t->n > 1) continue;
+            size_t jobs = 0;
+            double wait = 0.0, resp = 0.0, lat = 0.0;
+            unsigned int lat_max = 0;
+            for (size_t i = 0; i < n; ++i) {
+                const completed_proc_t *c = &sched->completed[i];
+                int a = c->group;
+                while (a >= 0 && a != g) a = t->v[a].parent;
+                if (a != g) continue;
+                unsigned int start = c->start_time == UINT_MAX ? c->finish_time : c->start_time;
+                unsigned int turnaround = c->finish_time - c->arrival;
+                wait += (double)((int)turnaround - c->burst - c->io_time);
+                resp += start - c->arrival;
+                lat += c->latency_avg;
+                if (c->latency_max > lat_max) lat_max = c->latency_max;
+                if (group_turns) group_turns[jobs] = turnaround;
+                jobs++;
+            }
+            if (group_turns) qsort(group_turns, jobs, sizeof(unsigned int), cmp_uint);
+            size_t nt = group_turns ? jobs : 0;
+            printf("%s{\"path\":\"%s\",\"weight\":%lu,\"jobs\":%zu,\"cpu_ticks\":%lu,\"cpu_share\":%.4f,"
+                   "\"target\":%.4f,\"achieved\":%.4f,\"avg_waiting\":%.3f,\"avg_response\":%.3f,"
+                   "\"latency\":{\"avg\":%.3f,\"max\":%u},"
+                   "\"turnaround_percentiles\":{\"p50\":%u,\"p95\":%u,\"p99\":%u}",
+                   first ? "" : ",", g ? node->path : "/", node->weight, jobs, node->cpu_ticks,
+                   t->v[0].cpu_ticks ? (double)node->cpu_ticks / (double)t->v[0].cpu_ticks : 0.0,
+                   node->runnable_ticks ? node->due / (double)node->runnable_ticks : 0.0,
+                   node->runnable_ticks ? (double)node->cpu_ticks / (double)node->runnable_ticks : 0.0,
+                   jobs ? wait / (double)jobs : 0.0, jobs ? resp / (double)jobs : 0.0,
+                   jobs ? lat / (double)jobs : 0.0, lat_max,
+                   percentile(group_turns, nt, 50), percentile(group_turns, nt, 95), percentile(group_turns, nt, 99));
+            /* cpu.stat of a group with a bandwidth limit */
+            if (node->quota)
+                printf(",\"cpu_max\":{\"quota\":%lu,\"period\":%lu,\"nr_periods\":%lu,\"nr_throttled\":%lu,"
+                       "\"throttled_ticks\":%lu}",
+                       node->quota, node->period, node->nr_periods, node->nr_throttled, node->throttled_ticks);
+            printf("}");
+            first = 0;
+        }
+        free(group_turns);
+        printf("]}");
+    }
+
+    /* critical sections: contention per resource, and the time jobs spent
+     * blocked on one, in total and behind a lower-priority job */
+    if (sched->locks.n) {
+        const lock_table_t *t = &sched->locks;
+        size_t jobs_blocked = 0;
+        unsigned long blocked = 0, inversion = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const completed_proc_t *c = &sched->completed[i];
+            if (c->lock_blocked) jobs_blocked++;
+            blocked += c->lock_blocked;
+            inversion += c->lock_inversion;
+        }
+        printf(",\"locks\":{\"protocol\":\"%s\",\"jobs_blocked\":%zu,\"blocked_ticks\":%lu,"
+               "\"inversion_ticks\":%lu,\"spin_ticks\":%lu,\"resources\":[",
+               lock_protocol_name(t->protocol), jobs_blocked, blocked, inversion, t->spin_ticks);
+        for (int k = 0; k < t->n; ++k) {
+            const resource_t *r = &t->v[k];
+            printf("{\"name\":\"%s\",\"ceiling\":%d,\"acquisitions\":%lu,\"contended\":%lu,"
+                   "\"hold_ticks\":%lu,\"avg_hold\":%.3f,\"blocked_ticks\":%lu,\"avg_blocked\":%.3f,"
+                   "\"max_blocked\":%lu,\"inversion_ticks\":%lu}%s",
+                   r->name, r->ceiling, r->acquisitions, r->contended, r->hold_ticks,
+                   r->acquisitions ? (double)r->hold_ticks / (double)r->acquisitions : 0.0,
+                   r->blocked_ticks, r->contended ? (double)r->blocked_ticks / (double)r->contended : 0.0,
+                   r->blocked_max, r->inversion_ticks, (k + 1 == t->n) ? "" : ",");
+        }
+        printf("]}");
+    }
+
+    /* forks: how much of the workload was created at run time, and the time
+     * programs spent forking and waiting for their children */
+    if (sched->forked) {
+        size_t programs = 0, children = 0, waiters = 0;
+        unsigned long wait = 0, child_turn = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const completed_proc_t *c = &sched->completed[i];
+            if (c->forked) programs++;
+            if (c->fork_wait) waiters++;
+            wait += c->fork_wait;
+            if (c->ppid < 0) continue;
+            children++;
+            child_turn += c->finish_time - c->arrival;
+        }
+        printf(",\"forks\":{\"programs\":%zu,\"children\":%zu,\"fork_ticks\":%lu,\"waited\":%zu,"
+               "\"wait_ticks\":%lu,\"avg_wait\":%.3f,\"child_turnaround\":%.3f}",
+               programs, children, sched->fork_ticks, waiters, wait,
+               waiters ? (double)wait / (double)waiters : 0.0,
+               children ? (double)child_turn / (double)children : 0.0);
+    }
+
+    /* job dependencies: the makespan against the two lower bounds, the
+     * critical path and the CPU work spread over every CPU */
+    if (sched->dag) {
+        const dag_t *d = sched->dag;
+        unsigned int first = UINT_MAX, last = 0;
+        size_t dependent = 0;
+        unsigned long held = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const completed_proc_t *c = &sched->completed[i];
+            if (c->arrival < first) first = c->arrival;
+            if (c->finish_time > last) last = c->finish_time;
+            if (c->released == UINT_MAX) continue;
+            dependent++;
+            if (c->released > c->arrival) held += c->released - c->arrival;
+        }
+        unsigned long makespan = n ? last - first : 0;
+        unsigned long capacity = 0;
+        if (smp) for (int i = 0; i < smp->ncpus; ++i) capacity += smp->cpus[i]->speed;
+        else capacity = sched->speed;
+        unsigned long work_bound = capacity ? (d->work * 100 + capacity - 1) / capacity : 0;
+        unsigned long bound = d->path_bound > work_bound ? d->path_bound : work_bound;
+        printf(",\"dag\":{\"jobs\":%d,\"edges\":%d,\"dependent\":%zu,\"avg_held\":%.3f,\"makespan\":%lu,"
+               "\"critical_path\":%lu,\"work_bound\":%lu,\"makespan_ratio\":%.4f}",
+               d->n, d->nedges, dependent, dependent ? (double)held / (double)dependent : 0.0, makespan,
+               d->path_bound, work_bound, bound ? (double)makespan / (double)bound : 0.0);
+    }
+
+    /* gang scheduling: how full the matrix was, and where the CPU time went:
+     * to work, to threads spinning for a sibling, or idle although a job was
+     * waiting (fragmentation) or held its CPU for I/O */
+    if (smp && smp->gang) {
+        const gang_t *g = smp->gang;
+        unsigned long waste = g->frag_ticks + g->held_ticks + sched->sync_ticks;
+        printf(",\"gang\":{\"coschedule\":\"%s\",\"slice\":%lu,\"max_rows\":%d,\"rows_peak\":%d,\"avg_rows\":%.3f,"
+               "\"row_switches\":%lu,\"queued\":%lu,\"avg_queue_wait\":%.3f,\"max_queue_wait\":%lu,"
+               "\"cpu_ticks\":%lu,\"busy_ticks\":%lu,\"sync_ticks\":%lu,\"fill_ticks\":%lu,"
+               "\"fragmentation_ticks\":%lu,\"held_ticks\":%lu,\"idle_ticks\":%lu,"
+               "\"fragmentation\":%.4f,\"waste\":%.4f}",
+               gang_mode_name(g->mode), g->slice, g->max_rows, g->rows_peak,
+               g->ticks ? (double)g->row_ticks / (double)g->ticks : 0.0, g->row_switches, g->queued,
+               g->queued ? (double)g->queue_wait / (double)g->queued : 0.0, g->queue_wait_max,
+               cpu_ticks, sched->busy_ticks, sched->sync_ticks, g->fill_ticks,
+               g->frag_ticks, g->held_ticks, g->idle_ticks,
+               cpu_ticks ? (double)g->frag_ticks / (double)cpu_ticks : 0.0,
+               cpu_ticks ? (double)waste / (double)cpu_ticks : 0.0);
+    }
+
+    /* DVFS: energy of the busy ticks (at their levels) and the idle ones,
+     * what it bought in jobs, and where the busy ticks ran */
+    if (dvfs_on) {
+        const dvfs_t *d = cpu0->freq.cfg;
+        int ncpus = smp ? smp->ncpus : 1;
+        double busy_j = 0.0, idle_j = 0.0, freq_ticks = 0.0;
+        unsigned long switches = 0, busy = 0, residency[DVFS_MAX_LEVELS] = {0};
+        for (int i = 0; i < ncpus; ++i) {
+            const scheduler_t *c = smp ? smp->cpus[i] : sched;
+            busy_j += c->freq.energy;
+            idle_j += (double)(total_exec_time - c->busy_ticks) * dvfs_idle_power(c) * DVFS_TICK_SECONDS;
+            switches += c->freq.switches;
+            for (int l = 0; l < d->nlevels; ++l) {
+                residency[l] += c->freq.level_ticks[l];
+                busy += c->freq.level_ticks[l];
+                freq_ticks += (double)c->freq.level_ticks[l] * d->levels[l];
+            }
+        }
+        double joules = busy_j + idle_j;
+        double seconds = (double)total_exec_time * DVFS_TICK_SECONDS;
+        printf(",\"energy\":{\"governor\":\"%s\",\"levels\":[", dvfs_governor_name(d->governor));
+        for (int l = 0; l < d->nlevels; ++l) printf("%s%u", l ? "," : "", d->levels[l]);
+        printf("],\"power\":{\"static\":%.3f,\"dynamic\":%.3f,\"idle\":%.3f},\"tick_seconds\":%g,"
+               "\"joules\":%.6f,\"busy_joules\":%.6f,\"idle_joules\":%.6f,\"avg_power\":%.4f,"
+               "\"energy_per_job\":%.6f,\"throughput_per_joule\":%.4f,\"avg_frequency\":%.2f,"
+               "\"freq_switches\":%lu,\"residency\":[",
+               d->p_static, d->p_dynamic, d->p_idle, DVFS_TICK_SECONDS, joules, busy_j, idle_j,
+               seconds > 0 ? joules / seconds : 0.0, counted ? joules / (double)counted : 0.0,
+               joules > 0 ? (double)counted / joules : 0.0, busy ? freq_ticks / (double)busy : 0.0, switches);
+        for (int l = 0; l < d->nlevels; ++l) printf("%s%lu", l ? "," : "", residency[l]);
+        printf("]}");
+    }
+
+    /* memory pressure: how far the working sets overcommitted memory, how
+     * many jobs were loaded (the multiprogramming level), and the busy ticks
+     * lost to paging rather than spent on work */
+    if (sched->mem.capacity) {
+        const paging_t *m = &sched->mem;
+        unsigned long paging = m->fault_ticks + m->swap_ticks;
+        printf(",\"memory\":{\"capacity\":%lu,\"swap\":\"%s\",\"fault_cost\":%.3f,\"swap_rate\":%lu,"
+               "\"demand_peak\":%lu,\"loaded_peak\":%d,\"avg_loaded\":%.3f,\"overcommitted_ticks\":%lu,"
+               "\"fault_ticks\":%lu,\"swap_ticks\":%lu,\"swap_outs\":%lu,\"swap_ins\":%lu,\"forced_swap_ins\":%lu,"
+               "\"pages_swapped_out\":%llu,\"paging_share\":%.4f}",
+               m->capacity, paging_policy_name(m->policy), m->fault_cost, m->swap_rate,
+               m->demand_peak, m->loaded_peak, total_exec_time ? (double)m->loaded_sum / (double)total_exec_time : 0.0,
+               m->over_ticks, m->fault_ticks, m->swap_ticks, m->swap_outs, m->swap_ins, m->forced_ins,
+               m->pages_out, sched->busy_ticks ? (double)paging / (double)sched->busy_ticks : 0.0);
+    }
+
+    /* admission control: what got in and what did not, by reason, and the
+     * goodput: jobs completed by their deadline (or with none) per tick */
+    if (sched->admit.on) {
+        const admit_t *a = &sched->admit;
+        unsigned long rejected = 0;
+        for (int r = 0; r < REJECT_REASONS; ++r) rejected += a->rejected[r];
+        size_t on_time = 0;
+        for (size_t i = 0; i < n; ++i)
+            if (sched->completed[i].deadline == UINT_MAX || sched->completed[i].finish_time <= sched->completed[i].deadline)
+                on_time++;
+        printf(",\"admission\":{\"max_queue\":%d,\"rate\":%.4f,\"burst\":%.2f,\"deadline\":%s,\"shed_late\":%s,"
+               "\"arrivals\":%lu,\"admitted\":%lu,\"rejected\":{\"total\":%lu",
+               a->max_queue, a->rate, a->burst, a->deadline ? "true" : "false", a->shed_late ? "true" : "false",
+               a->arrivals, a->admitted, rejected);
+        for (int r = 0; r < REJECT_REASONS; ++r) printf(",\"%s\":%lu", admit_reason_name(r), a->rejected[r]);
+        printf("},\"shed\":%lu,\"shed_ticks\":%lu,\"queue_peak\":%d,\"completed\":%zu,\"on_time\":%zu,"
+               "\"goodput\":%.4f,\"goodput_share\":%.4f",
+               a->shed, a->shed_ticks, a->queue_peak, n, on_time,
+               total_exec_time ? (double)on_time / (double)total_exec_time : 0.0,
+               a->arrivals ? (double)on_time / (double)a->arrivals : 0.0);
+        /* rejected and shed jobs, each in the order they left */
+        for (int shed = 0; shed < 2; ++shed) {
+            printf(",\"%s\":[", shed ? "shed_jobs" : "rejected_jobs");
+            int first = 1;
+            for (size_t i = 0; i < a->ndropped; ++i) {
+                const dropped_job_t *d = &a->dropped[i];
+                if ((d->reason < 0) != shed) continue;
+                printf("%s{\"pid\":%d,\"arrival\":%u,\"burst\":%d", first ? "" : ",", d->pid, d->arrival, d->burst);
+                if (d->deadline != UINT_MAX) printf(",\"deadline\":%u", d->deadline);
+                if (shed) printf(",\"shed_at\":%u}", d->at);
+                else printf(",\"reason\":\"%s\"}", admit_reason_name(d->reason));
+                first = 0;
+            }
+            printf("]");
+        }
+        printf("}");
+    }
+
+    /* periodic tasks: the analysis next to what the simulation saw */
+    if (sched->ntasks) {
+        const periodic_analysis_t *a = &sched->analysis;
+        printf(",\"periodic\":{\"tasks\":%zu,\"horizon\":%lu,\"utilization\":%.4f,\"ll_bound\":%.4f,"
+               "\"ll_test\":\"%s\",\"rta_schedulable\":%s,",
+               sched->ntasks, sched->horizon, a->utilization, a->ll_bound, periodic_ll_verdict(a),
+               a->rta_schedulable ? "true" : "false");
+        if (a->hyperperiod) printf("\"hyperperiod\":%llu,\"per_task\":[", a->hyperperiod);
+        else printf("\"hyperperiod\":null,\"per_task\":[");
+        for (size_t i = 0; i < sched->ntasks; ++i) {
+            const periodic_task_t *t = &sched->tasks[i];
+            printf("{\"pid\":%d,\"period\":%lu,\"wcet\":%lu,\"offset\":%lu,\"deadline\":%lu,",
+                   t->pid, t->period, t->wcet, t->offset, t->deadline);
+            if (t->wcrt) printf("\"wcrt\":%lu,", t->wcrt);
+            else printf("\"wcrt\":null,");
+            printf("\"jobs\":%lu,\"missed\":%lu,\"avg_response\":%.3f,\"max_response\":%lu}%s",
+                   t->completed, t->missed,
+                   t->completed ? (double)t->response_total / (double)t->completed : 0.0,
+                   t->response_max, (i + 1 == sched->ntasks) ? "" : ",");
+        }
+        printf("]}");
+    }
+
+    /* SJF/SRTF on estimated bursts: estimate quality and what it cost */
+    if (sched->predict != PREDICT_EXACT) {
+        printf(",\"prediction\":{\"mode\":\"%s\",\"alpha\":%.3f,\"tau0\":%.1f,\"bursts\":%lu,"
+               "\"mean_abs_error\":%.3f,\"bias\":%.3f,\"inversions\":%lu,\"inversion_ticks\":%lu}",
+               predict_mode_name(sched->predict), sched->alpha, sched->tau0, sched->predictions,
+               sched->predictions ? (double)sched->predict_abs_error / (double)sched->predictions : 0.0,
+               sched->predictions ? (double)sched->predict_bias / (double)sched->predictions : 0.0,
+               sched->inversions, sched->inversion_ticks);
+    }
+    printf("}\n");
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile_d(const double *sorted, size_t n, double pct) {
+    if (!n) return 0.0;
+    size_t rank = (size_t)ceil(pct / 100.0 * (double)n);
+    if (rank < 1) rank = 1;
+    return sorted[rank - 1];
+}
+
+/* Cluster runs: aggregates only, traces have too many jobs to list them */
+static void print_cluster_summary(cluster_t *c, const cluster_source_t *src, const char *algo_name, long injected) {
+    size_t n = c->nrec;
+    unsigned long makespan = c->jobs ? c->last_end - c->first_submit : 0;
+    double cpu_ticks = (double)makespan * (double)c->nodes * (double)c->node_cpus;
+    unsigned long long wait_total = 0;
+    double bsld_total = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        wait_total += c->waits[i];
+        bsld_total += c->bsld[i];
+    }
+    double avg_wait = n ? (double)wait_total / (double)n : 0.0;
+    double avg_turn = n ? (double)(wait_total + c->run_total) / (double)n : 0.0;
+
+    /* batch jobs answer when they start */
+    printf("{\"algorithm\":\"%s\",\"injected\":%ld,\"ticks\":%lu,\"context_switches\":0,"
+           "\"averages\":{\"waiting_time\":%.3f,\"turnaround_time\":%.3f,\"response_time\":%.3f},\"throughput\":%.6f",
+           algo_name, injected, c->last_end, avg_wait, avg_turn, avg_wait,
+           makespan ? (double)c->jobs / (double)makespan : 0.0);
+
+    double node_min = 0.0, node_max = 0.0, node_sum = 0.0;
+    for (int i = 0; i < c->nodes; ++i) {
+        double u = makespan ? (double)c->node[i]->busy_ticks / ((double)makespan * (double)c->node_cpus) : 0.0;
+        if (i == 0 || u < node_min) node_min = u;
+        if (i == 0 || u > node_max) node_max = u;
+        node_sum += u;
+    }
+    printf(",\"cluster\":{\"nodes\":%d,\"node_cpus\":%d,\"allocation\":\"%s\",\"backfill\":%s,\"backfill_depth\":%d,"
+           "\"jobs\":%lu,\"backfilled\":%lu,\"killed\":%lu,\"skipped\":{\"invalid\":%lu,\"too_wide\":%lu},"
+           "\"late_submits\":%lu,\"makespan\":%lu,\"utilization\":%.4f,\"allocated\":%.4f,"
+           "\"node_utilization\":{\"min\":%.4f,\"avg\":%.4f,\"max\":%.4f},\"queue_peak\":%d",
+           c->nodes, c->node_cpus, cluster_alloc_name(c->alloc), c->backfill ? "true" : "false", c->backfill_depth,
+           c->jobs, c->backfilled, src->truncated, src->invalid, c->too_wide, c->late, makespan,
+           cpu_ticks > 0 ? (double)c->used_ticks / cpu_ticks : 0.0,
+           cpu_ticks > 0 ? (double)c->held_ticks / cpu_ticks : 0.0,
+           node_min, c->nodes ? node_sum / (double)c->nodes : 0.0, node_max, c->queue_peak);
+
+    if (n) {
+        qsort(c->waits, n, sizeof(unsigned int), cmp_uint);
+        qsort(c->bsld, n, sizeof(double), cmp_double);
+    }
+    printf(",\"queue_wait\":{\"avg\":%.3f,\"p50\":%u,\"p95\":%u,\"p99\":%u,\"max\":%u}",
+           avg_wait, percentile(c->waits, n, 50), percentile(c->waits, n, 95), percentile(c->waits, n, 99),
+           n ? c->waits[n - 1] : 0);
+    printf(",\"bounded_slowdown\":{\"tau\":%lu,\"avg\":%.3f,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f}}}\n",
+           c->tau, n ? bsld_total / (double)n : 0.0, percentile_d(c->bsld, n, 50), percentile_d(c->bsld, n, 95),
+           percentile_d(c->bsld, n, 99), n ? c->bsld[n - 1] : 0.0);
+}
+
+/* Cluster mode, see cluster.h: the jobs of an SWF trace, or of the workload,
+ * on nodes sized by the options or the trace's header */
+static int run_cluster(sched_algo_t algo, const char *algo_name, const run_opts_t *o,
+                       const char *swf_file, const char *json_file) {
+    if (algo != ALG_FCFS && algo != ALG_EASY) {
+        fprintf(stderr, "Warning: cluster mode queues jobs FCFS (easy adds backfilling), running %s as fcfs\n", algo_name);
+        algo = ALG_FCFS;
+        algo_name = "fcfs";
+    }
+
+    cluster_source_t src;
+    if (swf_file) {
+        if (cluster_open_swf(&src, swf_file) < 0) {
+            fprintf(stderr, "Error: Cannot open trace file: %s\n", swf_file);
+            return 1;
+        }
+    } else if (json_file) {
+        process_t **jobs = NULL;
+        int njobs = 0, ntasks = 0;
+        periodic_task_t *tasks = NULL;
+        lock_table_t locks;
+        lock_init(&locks);
+        if (parse_workload_json(json_file, &jobs, &njobs, &tasks, &ntasks, NULL, NULL, &locks) < 0) {
+            fprintf(stderr, "Failed to parse workload JSON\n");
+            return 1;
+        }
+        if (ntasks) fprintf(stderr, "Warning: cluster mode runs batch jobs, ignoring %d periodic tasks\n", ntasks);
+        free(tasks);
+        free(locks.v);
+        /* a batch job holds its CPUs from start to finish */
+        int ignored = 0;
+        for (int i = 0; i < njobs; ++i) ignored += jobs[i]->ncs || jobs[i]->nafter || jobs[i]->nforks;
+        if (ignored) fprintf(stderr, "Warning: cluster mode ignores the locks, dependencies and forks of %d jobs\n", ignored);
+        int rc = cluster_use_processes(&src, jobs, njobs);
+        free(jobs);
+        if (rc < 0) {
+            cluster_close(&src);
+            fprintf(stderr, "Error: out of memory loading workload\n");
+            return 1;
+        }
+    } else {
+        fprintf(stderr, "Error: cluster mode needs a workload or an SWF trace\n");
+        return 1;
+    }
+
+    /* the trace's header sizes the machine unless --nodes does */
+    int nodes = o->nodes, node_cpus = o->node_cpus;
+    if (!nodes && src.max_procs > 0) {
+        if (!node_cpus && src.max_nodes > 0 && src.max_procs % src.max_nodes == 0)
+            node_cpus = src.max_procs / src.max_nodes;
+        if (!node_cpus) node_cpus = 1;
+        nodes = (src.max_procs + node_cpus - 1) / node_cpus;
+    }
+    if (!nodes) nodes = 1;
+    if (!node_cpus) node_cpus = 1;
+    if ((long long)nodes * node_cpus > INT_MAX) {
+        fprintf(stderr, "Error: %d nodes of %d CPUs is too many CPUs\n", nodes, node_cpus);
+        cluster_close(&src);
+        return 1;
+    }
+
+    cluster_t *c = cluster_create(algo, nodes, node_cpus);
+    if (!c) {
+        fprintf(stderr, "Failed to create scheduler\n");
+        cluster_close(&src);
+        return 1;
+    }
+    c->alloc = o->alloc;
+    c->backfill_depth = o->backfill_depth;
+    c->tau = o->bsld_tau;
+    for (int i = 0; i < nodes; ++i) c->node[i]->quiet = o->quiet;
+    fprintf(stderr, "Simulating %d nodes of %d CPUs (%s allocation)\n", nodes, node_cpus, cluster_alloc_name(c->alloc));
+
+    long injected = cluster_run(c, &src);
+    if (injected < 0) {
+        fprintf(stderr, "Error: out of memory running the cluster\n");
+        cluster_close(&src);
+        cluster_destroy(c);
+        return 1;
+    }
+    if (src.invalid) fprintf(stderr, "Warning: skipped %lu trace lines without CPUs or a run time\n", src.invalid);
+    if (c->too_wide) fprintf(stderr, "Warning: skipped %lu jobs wider than the cluster\n", c->too_wide);
+    print_cluster_summary(c, &src, algo_name, injected);
+    cluster_close(&src);
+    cluster_destroy(c);
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
     const char *algo_arg = (argc >= 2) ? argv[1] : "fcfs";
     sched_algo_t algo = parse_algo(algo_arg);
 
+    run_opts_t opts;
+    parse_options(argc, argv, &opts);
+
+    /* HFS: the workload names the groups; every CPU gets a copy */
+    group_tree_t groups;
+    group_init(&groups);
+    groups.policy = opts.group_policy;
+    groups.slice = opts.group_slice;
+    group_lookup(&groups, "", 1);
+
+    /* critical sections: the workload names the resources */
+    lock_table_t locks;
+    lock_init(&locks);
+    if (opts.lock_protocol != LOCK_NONE && algo != ALG_PRIORITY && algo != ALG_PRIORITY_P) {
+        fprintf(stderr, "Warning: --lock-protocol only applies to priority and priority_p, ignoring it\n");
+        opts.lock_protocol = LOCK_NONE;
+    }
+    if (opts.migration_cost && algo == ALG_GANG) {
+        fprintf(stderr, "Warning: gang pins every thread to its CPU, ignoring --migration-cost\n");
+        opts.migration_cost = 0;
+    }
+
     /* Load processes from JSON file if provided */
-    process_t *pending[MAX_PROCESSES];
+    process_t **pending = NULL;
     int pending_count = 0;
+    periodic_task_t *tasks = NULL;
+    int ntasks = 0;
     
     /* Find JSON file in arguments - last arg should be the file path */
     const char *json_file = NULL;
@@ -163,72 +1331,235 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    /* batch jobs on a cluster: an SWF trace, easy or --nodes */
+    const char *swf_file = NULL;
+    for (int i = argc - 1; i >= 2; i--) {
+        size_t len = strlen(argv[i]);
+        if (len > 4 && strcmp(argv[i] + len - 4, ".swf") == 0) {
+            swf_file = argv[i];
+            break;
+        }
+    }
+    if (swf_file || algo == ALG_EASY || opts.nodes > 0) {
+        free(groups.v);
+        if (opts.dvfs_on) fprintf(stderr, "Warning: cluster mode does not model frequency scaling, ignoring it\n");
+        if (opts.mem.capacity) fprintf(stderr, "Warning: cluster mode does not model memory, ignoring --memory\n");
+        if (opts.admit.on) fprintf(stderr, "Warning: cluster mode queues every job, ignoring admission control\n");
+        return run_cluster(algo, algo_arg, &opts, swf_file, json_file);
+    }
+
     if (json_file) {
-        if (parse_workload_json(json_file, pending, &pending_count) < 0) {
+        if (parse_workload_json(json_file, &pending, &pending_count, &tasks, &ntasks,
+                                algo == ALG_MLQ ? &opts.mlq : NULL, algo == ALG_HFS ? &groups : NULL, &locks) < 0) {
             fprintf(stderr, "Failed to parse workload JSON\n");
             return 1;
         }
     } else {
         /* Fallback to hardcoded processes if no JSON file */
         fprintf(stderr, "No JSON file provided, using default workload\n");
+        pending = (process_t **)calloc(3, sizeof(process_t *));
+        if (!pending) return 1;
         pending[0] = process_create(0, 0, 5, 1);
         pending[1] = process_create(1, 2, 3, 3);
         pending[2] = process_create(2, 4, 2, 2);
         pending_count = 3;
     }
 
-    if (pending_count == 0) {
+    if (pending_count == 0 && ntasks == 0) {
         fprintf(stderr, "Error: No processes to schedule\n");
         return 1;
     }
 
-    scheduler_t *sched = scheduler_create(algo);
-    if (!sched) {
-        fprintf(stderr, "Failed to create scheduler\n");
+    /* forked children take the pids after the workload's, in workload order */
+    int next_pid = 0;
+    for (int i = 0; i < pending_count; ++i) if (pending[i]->pid >= next_pid) next_pid = pending[i]->pid + 1;
+    for (int i = 0; i < ntasks; ++i) if (tasks[i].pid >= next_pid) next_pid = tasks[i].pid + 1;
+    for (int i = 0; i < pending_count; ++i) {
+        for (int k = 0; k < pending[i]->nforks; ++k) {
+            pending[i]->forks[k].first_pid = next_pid;
+            next_pid += pending[i]->forks[k].count;
+        }
+    }
+
+    /* parallel jobs: only gang runs a job on several CPUs at once, and it has
+     * no forks (see gang.h) */
+    int wide = 0, forking = 0;
+    for (int i = 0; i < pending_count; ++i) {
+        process_t *q = pending[i];
+        if (algo != ALG_GANG && q->width > 1) {
+            q->width = 1;
+            wide++;
+        }
+        if (algo == ALG_GANG && q->width > opts.cpus) {
+            fprintf(stderr, "Warning: pid %d: needs %d CPUs, running it on %d\n", q->pid, q->width, opts.cpus);
+            q->width = opts.cpus;
+        }
+        if (algo == ALG_GANG && q->nforks) {
+            process_set_forks(q, NULL, 0);
+            forking++;
+        }
+    }
+    if (wide) fprintf(stderr, "Warning: only gang co-schedules jobs on several CPUs, giving %d jobs one CPU each\n", wide);
+    if (forking) fprintf(stderr, "Warning: gang does not model forks, ignoring those of %d jobs\n", forking);
+
+    /* job dependencies, see dag.h: CPF ranks by critical path even without any */
+    dag_t dag;
+    memset(&dag, 0, sizeof(dag));
+    int deps = (algo == ALG_CPF);
+    for (int i = 0; i < pending_count && !deps; ++i) deps = pending[i]->nafter > 0;
+    if (deps && dag_build(&dag, pending, pending_count) < 0) {
+        fprintf(stderr, "Error: out of memory building job dependencies\n");
         return 1;
     }
 
-    /* Set quantum for RR - check for numeric argument before JSON file */
-    if (algo == ALG_RR && argc >= 3) {
+    /* jobs run in leaf groups only, see group.h */
+    if (algo == ALG_HFS) {
+        for (int i = 0; i < pending_count; ++i) {
+            int leaf = group_leaf(&groups, pending[i]->group < 0 ? 0 : pending[i]->group);
+            pending[i]->group = leaf < 0 ? 0 : leaf;
+        }
+        if (opts.cpu_max && group_apply_max(&groups, opts.cpu_max) < 0)
+            fprintf(stderr, "Warning: invalid --cpu-max spec %s, ignoring the rest of it\n", opts.cpu_max);
+        opts.groups = &groups;
+    }
+
+    /* periodic tasks: schedulability under rate-monotonic priorities comes
+     * first, then releases run to the horizon (by default one hyperperiod
+     * after the last offset) */
+    periodic_analysis_t analysis;
+    unsigned long horizon = 0;
+    if (ntasks) {
+        periodic_analyze(tasks, (size_t)ntasks, &analysis);
+        fprintf(stderr, "RM analysis: U=%.4f, Liu-Layland bound %.4f (%s), response-time analysis: %s\n",
+                analysis.utilization, analysis.ll_bound, periodic_ll_verdict(&analysis),
+                analysis.rta_schedulable ? "all deadlines met" : "deadlines can be missed");
+        horizon = opts.horizon;
+        if (!horizon) {
+            if (!analysis.hyperperiod)
+                fprintf(stderr, "Warning: hyperperiod above %lu ticks, releasing jobs for %lu ticks only\n",
+                        PERIODIC_HORIZON_MAX, PERIODIC_HORIZON_MAX);
+            horizon = analysis.max_offset + (analysis.hyperperiod ? (unsigned long)analysis.hyperperiod : PERIODIC_HORIZON_MAX);
+        }
+        if (horizon > 2 * PERIODIC_HORIZON_MAX) horizon = 2 * PERIODIC_HORIZON_MAX;
+    }
+
+    /* Quantum for RR, lottery and stride (gang: the slice of a row) - numeric argument before JSON file */
+    unsigned long quantum = 0;
+    if ((algo == ALG_RR || algo == ALG_LOTTERY || algo == ALG_STRIDE || algo == ALG_GANG) && argc >= 3) {
         for (int i = 2; i < argc; i++) {
-            if (!strstr(argv[i], ".json")) {
+            if (!strstr(argv[i], ".json") && strncmp(argv[i], "--", 2) != 0) {
                 unsigned long q = strtoul(argv[i], NULL, 10);
                 if (q > 0) {
-                    sched->quantum = q;
-                    fprintf(stderr, "Using quantum = %lu\n", sched->quantum);
+                    quantum = q;
+                    fprintf(stderr, "Using quantum = %lu\n", quantum);
                     break;
                 }
             }
         }
     }
 
-    int injected = 0;
-    int original_count = pending_count;
+    /* gang: a matrix over the CPUs of the multi-CPU model, even just one */
+    gang_t gang;
+    gang_init(&gang);
+    gang.mode = opts.cosched;
+    gang.max_rows = opts.gang_rows;
+    if (quantum) gang.slice = quantum;
 
-    /* Main scheduling loop */
-    while (pending_count > 0 || sched->ready_head != NULL || sched->running != NULL) {
-        /* Inject arriving processes */
-        for (int i = 0; i < original_count; ++i) {
-            process_t *p = pending[i];
-            if (p && p->arrival <= sched->current_tick) {
-                char info[128];
-                snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%u", p->pid, p->arrival);
-                char *ev = utils_build_event(EVT_JOB_RESUMED, sched, p, info);
-                utils_emit_event_and_free(ev, EVT_JOB_RESUMED, sched);
+    if (opts.cpus > 1 || algo == ALG_GANG) {
+        smp_t *smp = smp_create(algo, opts.cpus, opts.threads);
+        if (!smp) {
+            fprintf(stderr, "Failed to create scheduler\n");
+            return 1;
+        }
+        smp->placement = opts.placement;
+        smp->migrate_up = opts.migrate_up;
+        smp->window = opts.window > UINT_MAX ? UINT_MAX : opts.window;   // arrivals are 32-bit ticks
+        long listed = opts.speeds ? smp_set_speeds(smp, opts.speeds) : 0;
+        if (listed < 0) {
+            fprintf(stderr, "Error: invalid --speeds spec: %s\n", opts.speeds);
+            smp_destroy(smp);
+            return 1;
+        }
+        if (listed > smp->ncpus)
+            fprintf(stderr, "Warning: --speeds lists %ld CPUs but there are %d, ignoring the rest\n", listed, smp->ncpus);
+        for (int i = 0; i < smp->ncpus; ++i) apply_cpu_options(smp->cpus[i], &opts, quantum);
+        if (opts.dvfs_on) for (int i = 0; i < smp->ncpus; ++i) dvfs_attach(smp->cpus[i], &opts.dvfs);
+        free(groups.v);
+        fprintf(stderr, "Simulating %d CPUs on %d host threads\n", smp->ncpus, smp->nthreads);
+        if (ntasks) fprintf(stderr, "Warning: periodic tasks need a single CPU, ignoring %d of them\n", ntasks);
+        if (opts.mem.capacity) fprintf(stderr, "Warning: the memory model needs a single CPU, ignoring --memory\n");
+        if (opts.admit.on) fprintf(stderr, "Warning: admission control needs a single CPU, ignoring it\n");
+        free(tasks);
+        if (locks.n) {
+            fprintf(stderr, "Warning: critical sections need a single CPU, ignoring them\n");
+            for (int i = 0; i < pending_count; ++i) process_set_sections(pending[i], NULL, 0);
+        }
+        free(locks.v);
+        if (deps) smp->dag = &dag;
+        if (algo == ALG_GANG) smp->gang = &gang;
 
-                scheduler_add_process(sched, p);
-                pending[i] = NULL;
-                pending_count--;
-                injected++;
-            }
+        int injected = smp_run(smp, pending, pending_count);
+        free(pending);
+
+        scheduler_t *summary = smp_collect(smp);
+        if (summary) summary->dag = smp->dag;
+        print_metrics_summary(summary, algo_arg, injected, smp);
+        scheduler_destroy(summary);
+        smp_destroy(smp);
+        dag_free(&dag);
+        return 0;
+    }
+
+    scheduler_t *sched = scheduler_create(algo);
+    if (!sched) {
+        fprintf(stderr, "Failed to create scheduler\n");
+        return 1;
+    }
+    apply_cpu_options(sched, &opts, quantum);
+    free(groups.v);
+    sched->locks = locks;
+    sched->locks.protocol = opts.lock_protocol;
+    if (deps) sched->dag = &dag;
+    if (opts.speeds) {
+        unsigned int speed = sched->speed;
+        long listed = smp_parse_speeds(opts.speeds, &speed, 1);
+        if (listed < 0) {
+            fprintf(stderr, "Error: invalid --speeds spec: %s\n", opts.speeds);
+            scheduler_destroy(sched);
+            return 1;
         }
+        if (listed > 1)
+            fprintf(stderr, "Warning: --speeds lists %ld CPUs but there is 1, ignoring the rest\n", listed);
+        sched->speed = speed;
+    }
+    if (opts.dvfs_on) dvfs_attach(sched, &opts.dvfs);
+    if (opts.mem.capacity) sched->mem = opts.mem;
+    if (opts.admit.on) sched->admit = opts.admit;
 
-        scheduler_tick(sched);
+    /* arrivals are timers on the scheduler's wheel */
+    int injected = pending_count;
+    for (int i = 0; i < pending_count; ++i) scheduler_schedule_arrival(sched, pending[i]);
+    if (ntasks) {
+        periodic_start(sched, tasks, (size_t)ntasks, horizon);
+        sched->analysis = analysis;
+    }
+    scheduler_fire_timers(sched);
+
+    /* Main scheduling loop */
+    while (sched->pending_arrivals > 0 || !scheduler_idle(sched)) {
+        /* without an event stream, idle gaps are skipped rather than ticked,
+         * and so are uneventful busy stretches where the policy allows */
+        if (opts.quiet && scheduler_idle(sched)) scheduler_skip_idle(sched, ULONG_MAX);
+        else if (!opts.quiet || !scheduler_fast_forward(sched)) scheduler_tick(sched);
     }
+    free(pending);
+    for (size_t i = 0; i < sched->ntasks; ++i) injected += (int)sched->tasks[i].released;
+    injected += (int)sched->forked;
 
     /* Print metrics summary as JSON (single-line for proper JSON parsing) */
-    print_metrics_summary(sched, algo_arg, injected);
+    print_metrics_summary(sched, algo_arg, injected, NULL);
 
     scheduler_destroy(sched);
+    dag_free(&dag);
     return 0;
 }
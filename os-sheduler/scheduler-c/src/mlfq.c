@@ -124,23 +124,17 @@ void mlfq_tick(scheduler_t *s) {
     }
 
     if (s->running) {
-        if (s->running->remaining > 0) s->running->remaining -= 1;
-        if (s->running->quantum_left > 0) s->running->quantum_left -= 1;
+        /* the slice timer zeroes quantum_left; stall ticks do not use up the slice */
+        scheduler_consume(s, s->running);
 
         char info[256];
         snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"mlfq_level\":%d, \"quantum_left\":%d",
-                 s->running->pid, s->running->remaining, s->running->mlfq_level, s->running->quantum_left);
+                 s->running->pid, s->running->remaining, s->running->mlfq_level, scheduler_slice_left(s, s->running));
         char *ev = utils_build_event(EVT_GANTT_SLICE, s, s->running, info);
         utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
 
         if (s->running->remaining <= 0) {
-            s->running->state = PROC_TERMINATED;
-            s->running->finish_time = s->current_tick;
-            ev = utils_build_event(EVT_JOB_FINISHED, s, s->running, NULL);
-            utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
-            scheduler_record_completed(s, s->running);
-            process_free(s->running);
-            s->running = NULL;
+            scheduler_finish_burst(s);
         } else if (s->running->quantum_left <= 0) {
             if (s->running->mlfq_level < LEVELS - 1) s->running->mlfq_level += 1;
             char info_pre[128];
@@ -0,0 +1,339 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "../include/mlq.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+/* ---- class list parsing ---- */
+
+int mlq_parse_policy(const char *s, size_t len, mlq_class_t *c) {
+    static const struct { const char *name; mlq_policy_t policy; } names[] = {
+        {"fcfs", MLQ_FCFS}, {"sjf", MLQ_SJF}, {"srtf", MLQ_SRTF},
+        {"priority", MLQ_PRIORITY}, {"priority_p", MLQ_PRIORITY_P},
+    };
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i) {
+        if (strlen(names[i].name) == len && strncmp(s, names[i].name, len) == 0) {
+            c->policy = names[i].policy;
+            return 0;
+        }
+    }
+    if (len > 2 && strncmp(s, "rr", 2) == 0) {
+        char *end;
+        long q = strtol(s + 2, &end, 10);
+        if (end != s + len || q < 1 || q > INT_MAX) return -1;
+        c->policy = MLQ_RR;
+        c->quantum = (int)q;
+        return 0;
+    }
+    return -1;
+}
+
+/* "lo..hi", "lo..", "..hi" or a single priority */
+static int parse_range(const char *s, size_t len, mlq_class_t *c) {
+    char buf[64];
+    if (len >= sizeof(buf)) return -1;
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+    char *dots = strstr(buf, "..");
+    char *end;
+    if (!dots) {
+        long v = strtol(buf, &end, 10);
+        if (end == buf || *end) return -1;
+        c->lo = c->hi = (int)v;
+        return 0;
+    }
+    *dots = '\0';
+    c->lo = INT_MIN;
+    c->hi = INT_MAX;
+    if (buf[0]) {
+        c->lo = (int)strtol(buf, &end, 10);
+        if (*end) return -1;
+    }
+    if (dots[2]) {
+        c->hi = (int)strtol(dots + 2, &end, 10);
+        if (*end) return -1;
+    }
+    return 0;
+}
+
+int mlq_parse(const char *spec, mlq_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->arbiter = MLQ_STRICT;
+    const char *p = spec;
+    while (p && *p) {
+        if (m->n == MLQ_MAX_CLASSES) return -1;
+        const char *end = strchr(p, ',');
+        if (!end) end = p + strlen(p);
+        mlq_class_t *c = &m->classes[m->n];
+        c->lo = 1;
+        c->hi = 0;
+        c->share = 10;
+
+        const char *field[4] = {0};
+        size_t flen[4] = {0};
+        int nf = 0;
+        for (const char *f = p; f <= end && nf < 4;) {
+            const char *colon = memchr(f, ':', (size_t)(end - f));
+            const char *stop = colon ? colon : end;
+            field[nf] = f;
+            flen[nf++] = (size_t)(stop - f);
+            if (!colon) break;
+            f = colon + 1;
+        }
+        if (nf < 2 || flen[0] == 0 || flen[0] >= sizeof(c->name)) return -1;
+        memcpy(c->name, field[0], flen[0]);
+        c->name[flen[0]] = '\0';
+        if (mlq_find(m, c->name) >= 0) return -1;
+        if (mlq_parse_policy(field[1], flen[1], c) < 0) return -1;
+        if (nf > 2 && flen[2] && parse_range(field[2], flen[2], c) < 0) return -1;
+        if (nf > 3 && flen[3]) {
+            char *e;
+            long share = strtol(field[3], &e, 10);
+            if (e != field[3] + flen[3] || share < 1) return -1;
+            c->share = (unsigned long)share;
+        }
+        m->n++;
+        p = *end ? end + 1 : end;
+    }
+    if (!m->n) return -1;
+    m->turn = 0;
+    m->budget = m->classes[0].share;
+    return 0;
+}
+
+const char *mlq_arbiter_name(mlq_arbiter_t a) {
+    return a == MLQ_SLICE ? "slice" : "strict";
+}
+
+int mlq_parse_arbiter(const char *name) {
+    if (strcmp(name, "strict") == 0) return MLQ_STRICT;
+    if (strcmp(name, "slice") == 0) return MLQ_SLICE;
+    return -1;
+}
+
+const char *mlq_policy_name(const mlq_class_t *c) {
+    switch (c->policy) {
+        case MLQ_FCFS: return "fcfs";
+        case MLQ_SJF: return "sjf";
+        case MLQ_SRTF: return "srtf";
+        case MLQ_PRIORITY: return "priority";
+        case MLQ_PRIORITY_P: return "priority_p";
+        case MLQ_RR: return "rr";
+        default: return "?";
+    }
+}
+
+int mlq_find(const mlq_t *m, const char *name) {
+    for (int i = 0; i < m->n; ++i) {
+        if (strcmp(m->classes[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/* ---- class queues ---- */
+
+static mlq_class_t *class_of(mlq_t *m, process_t *p) {
+    if (p->mlq_class < 0 || p->mlq_class >= m->n) {
+        int c = m->n - 1;
+        for (int i = 0; i < m->n; ++i) {
+            if (m->classes[i].lo <= p->priority && p->priority <= m->classes[i].hi) {
+                c = i;
+                break;
+            }
+        }
+        p->mlq_class = c;
+    }
+    return &m->classes[p->mlq_class];
+}
+
+void mlq_enqueue(mlq_class_t *c, process_t *p, int at_head) {
+    if (at_head || !c->head) {
+        p->next = c->head;
+        c->head = p;
+    } else {
+        process_t *cur = c->head;
+        while (cur->next) cur = cur->next;
+        cur->next = p;
+        p->next = NULL;
+    }
+    c->queued++;
+}
+
+/* a should run before b under c's policy (FCFS and RR keep queue order) */
+static int better(const mlq_class_t *c, const process_t *a, const process_t *b) {
+    switch (c->policy) {
+        case MLQ_SJF: return a->burst < b->burst;
+        case MLQ_SRTF:
+            if (a->remaining != b->remaining) return a->remaining < b->remaining;
+            if (a->arrival != b->arrival) return a->arrival < b->arrival;
+            return a->pid < b->pid;
+        case MLQ_PRIORITY:
+        case MLQ_PRIORITY_P:
+            if (a->priority != b->priority) return a->priority < b->priority;
+            if (a->arrival != b->arrival) return a->arrival < b->arrival;
+            return a->pid < b->pid;
+        default: return 0;
+    }
+}
+
+int mlq_preempts(const mlq_class_t *c, const process_t *a, const process_t *b) {
+    if (c->policy == MLQ_SRTF) return a->remaining < b->remaining;
+    if (c->policy == MLQ_PRIORITY_P) return a->priority < b->priority;
+    return 0;
+}
+
+/* The process c's policy would run next, or NULL; *prev_out is its predecessor */
+static process_t *best(const mlq_class_t *c, process_t **prev_out) {
+    process_t *best = c->head, *best_prev = NULL;
+    for (process_t *prev = c->head, *cur = c->head ? c->head->next : NULL; cur; prev = cur, cur = cur->next) {
+        if (better(c, cur, best)) {
+            best = cur;
+            best_prev = prev;
+        }
+    }
+    if (prev_out) *prev_out = best_prev;
+    return best;
+}
+
+process_t *mlq_peek(const mlq_class_t *c) {
+    return best(c, NULL);
+}
+
+process_t *mlq_take(scheduler_t *s, mlq_class_t *c) {
+    process_t *prev, *p = best(c, &prev);
+    if (!p) return NULL;
+    if (prev) prev->next = p->next;
+    else c->head = p->next;
+    p->next = NULL;
+    c->queued--;
+    return scheduler_take(s, p);
+}
+
+static void push(mlq_t *m, mlq_class_t *c, process_t *p, int at_head) {
+    mlq_enqueue(c, p, at_head);
+    m->queued++;
+}
+
+static process_t *take(scheduler_t *s, mlq_class_t *c) {
+    process_t *p = mlq_take(s, c);
+    if (p) s->mlq.queued--;
+    return p;
+}
+
+/* ---- arbitration and dispatch ---- */
+
+static int has_work(const scheduler_t *s, int i) {
+    return s->mlq.classes[i].queued || (s->running && s->running->mlq_class == i);
+}
+
+/* The class that gets the CPU this tick, -1 if none has work */
+static int choose_class(scheduler_t *s) {
+    mlq_t *m = &s->mlq;
+    if (m->arbiter == MLQ_STRICT) {
+        for (int i = 0; i < m->n; ++i) {
+            if (has_work(s, i)) return i;
+        }
+        return -1;
+    }
+    if (m->budget && has_work(s, m->turn)) return m->turn;
+    /* turn over: the next class with work, the current one last */
+    for (int k = 1; k <= m->n; ++k) {
+        int i = (m->turn + k) % m->n;
+        if (has_work(s, i)) {
+            m->turn = i;
+            m->budget = m->classes[i].share;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void dispatch(scheduler_t *s, process_t *p) {
+    const mlq_class_t *c = &s->mlq.classes[p->mlq_class];
+    p->quantum_left = c->policy == MLQ_RR ? c->quantum : 0;
+    scheduler_dispatch(s, p);
+}
+
+/* Put s->running back in its class queue, at the head if it only gave way
+ * to another class (so it keeps its place in its own) */
+static void preempt(scheduler_t *s, const char *reason, int to_head) {
+    process_t *cur = s->running;
+    mlq_class_t *c = &s->mlq.classes[cur->mlq_class];
+    char info[128];
+    snprintf(info, sizeof(info), "\"reason\":\"%s\", \"class\":\"%s\"", reason, c->name);
+    char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, cur, info);
+    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, s);
+
+    s->running = NULL;
+    cur->state = PROC_READY;
+    cur->last_enqueued_tick = (unsigned int)s->current_tick;
+    push(&s->mlq, c, cur, to_head);
+}
+
+void mlq_tick(scheduler_t *s) {
+    if (!s) return;
+    mlq_t *m = &s->mlq;
+
+    while (s->ready_head) {
+        process_t *p = s->ready_head;
+        s->ready_head = p->next;
+        push(m, class_of(m, p), p, 0);
+    }
+
+    int want = choose_class(s);
+    if (s->running && s->running->mlq_class != want)
+        preempt(s, m->arbiter == MLQ_STRICT ? "class" : "class_slice", 1);
+
+    if (s->running) {
+        /* the preemptive class policies */
+        mlq_class_t *c = &m->classes[s->running->mlq_class];
+        if (c->policy == MLQ_SRTF || c->policy == MLQ_PRIORITY_P) {
+            process_t *top = mlq_peek(c);
+            if (top && mlq_preempts(c, top, s->running)) {
+                preempt(s, c->policy == MLQ_SRTF ? "srtf" : "priority", 0);
+                dispatch(s, take(s, c));
+            }
+        }
+    }
+    if (!s->running && want >= 0) dispatch(s, take(s, &m->classes[want]));
+
+    if (s->running) {
+        process_t *cur = s->running;
+        mlq_class_t *c = &m->classes[cur->mlq_class];
+        int ran = scheduler_consume(s, cur);
+        c->cpu_ticks++;
+        /* the class holds the CPU through a stall, but its turn is for work */
+        if (ran && m->arbiter == MLQ_SLICE && m->budget) m->budget--;
+
+        char info[160];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d, \"class\":\"%s\"",
+                 cur->pid, cur->remaining, c->name);
+        char *ev = utils_build_event(EVT_GANTT_SLICE, s, cur, info);
+        utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
+
+        if (cur->remaining <= 0) {
+            scheduler_finish_burst(s);
+        } else if (c->policy == MLQ_RR && cur->quantum_left <= 0) {
+            /* the slice timer zeroes quantum_left; stall ticks do not use up the slice */
+            preempt(s, "quantum", 0);
+            dispatch(s, take(s, c));
+        }
+    }
+}
+
+void mlq_clear(scheduler_t *s) {
+    if (!s) return;
+    for (int i = 0; i < s->mlq.n; ++i) {
+        process_t *cur = s->mlq.classes[i].head;
+        while (cur) {
+            process_t *n = cur->next;
+            process_free(cur);
+            cur = n;
+        }
+        s->mlq.classes[i].head = NULL;
+        s->mlq.classes[i].queued = 0;
+    }
+    s->mlq.queued = 0;
+}
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/paging.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+void paging_init(paging_t *m) {
+    memset(m, 0, sizeof(*m));
+    m->policy = SWAP_NONE;
+    m->fault_cost = PAGING_FAULT_COST_DEFAULT;
+    m->swap_rate = PAGING_SWAP_RATE_DEFAULT;
+}
+
+int paging_parse_policy(const char *name) {
+    if (strcmp(name, "none") == 0) return SWAP_NONE;
+    if (strcmp(name, "largest") == 0) return SWAP_LARGEST;
+    if (strcmp(name, "newest") == 0) return SWAP_NEWEST;
+    if (strcmp(name, "priority") == 0) return SWAP_PRIORITY;
+    return -1;
+}
+
+const char *paging_policy_name(swap_policy_t p) {
+    switch (p) {
+        case SWAP_LARGEST: return "largest";
+        case SWAP_NEWEST: return "newest";
+        case SWAP_PRIORITY: return "priority";
+        default: return "none";
+    }
+}
+
+void paging_arrive(scheduler_t *s, process_t *p) {
+    paging_t *m = &s->mem;
+    if (!p->working_set) return;
+    if (m->njobs == m->cap) {
+        int newcap = m->cap ? m->cap * 2 : 64;
+        process_t **v = (process_t **)realloc(m->jobs, (size_t)newcap * sizeof(process_t *));
+        if (!v) return;      // out of memory: the job goes untracked
+        m->jobs = v;
+        m->cap = newcap;
+    }
+    p->mem_slot = m->njobs;
+    m->jobs[m->njobs++] = p;
+    m->demand += p->working_set;
+    m->loaded++;
+    if (m->demand > m->demand_peak) m->demand_peak = m->demand;
+    if (m->loaded > m->loaded_peak) m->loaded_peak = m->loaded;
+}
+
+void paging_leave(scheduler_t *s, process_t *p) {
+    paging_t *m = &s->mem;
+    int i = p->mem_slot;
+    if (i < 0) return;
+    m->jobs[i] = m->jobs[--m->njobs];
+    m->jobs[i]->mem_slot = i;
+    p->mem_slot = -1;
+    if (!p->swapped) {
+        m->demand -= p->working_set;
+        m->loaded--;
+        return;
+    }
+    /* only a job swapped out while it ran its last tick gets here */
+    for (int k = 0; k < m->nout; ++k) {
+        int at = (m->out_head + k) % m->out_cap;
+        if (m->out[at] != p) continue;
+        for (; k + 1 < m->nout; ++k) {
+            int next = (m->out_head + k + 1) % m->out_cap;
+            m->out[(m->out_head + k) % m->out_cap] = m->out[next];
+        }
+        m->nout--;
+        break;
+    }
+    p->swapped = 0;
+}
+
+int paging_stall(scheduler_t *s, process_t *p) {
+    paging_t *m = &s->mem;
+    if (p->mem_slot < 0) return 0;
+    if (p->swapped) {
+        m->fault_ticks++;
+        p->fault_ticks++;
+        return 1;
+    }
+    if (p->swap_left > 0) {
+        p->swap_left--;
+        m->swap_ticks++;
+        p->fault_ticks++;
+        return 1;
+    }
+    if (m->demand <= m->capacity) return 0;
+    if (p->fault_debt >= 1.0) {
+        p->fault_debt -= 1.0;
+        m->fault_ticks++;
+        p->fault_ticks++;
+        return 1;
+    }
+    p->fault_debt += m->fault_cost * (1.0 - (double)m->capacity / (double)m->demand);
+    return 0;
+}
+
+/* q is a better victim than best under the policy */
+static int worse(swap_policy_t policy, const process_t *q, const process_t *best) {
+    if (policy == SWAP_LARGEST && q->working_set != best->working_set) return q->working_set > best->working_set;
+    if (policy == SWAP_PRIORITY && q->priority != best->priority) return q->priority > best->priority;
+    if (q->arrival != best->arrival) return q->arrival > best->arrival;
+    return q->pid > best->pid;
+}
+
+static process_t *pick_victim(scheduler_t *s) {
+    paging_t *m = &s->mem;
+    process_t *best = NULL;
+    for (int i = 0; i < m->njobs; ++i) {
+        process_t *q = m->jobs[i];
+        if (q->swapped || q == s->running || q->swap_left) continue;
+        if (!best || worse(m->policy, q, best)) best = q;
+    }
+    return best;
+}
+
+static int swap_out(paging_t *m, process_t *q) {
+    if (m->nout == m->out_cap) {
+        int newcap = m->out_cap ? m->out_cap * 2 : 16;
+        process_t **v = (process_t **)malloc((size_t)newcap * sizeof(process_t *));
+        if (!v) return -1;
+        for (int k = 0; k < m->nout; ++k) v[k] = m->out[(m->out_head + k) % m->out_cap];
+        free(m->out);
+        m->out = v;
+        m->out_head = 0;
+        m->out_cap = newcap;
+    }
+    m->out[(m->out_head + m->nout) % m->out_cap] = q;
+    m->nout++;
+    q->swapped = 1;
+    q->swap_outs++;
+    q->fault_debt = 0.0;
+    m->demand -= q->working_set;
+    m->loaded--;
+    m->swap_outs++;
+    m->pages_out += q->working_set;
+    return 0;
+}
+
+static void swap_in(scheduler_t *s, process_t *q) {
+    paging_t *m = &s->mem;
+    m->out_head = (m->out_head + 1) % m->out_cap;
+    m->nout--;
+    m->demand += q->working_set;
+    m->loaded++;
+    m->swap_ins++;
+    if (m->demand > m->capacity) m->forced_ins++;
+    if (m->demand > m->demand_peak) m->demand_peak = m->demand;
+    if (m->loaded > m->loaded_peak) m->loaded_peak = m->loaded;
+    /* a job that never ran has nothing on swap */
+    if (q->run_ticks && m->swap_rate) q->swap_left = (q->working_set + m->swap_rate - 1) / m->swap_rate;
+    int parked = q->swapped == 2;
+    q->swapped = 0;
+    if (!parked) return;
+
+    process_t **link = &m->parked;
+    while (*link != q) link = &(*link)->next;
+    *link = q->next;
+    q->next = NULL;
+    char info[64];
+    snprintf(info, sizeof(info), "\"reason\":\"swap_in\", \"working_set\":%lu", q->working_set);
+    char *ev = utils_build_event(EVT_JOB_RESUMED, s, q, info);
+    utils_emit_event_and_free(ev, EVT_JOB_RESUMED, s);
+    scheduler_add_process(s, q);
+}
+
+void paging_tick(scheduler_t *s) {
+    paging_t *m = &s->mem;
+    process_t *p = s->running;
+    if (p && p->swapped) {
+        scheduler_leave(s, p);
+        s->running = NULL;
+        p->state = PROC_WAITING;
+        p->swapped = 2;
+        char info[64];
+        snprintf(info, sizeof(info), "\"swapped\":%lu", p->working_set);
+        char *ev = utils_build_event(EVT_JOB_BLOCKED, s, p, info);
+        utils_emit_event_and_free(ev, EVT_JOB_BLOCKED, s);
+        p->next = m->parked;
+        m->parked = p;
+    }
+
+    while (m->policy != SWAP_NONE && m->demand > m->capacity && m->loaded > 1) {
+        process_t *q = pick_victim(s);
+        if (!q || swap_out(m, q) < 0) break;
+    }
+
+    while (m->nout) {
+        process_t *q = m->out[m->out_head];
+        int fits = m->demand + q->working_set <= m->capacity;
+        if (!fits && (scheduler_runnable(s) || s->io_head || s->io_active)) break;
+        swap_in(s, q);
+    }
+
+    m->loaded_sum += (unsigned long long)m->loaded;
+    if (m->demand > m->capacity) m->over_ticks++;
+}
+
+void paging_clear(scheduler_t *s) {
+    paging_t *m = &s->mem;
+    while (m->parked) {
+        process_t *n = m->parked->next;
+        process_free(m->parked);
+        m->parked = n;
+    }
+    free(m->jobs);
+    free(m->out);
+    m->jobs = NULL;
+    m->out = NULL;
+    m->njobs = m->cap = m->nout = m->out_cap = 0;
+}
@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "../include/periodic.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+static unsigned long long gcd(unsigned long long a, unsigned long long b) {
+    while (b) {
+        unsigned long long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* rate-monotonic order, as the simulation breaks ties */
+static int cmp_rm(const void *a, const void *b) {
+    const periodic_task_t *x = *(periodic_task_t *const *)a, *y = *(periodic_task_t *const *)b;
+    if (x->period != y->period) return x->period < y->period ? -1 : 1;
+    return (x->pid > y->pid) - (x->pid < y->pid);
+}
+
+void periodic_analyze(periodic_task_t *tasks, size_t n, periodic_analysis_t *a) {
+    a->ntasks = n;
+    a->utilization = 0.0;
+    a->ll_bound = n ? (double)n * (pow(2.0, 1.0 / (double)n) - 1.0) : 1.0;
+    a->hyperperiod = 1;
+    a->max_offset = 0;
+    a->rta_schedulable = 1;
+
+    for (size_t i = 0; i < n; ++i) {
+        a->utilization += (double)tasks[i].wcet / (double)tasks[i].period;
+        if (tasks[i].offset > a->max_offset) a->max_offset = tasks[i].offset;
+        if (a->hyperperiod) {
+            unsigned long long step = tasks[i].period / gcd(a->hyperperiod, tasks[i].period);
+            if (a->hyperperiod > PERIODIC_HORIZON_MAX / step) a->hyperperiod = 0;
+            else a->hyperperiod *= step;
+        }
+    }
+
+    /* response-time analysis over the level-i busy period, which allows
+     * deadlines past the period: the q-th job of the busy period finishes at
+     * w = (q + 1) C_i + sum over higher priority j of ceil(w / T_j) * C_j,
+     * iterated to a fixed point or past its deadline, and jobs are checked
+     * until one finishes before the next release (with D_i <= T_i, the
+     * first). R is the worst w - q T_i. */
+    periodic_task_t **order = n ? (periodic_task_t **)malloc(n * sizeof(periodic_task_t *)) : NULL;
+    if (n && !order) {
+        a->rta_schedulable = 0;
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) order[i] = &tasks[i];
+    qsort(order, n, sizeof(periodic_task_t *), cmp_rm);
+    for (size_t k = 0; k < n; ++k) {
+        periodic_task_t *t = order[k];
+        unsigned long long w = 0, worst = 0;
+        for (unsigned long long q = 0;; ++q) {
+            unsigned long long limit = q * t->period + t->deadline, next = w + t->wcet;
+            do {
+                w = next;
+                next = (q + 1) * t->wcet;
+                for (size_t j = 0; j < k; ++j) {
+                    const periodic_task_t *h = order[j];
+                    next += (w + h->period - 1) / h->period * h->wcet;
+                }
+            } while (next != w && next <= limit);
+            /* a busy period too long to follow counts as a miss */
+            if (next > limit || next > PERIODIC_HORIZON_MAX) {
+                worst = 0;
+                break;
+            }
+            if (next - q * t->period > worst) worst = next - q * t->period;
+            if (next <= (q + 1) * t->period) break;
+        }
+        t->wcrt = (unsigned long)worst;
+        if (!t->wcrt) a->rta_schedulable = 0;
+    }
+    free(order);
+}
+
+const char *periodic_ll_verdict(const periodic_analysis_t *a) {
+    if (a->utilization <= a->ll_bound) return "pass";
+    if (a->utilization <= 1.0) return "inconclusive";
+    return "fail";
+}
+
+void periodic_start(scheduler_t *s, periodic_task_t *tasks, size_t n, unsigned long horizon) {
+    s->tasks = tasks;
+    s->ntasks = n;
+    s->horizon = horizon;
+    for (size_t i = 0; i < n; ++i) {
+        periodic_task_t *t = &tasks[i];
+        t->next_release = t->offset;
+        if (t->next_release >= horizon) continue;
+        t->timer.kind = TIMER_RELEASE;
+        t->timer.data = t;
+        s->pending_arrivals++;
+        tw_schedule(&s->timers, &t->timer, t->next_release);
+    }
+}
+
+void periodic_release(scheduler_t *s, periodic_task_t *t) {
+    s->pending_arrivals--;
+    unsigned long release = t->next_release;
+    process_t *p = process_create(t->pid, (unsigned int)release, (int)t->wcet, t->priority);
+    if (p) {
+        p->deadline = (unsigned int)(release + t->deadline);
+        p->period = t->period;
+        p->task = (int)(t - s->tasks);
+        p->job = t->released++;
+
+        char info[128];
+        snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%lu, \"job\":%lu", p->pid, release, p->job);
+        char *ev = utils_build_event(EVT_JOB_RESUMED, s, p, info);
+        utils_emit_event_and_free(ev, EVT_JOB_RESUMED, s);
+        scheduler_add_process(s, p);
+    } else {
+        fprintf(stderr, "Warning: out of memory, pid %d skips its release at %lu\n", t->pid, release);
+    }
+
+    t->next_release = release + t->period;
+    if (t->next_release < s->horizon) {
+        s->pending_arrivals++;
+        tw_schedule(&s->timers, &t->timer, t->next_release);
+    }
+}
+
+int periodic_job_done(scheduler_t *s, const process_t *p) {
+    if (p->task < 0 || (size_t)p->task >= s->ntasks) return 0;
+    periodic_task_t *t = &s->tasks[p->task];
+    unsigned long response = (unsigned long)(p->finish_time - p->arrival);
+    t->completed++;
+    t->response_total += response;
+    t->start_total += (unsigned long)(p->start_time - p->arrival);
+    if (response > t->response_max) t->response_max = response;
+    if (p->finish_time > p->deadline) t->missed++;
+    if (s->periodic_jobs == s->periodic_cap) {
+        size_t newcap = s->periodic_cap ? s->periodic_cap * 2 : 256;
+        unsigned int *v = (unsigned int *)realloc(s->periodic_turns, newcap * sizeof(unsigned int));
+        if (!v) return 1;    // out of memory: the job is left out of the percentiles
+        s->periodic_turns = v;
+        s->periodic_cap = newcap;
+    }
+    s->periodic_turns[s->periodic_jobs++] = (unsigned int)response;
+    return 1;
+}
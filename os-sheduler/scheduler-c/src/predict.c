@@ -0,0 +1,72 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../include/predict.h"
+
+static int class_of(const process_t *p) {
+    if (p->priority < 0) return 0;
+    if (p->priority >= PREDICT_CLASSES) return PREDICT_CLASSES - 1;
+    return p->priority;
+}
+
+void predict_burst_start(scheduler_t *s, process_t *p) {
+    if (!s || !p || s->predict == PREDICT_EXACT || p->estimate >= 0) return;
+    double tau = s->tau0;
+    if (s->predict == PREDICT_EMA && p->tau >= 0) tau = p->tau;
+    else if (s->predict == PREDICT_CLASS && s->class_tau[class_of(p)] >= 0) tau = s->class_tau[class_of(p)];
+    p->estimate = (int)lround(tau);
+    if (p->estimate < 1) p->estimate = 1;
+}
+
+void predict_burst_end(scheduler_t *s, process_t *p) {
+    if (!s || !p || s->predict == PREDICT_EXACT || p->estimate < 0) return;
+    int err = p->estimate - p->burst;
+    s->predictions++;
+    s->predict_abs_error += (unsigned long)abs(err);
+    s->predict_bias += err;
+
+    double *tau = (s->predict == PREDICT_EMA) ? &p->tau : &s->class_tau[class_of(p)];
+    double prev = (*tau >= 0) ? *tau : s->tau0;
+    *tau = s->alpha * (double)p->burst + (1.0 - s->alpha) * prev;
+    p->estimate = -1;
+}
+
+int predict_burst(const scheduler_t *s, const process_t *p) {
+    if (!s || s->predict == PREDICT_EXACT || p->estimate < 0) return p->burst;
+    return p->estimate;
+}
+
+int predict_remaining(const scheduler_t *s, const process_t *p) {
+    if (!s || s->predict == PREDICT_EXACT || p->estimate < 0) return p->remaining;
+    int left = p->estimate - (p->burst - p->remaining);
+    return left < 1 ? 1 : left;
+}
+
+void predict_note_choice(scheduler_t *s, const process_t *chosen) {
+    if (!s || !chosen || s->predict == PREDICT_EXACT) return;
+    int best = chosen->remaining;
+    for (const process_t *p = s->ready_head; p; p = p->next) {
+        if (p->remaining < best) best = p->remaining;
+    }
+    if (best < chosen->remaining) {
+        s->inversions++;
+        s->inversion_ticks += (unsigned long)(chosen->remaining - best);
+    }
+}
+
+const char *predict_mode_name(predict_mode_t mode) {
+    switch (mode) {
+        case PREDICT_EMA: return "ema";
+        case PREDICT_CLASS: return "class";
+        case PREDICT_EXACT:
+        default: return "exact";
+    }
+}
+
+int predict_parse_mode(const char *name) {
+    if (!name) return -1;
+    if (strcmp(name, "exact") == 0) return PREDICT_EXACT;
+    if (strcmp(name, "ema") == 0) return PREDICT_EMA;
+    if (strcmp(name, "class") == 0) return PREDICT_CLASS;
+    return -1;
+}
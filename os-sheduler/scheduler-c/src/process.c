@@ -22,21 +22,246 @@ process_t *process_create(int pid, unsigned int arrival, int burst, int priority
     /* new fields */
     p->waited_total = 0;
     p->last_enqueued_tick = UINT_MAX;
+    p->cpu = -1;
+    p->work_acc = 0;
+    p->run_ticks = 0;
+    p->last_cpu = -1;
+    p->cache_mark = 0;
+
+    p->bursts = NULL;
+    p->nbursts = 0;
+    p->burst_idx = 0;
+    p->cpu_total = burst;
+    p->io_total = 0;
+    p->io_left = 0;
+    p->io_enqueued_tick = UINT_MAX;
+    p->io_blocks = NULL;
+    p->nio_blocks = 0;
+    p->io_block = 0;
+    p->tau = -1.0;
+    p->estimate = -1;
+    p->vruntime = 0;
+    p->slice_ran = 0;
+    p->vdeadline = 0;
+    p->min_deadline = 0;
+    p->vlag = 0;
+    p->max_lag = 0.0;
+    p->wake_tick = 0;
+    p->woken = 0;
+    p->wakeups = 0;
+    p->latency_total = 0;
+    p->latency_max = 0;
+    p->deadline = UINT_MAX;
+    p->heap_idx = 0;
+    p->period = 0;
+    p->task = -1;
+    p->job = 0;
+    p->pass = 0;
+    p->share_mark = 0.0;
+    p->share_due = 0.0;
+    p->share_since = 0;
+    p->share_ticks = 0;
+    p->mlq_class = -1;
+    p->group = -1;
+    p->cs = NULL;
+    p->ncs = 0;
+    p->cs_next = 0;
+    p->cs_held = -1;
+    p->cpu_done = 0;
+    p->base_priority = priority;
+    p->lock_since = 0;
+    p->lock_blocked = 0;
+    p->lock_inversion = 0;
+    p->after = NULL;
+    p->nafter = 0;
+    p->dag_idx = -1;
+    p->cp_rank = 0;
+    p->released = arrival;
+    p->forks = NULL;
+    p->nforks = 0;
+    p->fork_next = 0;
+    p->fork_children = 0;
+    p->forked = 0;
+    p->ppid = -1;
+    p->fork_parent = NULL;
+    p->fork_since = 0;
+    p->fork_wait = 0;
+    p->width = 1;
+    p->gang_row = -1;
+    p->gang_col = -1;
+    p->gang_since = 0;
+    p->gang_on = 0;
+    p->walltime = 0;
+    p->energy = 0.0;
+    p->working_set = 0;
+    p->mem_slot = -1;
+    p->swapped = 0;
+    p->swap_left = 0;
+    p->fault_debt = 0.0;
+    p->fault_ticks = 0;
+    p->swap_outs = 0;
+    p->admitted = 0;
 
     p->next = NULL;
     return p;
 }
 
+int process_set_bursts(process_t *p, const int *bursts, int n) {
+    if (!p || !bursts || n < 1 || n % 2 == 0) return -1;
+    int cpu = 0, io = 0;
+    for (int i = 0; i < n; ++i) {
+        if (bursts[i] <= 0) return -1;
+        if (i % 2 == 0) cpu += bursts[i];
+        else io += bursts[i];
+    }
+    int *copy = (int *)malloc((size_t)n * sizeof(int));
+    if (!copy) return -1;
+    memcpy(copy, bursts, (size_t)n * sizeof(int));
+    free(p->bursts);
+    p->bursts = copy;
+    p->nbursts = n;
+    p->burst_idx = 0;
+    p->burst = bursts[0];
+    p->remaining = bursts[0];
+    p->cpu_total = cpu;
+    p->io_total = io;
+    return 0;
+}
+
+int process_set_blocks(process_t *p, const int *blocks, int n) {
+    if (!p || !blocks || n < 1) return -1;
+    for (int i = 0; i < n; ++i) {
+        if (blocks[i] < 0) return -1;
+    }
+    int *copy = (int *)malloc((size_t)n * sizeof(int));
+    if (!copy) return -1;
+    memcpy(copy, blocks, (size_t)n * sizeof(int));
+    free(p->io_blocks);
+    p->io_blocks = copy;
+    p->nio_blocks = n;
+    return 0;
+}
+
+int process_set_sections(process_t *p, const crit_section_t *cs, int n) {
+    if (!p || n < 0 || (n > 0 && !cs)) return -1;
+    for (int i = 0; i < n; ++i) {
+        if (cs[i].resource < 0 || cs[i].at < 0 || cs[i].hold <= 0 || cs[i].at >= p->cpu_total) return -1;
+        if (i > 0 && cs[i].at < cs[i - 1].at + cs[i - 1].hold) return -1;
+    }
+    crit_section_t *copy = NULL;
+    if (n > 0) {
+        copy = (crit_section_t *)malloc((size_t)n * sizeof(crit_section_t));
+        if (!copy) return -1;
+        memcpy(copy, cs, (size_t)n * sizeof(crit_section_t));
+    }
+    free(p->cs);
+    p->cs = copy;
+    p->ncs = n;
+    p->cs_next = 0;
+    p->cs_held = -1;
+    return 0;
+}
+
+int process_set_after(process_t *p, const int *pids, int n) {
+    if (!p || n < 0 || (n > 0 && !pids)) return -1;
+    int *copy = NULL;
+    if (n > 0) {
+        copy = (int *)malloc((size_t)n * sizeof(int));
+        if (!copy) return -1;
+        memcpy(copy, pids, (size_t)n * sizeof(int));
+    }
+    free(p->after);
+    p->after = copy;
+    p->nafter = n;
+    return 0;
+}
+
+int process_set_forks(process_t *p, const fork_spec_t *forks, int n) {
+    if (!p || n < 0 || (n > 0 && !forks)) return -1;
+    for (int i = 0; i < n; ++i) {
+        if (forks[i].at < 0 || forks[i].at >= p->cpu_total || forks[i].burst <= 0 || forks[i].count <= 0) return -1;
+        if (i > 0 && forks[i].at < forks[i - 1].at) return -1;
+    }
+    fork_spec_t *copy = NULL;
+    if (n > 0) {
+        copy = (fork_spec_t *)malloc((size_t)n * sizeof(fork_spec_t));
+        if (!copy) return -1;
+        memcpy(copy, forks, (size_t)n * sizeof(fork_spec_t));
+    }
+    free(p->forks);
+    p->forks = copy;
+    p->nforks = n;
+    p->fork_next = 0;
+    return 0;
+}
+
 process_t *process_clone(const process_t *src) {
     if (!src) return NULL;
     process_t *p = (process_t *)calloc(1, sizeof(process_t));
     if (!p) return NULL;
     memcpy(p, src, sizeof(process_t));
     p->next = NULL; /* clone has no links */
+    memset(&p->timer, 0, sizeof(p->timer));
+    if (src->bursts) {
+        p->bursts = (int *)malloc((size_t)src->nbursts * sizeof(int));
+        if (!p->bursts) {
+            free(p);
+            return NULL;
+        }
+        memcpy(p->bursts, src->bursts, (size_t)src->nbursts * sizeof(int));
+    }
+    if (src->io_blocks) {
+        p->io_blocks = (int *)malloc((size_t)src->nio_blocks * sizeof(int));
+        if (!p->io_blocks) {
+            free(p->bursts);
+            free(p);
+            return NULL;
+        }
+        memcpy(p->io_blocks, src->io_blocks, (size_t)src->nio_blocks * sizeof(int));
+    }
+    if (src->cs) {
+        p->cs = (crit_section_t *)malloc((size_t)src->ncs * sizeof(crit_section_t));
+        if (!p->cs) {
+            free(p->io_blocks);
+            free(p->bursts);
+            free(p);
+            return NULL;
+        }
+        memcpy(p->cs, src->cs, (size_t)src->ncs * sizeof(crit_section_t));
+    }
+    if (src->after) {
+        p->after = (int *)malloc((size_t)src->nafter * sizeof(int));
+        if (!p->after) {
+            free(p->cs);
+            free(p->io_blocks);
+            free(p->bursts);
+            free(p);
+            return NULL;
+        }
+        memcpy(p->after, src->after, (size_t)src->nafter * sizeof(int));
+    }
+    if (src->forks) {
+        p->forks = (fork_spec_t *)malloc((size_t)src->nforks * sizeof(fork_spec_t));
+        if (!p->forks) {
+            free(p->after);
+            free(p->cs);
+            free(p->io_blocks);
+            free(p->bursts);
+            free(p);
+            return NULL;
+        }
+        memcpy(p->forks, src->forks, (size_t)src->nforks * sizeof(fork_spec_t));
+    }
+    p->fork_parent = NULL;
     return p;
 }
 
 void process_free(process_t *p) {
     if (!p) return;
+    free(p->bursts);
+    free(p->io_blocks);
+    free(p->cs);
+    free(p->after);
+    free(p->forks);
     free(p);
 }
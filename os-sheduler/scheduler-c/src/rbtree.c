@@ -0,0 +1,217 @@
+#include <stddef.h>
+#include "../include/rbtree.h"
+
+void rb_init(rb_tree_t *t, rb_less_fn less, rb_augment_fn augment) {
+    t->root = NULL;
+    t->leftmost = NULL;
+    t->count = 0;
+    t->less = less;
+    t->augment = augment;
+}
+
+static int is_red(const rb_node_t *n) {
+    return n && n->red;
+}
+
+static void replace_child(rb_tree_t *t, rb_node_t *parent, rb_node_t *old, rb_node_t *n) {
+    if (!parent) t->root = n;
+    else if (parent->left == old) parent->left = n;
+    else parent->right = n;
+}
+
+/* x's right child y takes x's place; x becomes y's left child */
+static void rotate_left(rb_tree_t *t, rb_node_t *x) {
+    rb_node_t *y = x->right;
+    x->right = y->left;
+    if (y->left) y->left->parent = x;
+    y->parent = x->parent;
+    replace_child(t, x->parent, x, y);
+    y->left = x;
+    x->parent = y;
+    if (t->augment) {
+        t->augment(x);
+        t->augment(y);
+    }
+}
+
+static void rotate_right(rb_tree_t *t, rb_node_t *x) {
+    rb_node_t *y = x->left;
+    x->left = y->right;
+    if (y->right) y->right->parent = x;
+    y->parent = x->parent;
+    replace_child(t, x->parent, x, y);
+    y->right = x;
+    x->parent = y;
+    if (t->augment) {
+        t->augment(x);
+        t->augment(y);
+    }
+}
+
+static void propagate(rb_tree_t *t, rb_node_t *n) {
+    if (!t->augment) return;
+    for (; n; n = n->parent) t->augment(n);
+}
+
+void rb_insert(rb_tree_t *t, rb_node_t *n) {
+    rb_node_t *parent = NULL, **link = &t->root;
+    int leftmost = 1;
+    while (*link) {
+        parent = *link;
+        if (t->less(n, parent)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            leftmost = 0;
+        }
+    }
+    n->parent = parent;
+    n->left = n->right = NULL;
+    n->red = 1;
+    *link = n;
+    t->count++;
+    if (leftmost) t->leftmost = n;
+    propagate(t, n);
+
+    while (is_red(n->parent)) {
+        rb_node_t *p = n->parent, *g = p->parent;
+        if (p == g->left) {
+            rb_node_t *u = g->right;
+            if (is_red(u)) {
+                p->red = u->red = 0;
+                g->red = 1;
+                n = g;
+                continue;
+            }
+            if (n == p->right) {
+                rotate_left(t, p);
+                n = p;
+                p = n->parent;
+            }
+            p->red = 0;
+            g->red = 1;
+            rotate_right(t, g);
+        } else {
+            rb_node_t *u = g->left;
+            if (is_red(u)) {
+                p->red = u->red = 0;
+                g->red = 1;
+                n = g;
+                continue;
+            }
+            if (n == p->left) {
+                rotate_right(t, p);
+                n = p;
+                p = n->parent;
+            }
+            p->red = 0;
+            g->red = 1;
+            rotate_left(t, g);
+        }
+    }
+    t->root->red = 0;
+}
+
+rb_node_t *rb_next(const rb_node_t *n) {
+    if (!n) return NULL;
+    if (n->right) {
+        n = n->right;
+        while (n->left) n = n->left;
+        return (rb_node_t *)n;
+    }
+    while (n->parent && n == n->parent->right) n = n->parent;
+    return n->parent;
+}
+
+void rb_erase(rb_tree_t *t, rb_node_t *n) {
+    if (t->leftmost == n) t->leftmost = rb_next(n);
+
+    rb_node_t *child, *parent;   // child replaces the removed position, parent is its parent
+    int removed_red;
+    if (!n->left || !n->right) {
+        child = n->left ? n->left : n->right;
+        parent = n->parent;
+        removed_red = n->red;
+        if (child) child->parent = parent;
+        replace_child(t, parent, n, child);
+    } else {
+        /* splice out the successor s and put it in n's place */
+        rb_node_t *s = n->right;
+        while (s->left) s = s->left;
+        removed_red = s->red;
+        child = s->right;
+        if (s->parent == n) {
+            parent = s;
+        } else {
+            parent = s->parent;
+            parent->left = child;
+            if (child) child->parent = parent;
+            s->right = n->right;
+            n->right->parent = s;
+        }
+        s->left = n->left;
+        n->left->parent = s;
+        s->parent = n->parent;
+        s->red = n->red;
+        replace_child(t, n->parent, n, s);
+    }
+    t->count--;
+    n->parent = n->left = n->right = NULL;
+    propagate(t, parent);
+
+    if (removed_red) return;
+    while (child != t->root && !is_red(child)) {
+        if (child == parent->left) {
+            rb_node_t *w = parent->right;
+            if (is_red(w)) {
+                w->red = 0;
+                parent->red = 1;
+                rotate_left(t, parent);
+                w = parent->right;
+            }
+            if (!is_red(w->left) && !is_red(w->right)) {
+                w->red = 1;
+                child = parent;
+                parent = child->parent;
+            } else {
+                if (!is_red(w->right)) {
+                    w->left->red = 0;
+                    w->red = 1;
+                    rotate_right(t, w);
+                    w = parent->right;
+                }
+                w->red = parent->red;
+                parent->red = 0;
+                w->right->red = 0;
+                rotate_left(t, parent);
+                child = t->root;
+            }
+        } else {
+            rb_node_t *w = parent->left;
+            if (is_red(w)) {
+                w->red = 0;
+                parent->red = 1;
+                rotate_right(t, parent);
+                w = parent->left;
+            }
+            if (!is_red(w->left) && !is_red(w->right)) {
+                w->red = 1;
+                child = parent;
+                parent = child->parent;
+            } else {
+                if (!is_red(w->left)) {
+                    w->right->red = 0;
+                    w->red = 1;
+                    rotate_left(t, w);
+                    w = parent->left;
+                }
+                w->red = parent->red;
+                parent->red = 0;
+                w->left->red = 0;
+                rotate_right(t, parent);
+                child = t->root;
+            }
+        }
+    }
+    if (child) child->red = 0;
+}
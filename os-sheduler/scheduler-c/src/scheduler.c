@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
@@ -10,6 +11,18 @@
 #include "../include/priority_p.h"
 #include "../include/rr.h"
 #include "../include/mlfq.h"
+#include "../include/cfs.h"
+#include "../include/eevdf.h"
+#include "../include/edf.h"
+#include "../include/lottery.h"
+#include "../include/hrrn.h"
+#include "../include/mlq.h"
+#include "../include/group.h"
+#include "../include/lock.h"
+#include "../include/cpf.h"
+#include "../include/spawn.h"
+#include "../include/disk.h"
+#include "../include/predict.h"
 
 /* local ensure for completed array allocation */
 static int ensure_completed_capacity_local(scheduler_t *s) {
@@ -31,6 +44,98 @@ scheduler_t *scheduler_create(sched_algo_t algo) {
     s->quantum = 0;
     s->ready_head = NULL;
     s->running = NULL;
+    s->io_head = NULL;
+    s->io_tail = NULL;
+    s->io_active = NULL;
+    s->io_busy_ticks = 0;
+    s->overlap_ticks = 0;
+    s->io_busy_since = 0;
+    s->disk_policy = DISK_FIFO;
+    s->disk_pos = 0;
+    s->disk_dir = 1;
+    s->seek_rate = 0;
+    s->io_deadline = 100;
+    s->io_requests = 0;
+    s->io_wait_total = 0;
+    s->io_wait_max = 0;
+    s->seek_distance = 0;
+    s->seek_ticks = 0;
+    s->io_overdue = 0;
+    rb_init(&s->rq, NULL, NULL);
+    s->rq_weight = 0;
+    s->min_vruntime = 0;
+    s->sched_latency = 24;
+    s->min_granularity = 3;
+    s->avg_vruntime = 0;
+    if (algo == ALG_CFS) cfs_init(s);
+    if (algo == ALG_EEVDF) eevdf_init(s);
+    heap_init(&s->heap, NULL);
+    if (algo == ALG_EDF) edf_init(s);
+    if (algo == ALG_RM) rm_init(s);
+    if (algo == ALG_STRIDE) stride_init(s);
+    kinetic_init(&s->hrrn);
+    memset(&s->mlq, 0, sizeof(s->mlq));
+    group_init(&s->groups);
+    lock_init(&s->locks);
+    paging_init(&s->mem);
+    admit_init(&s->admit);
+    if (algo == ALG_CPF) cpf_init(s);
+    s->dag = NULL;
+    s->fork_waiters = NULL;
+    s->forked = 0;
+    s->fork_ticks = 0;
+    s->dag_done = NULL;
+    s->dag_done_len = 0;
+    fenwick_init(&s->lottery);
+    s->rng = 1;
+    s->global_pass = 0;
+    s->share_tickets = 0;
+    s->share_clock = 0.0;
+    s->share_run = 0;
+    s->tasks = NULL;
+    s->ntasks = 0;
+    s->horizon = 0;
+    s->periodic_turns = NULL;
+    s->periodic_jobs = s->periodic_cap = 0;
+    memset(&s->analysis, 0, sizeof(s->analysis));
+    s->wakeups = 0;
+    s->latency_total = 0;
+    s->latency_max = 0;
+    s->predict = PREDICT_EXACT;
+    s->alpha = 0.5;
+    s->tau0 = 10.0;
+    for (int i = 0; i < PREDICT_CLASSES; ++i) s->class_tau[i] = -1.0;
+    s->predictions = 0;
+    s->predict_abs_error = 0;
+    s->predict_bias = 0;
+    s->inversions = 0;
+    s->inversion_ticks = 0;
+    tw_init(&s->timers, 0);
+    s->slice_timer.kind = TIMER_SLICE_END;
+    s->dispatch_seq = 0;
+    s->slice_pending = 0;
+    s->pending_arrivals = 0;
+    s->cpu_id = -1;
+    s->speed = 100;
+    s->nr_assigned = 0;
+    s->assigned_work = 0;
+    s->busy_ticks = 0;
+    s->switch_cost = 0;
+    s->switch_left = 0;
+    s->switch_ticks = 0;
+    s->cache_warmup = 0;
+    s->cache_size = 0;
+    s->migration_cost = 0;
+    s->warmup_left = 0;
+    s->migration_left = 0;
+    s->warmup_ticks = 0;
+    s->migration_ticks = 0;
+    s->quiet = 0;
+    s->buffered = 0;
+    s->events_lost = 0;
+    s->event_buf = NULL;
+    s->event_buf_len = 0;
+    s->event_buf_cap = 0;
     s->context_switches = 0;
     s->completed = NULL;
     s->completed_count = 0;
@@ -47,17 +152,56 @@ void scheduler_destroy(scheduler_t *s) {
         process_free(cur);
         cur = n;
     }
+    cur = s->io_head;
+    while (cur) {
+        process_t *n = cur->next;
+        process_free(cur);
+        cur = n;
+    }
     if (s->running) process_free(s->running);
+    if (s->io_active) process_free(s->io_active);
+    if (s->algo == ALG_CFS || s->algo == ALG_EEVDF) cfs_clear(s);
+    if (s->algo == ALG_EDF || s->algo == ALG_RM || s->algo == ALG_CPF) edf_clear(s);
+    if (s->algo == ALG_LOTTERY || s->algo == ALG_STRIDE) lottery_clear(s);
+    if (s->algo == ALG_HRRN) hrrn_clear(s);
+    if (s->algo == ALG_MLQ) mlq_clear(s);
+    group_clear(s);
+    lock_clear(s);
+    spawn_clear(s);
+    paging_clear(s);
+    admit_clear(s);
+    /* arrivals that never fired are owned by the wheel */
+    timer_node_t *t = tw_detach_all(&s->timers);
+    while (t) {
+        timer_node_t *n = t->next;
+        if (t->kind == TIMER_ARRIVAL) process_free((process_t *)t->data);
+        t = n;
+    }
     if (s->completed) free(s->completed);
+    free(s->dag_done);
+    if (s->event_buf) free(s->event_buf);
+    free(s->tasks);
+    free(s->periodic_turns);
     free(s);
 }
 
 void scheduler_add_process(scheduler_t *s, process_t *p) {
     if (!s || !p) return;
     p->next = NULL;
+    if (p->state == PROC_NEW || p->state == PROC_WAITING) {
+        p->wake_tick = s->current_tick;
+        p->woken = 1;
+    }
     p->state = PROC_READY;
     /* mark enqueue time for precise waiting accounting */
     p->last_enqueued_tick = (unsigned int)s->current_tick;
+    /* count placements, not requeues after preemption */
+    if (p->cpu != s->cpu_id) {
+        p->cpu = s->cpu_id;
+        s->nr_assigned++;
+        s->assigned_work += (unsigned long)p->remaining;
+    }
+    predict_burst_start(s, p);
     if (!s->ready_head) s->ready_head = p;
     else {
         process_t *cur = s->ready_head;
@@ -74,14 +218,7 @@ process_t *scheduler_pop_head(scheduler_t *s) {
     process_t *p = s->ready_head;
     s->ready_head = p->next;
     p->next = NULL;
-
-    if (p->last_enqueued_tick != UINT_MAX) {
-        if (s->current_tick >= p->last_enqueued_tick) {
-            p->waited_total += (unsigned int)(s->current_tick - p->last_enqueued_tick);
-        }
-        p->last_enqueued_tick = UINT_MAX;
-    }
-    return p;
+    return scheduler_take(s, p);
 }
 
 
@@ -93,6 +230,11 @@ process_t *scheduler_remove_process(scheduler_t *s, int pid) {
             if (prev) prev->next = cur->next;
             else s->ready_head = cur->next;
             cur->next = NULL;
+            if (cur->cpu == s->cpu_id && s->nr_assigned > 0) {
+                s->nr_assigned--;
+                s->assigned_work -= (unsigned long)cur->remaining;
+            }
+            cur->cpu = -1;
             return cur;
         }
         prev = cur;
@@ -101,12 +243,146 @@ process_t *scheduler_remove_process(scheduler_t *s, int pid) {
     return NULL;
 }
 
+/* Hand the next queued request to the idle device: it is served from the
+ * next tick on and completes after the seek plus io_left ticks of service.
+ */
+static void io_start(scheduler_t *s) {
+    process_t *p = disk_pick(s);
+    if (!p) return;
+    unsigned long seek = disk_seek_ticks(s, p->io_block);
+    unsigned long wait = s->current_tick - p->io_enqueued_tick;
+    long dist = p->io_block - s->disk_pos;
+    if (dist) s->disk_dir = dist > 0 ? 1 : -1;
+    if (dist < 0) dist = -dist;
+
+    s->io_active = p;
+    s->io_busy_since = s->current_tick + 1;
+    s->io_requests++;
+    s->io_wait_total += wait;
+    if (wait > s->io_wait_max) s->io_wait_max = wait;
+    if (wait >= s->io_deadline) s->io_overdue++;
+    s->seek_distance += (unsigned long)dist;
+    s->seek_ticks += seek;
+    s->disk_pos = p->io_block;
+
+    char info[128];
+    snprintf(info, sizeof(info), "\"block\":%d, \"seek\":%lu, \"queued\":%lu", p->io_block, seek, wait);
+    char *ev = utils_build_event(EVT_IO_STARTED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_IO_STARTED, s);
+
+    p->timer.kind = TIMER_IO_DONE;
+    p->timer.data = p;
+    tw_schedule(&s->timers, &p->timer, s->current_tick + seek + (unsigned long)p->io_left);
+}
+
+/* The active request finished during this tick: its process is ready for
+ * the next tick, since this tick's CPU slot has already been handed out.
+ */
+static void io_complete(scheduler_t *s, process_t *p) {
+    s->io_active = NULL;
+    p->io_left = 0;
+    p->io_enqueued_tick = UINT_MAX;
+
+    /* next CPU burst */
+    p->burst_idx++;
+    p->burst = p->bursts[p->burst_idx];
+    p->remaining = p->burst;
+    if (p->cpu == s->cpu_id && s->cpu_id >= 0) s->assigned_work += (unsigned long)p->remaining;
+
+    char *ev = utils_build_event(EVT_IO_COMPLETED, s, p, NULL);
+    utils_emit_event_and_free(ev, EVT_IO_COMPLETED, s);
+    scheduler_add_process(s, p);
+    io_start(s);
+}
+
+static void fire_arrival(scheduler_t *s, process_t *p) {
+    s->pending_arrivals--;
+    if (s->dag && p->dag_idx >= 0 && !dag_arrive(s->dag, p)) return;   // held until its predecessors finish
+    if (s->admit.on && !admit_arrive(s, p)) return;
+    if (s->mem.capacity) paging_arrive(s, p);
+    char info[128];
+    if (p->nafter)
+        snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%u, \"released\":%u", p->pid, p->arrival, p->released);
+    else
+        snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%u", p->pid, p->arrival);
+    char *ev = utils_build_event(EVT_JOB_RESUMED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_RESUMED, s);
+    scheduler_add_process(s, p);
+}
+
+static void fire_slice_end(scheduler_t *s, unsigned long seq) {
+    if (s->running && seq == s->dispatch_seq) s->running->quantum_left = 0;
+}
+
+void scheduler_schedule_arrival(scheduler_t *s, process_t *p) {
+    if (!s || !p) return;
+    p->timer.kind = TIMER_ARRIVAL;
+    p->timer.data = p;
+    s->pending_arrivals++;
+    tw_schedule(&s->timers, &p->timer, p->arrival);
+}
+
+/* Fire an expired chain, which covers a single tick: completions first so
+ * that woken jobs queue ahead of new arrivals, as when each was scanned for
+ * separately.
+ */
+static void fire_chain(scheduler_t *s, timer_node_t *chain) {
+    timer_node_t *head[TIMER_RELEASE + 1] = {0}, *tail[TIMER_RELEASE + 1] = {0};
+    while (chain) {
+        timer_node_t *t = chain;
+        chain = t->next;
+        t->next = NULL;
+        if (tail[t->kind]) tail[t->kind]->next = t;
+        else head[t->kind] = t;
+        tail[t->kind] = t;
+    }
+    for (int kind = TIMER_IO_DONE; kind <= TIMER_RELEASE; ++kind) {
+        timer_node_t *t = head[kind];
+        while (t) {
+            timer_node_t *n = t->next;
+            t->next = NULL;
+            switch (kind) {
+                case TIMER_IO_DONE: io_complete(s, (process_t *)t->data); break;
+                case TIMER_SLICE_END: fire_slice_end(s, (unsigned long)(size_t)t->data); break;
+                case TIMER_ARRIVAL: fire_arrival(s, (process_t *)t->data); break;
+                case TIMER_RELEASE: periodic_release(s, (periodic_task_t *)t->data); break;
+                default: break;
+            }
+            t = n;
+        }
+    }
+}
+
+void scheduler_fire_timers(scheduler_t *s) {
+    if (!s) return;
+    /* one tick at a time, so each chain holds a single tick */
+    while (s->timers.now < s->current_tick || s->timers.due.head) {
+        unsigned long upto = s->timers.due.head ? s->timers.now : s->timers.now + 1;
+        fire_chain(s, tw_advance(&s->timers, upto, 0));
+    }
+}
+
+void scheduler_skip_idle(scheduler_t *s, unsigned long limit) {
+    if (!s || !scheduler_idle(s)) return;
+    tw_cancel(&s->timers, &s->slice_timer);
+    if (s->current_tick >= limit) return;
+    scheduler_fire_timers(s);
+    timer_node_t *chain = tw_advance(&s->timers, limit, 1);
+    s->current_tick = s->timers.now;
+    fire_chain(s, chain);
+}
+
 void scheduler_tick(scheduler_t *s) {
     if (!s) return;
     s->current_tick++;
-    char *ev = utils_build_event(EVT_TICK, s, NULL, NULL);
-    utils_emit_event_and_free(ev, EVT_TICK, s);
+    /* per-CPU schedulers of the multi-CPU model skip idle ticks, so they do
+     * not emit tick events either */
+    if (s->cpu_id < 0) {
+        char *ev = utils_build_event(EVT_TICK, s, NULL, NULL);
+        utils_emit_event_and_free(ev, EVT_TICK, s);
+    }
 
+    unsigned long busy_before = s->busy_ticks;
     switch (s->algo) {
         case ALG_FCFS: fcfs_tick(s); break;
         case ALG_SJF: sjf_tick(s); break;
@@ -115,20 +391,333 @@ void scheduler_tick(scheduler_t *s) {
         case ALG_PRIORITY_P: priority_p_tick(s); break;
         case ALG_RR: rr_tick(s); break;
         case ALG_MLFQ: mlfq_tick(s); break;
+        case ALG_CFS: cfs_tick(s); break;
+        case ALG_EEVDF: eevdf_tick(s); break;
+        case ALG_EDF:
+        case ALG_RM: edf_tick(s); break;
+        case ALG_LOTTERY: lottery_tick(s); break;
+        case ALG_STRIDE: stride_tick(s); break;
+        case ALG_HRRN: hrrn_tick(s); break;
+        case ALG_MLQ: mlq_tick(s); break;
+        case ALG_HFS: hfs_tick(s); break;
+        case ALG_CPF: cpf_tick(s); break;
         default: break;
     }
+    if (s->locks.n) lock_tick(s);
+    spawn_tick(s);
+    if (s->admit.shed_late) admit_tick(s);
+    if (s->mem.capacity) paging_tick(s);
+
+    if (s->io_active && s->current_tick >= s->io_busy_since) {
+        s->io_busy_ticks++;
+        if (s->busy_ticks != busy_before) s->overlap_ticks++;
+    }
+    scheduler_fire_timers(s);
+}
+
+/* p finished: the jobs it released arrive at the end of this tick, as if
+ * their arrival came now. On a CPU of the SMP model it is only listed. */
+static void dag_job_done(scheduler_t *s, process_t *p) {
+    if (!s->dag) {
+        if (s->dag_done) s->dag_done[s->dag_done_len++] = p->dag_idx;
+        return;
+    }
+    process_t *q = dag_finish(s->dag, p->dag_idx, s->current_tick);
+    while (q) {
+        process_t *n = q->next;
+        q->next = NULL;
+        q->timer.kind = TIMER_ARRIVAL;
+        q->timer.data = q;
+        s->pending_arrivals++;
+        tw_schedule(&s->timers, &q->timer, s->current_tick);
+        q = n;
+    }
+}
+
+int scheduler_runnable(const scheduler_t *s) {
+    return s && (s->ready_head || s->rq.count || s->heap.len || s->lottery.len || s->hrrn.len || s->mlq.queued || s->groups.queued || s->running);
+}
+
+int scheduler_idle(const scheduler_t *s) {
+    return !s || (!scheduler_runnable(s) && !s->locks.blocked && !s->fork_waiters && !s->mem.parked && !s->io_head && !s->io_active);
+}
+
+void scheduler_finish_burst(scheduler_t *s) {
+    if (!s || !s->running) return;
+    process_t *p = s->running;
+    s->running = NULL;
+    predict_burst_end(s, p);
+    if (p->ncs) lock_burst_end(s, p);
+
+    if (p->bursts && p->burst_idx + 1 < p->nbursts) {
+        p->burst_idx++;
+        p->io_left = p->bursts[p->burst_idx];
+        int k = p->burst_idx / 2;   // I/O bursts sit at odd indices
+        p->io_block = (p->io_blocks && k < p->nio_blocks) ? p->io_blocks[k] : 0;
+        p->state = PROC_WAITING;
+        p->io_enqueued_tick = (unsigned int)s->current_tick;
+        p->next = NULL;
+        if (s->io_tail) s->io_tail->next = p;
+        else s->io_head = p;
+        s->io_tail = p;
+
+        char info[128];
+        snprintf(info, sizeof(info), "\"io\":%d, \"burst_index\":%d", p->io_left, p->burst_idx);
+        char *ev = utils_build_event(EVT_JOB_BLOCKED, s, p, info);
+        utils_emit_event_and_free(ev, EVT_JOB_BLOCKED, s);
+        if (!s->io_active) io_start(s);
+        return;
+    }
+
+    p->state = PROC_TERMINATED;
+    p->finish_time = (unsigned int)s->current_tick;
+    char *ev = utils_build_event(EVT_JOB_FINISHED, s, p, NULL);
+    utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
+    if (p->dag_idx >= 0) dag_job_done(s, p);
+    if (p->fork_parent) spawn_child_done(s, p);
+    if (p->mem_slot >= 0) paging_leave(s, p);
+    if (p->admitted) admit_leave(s, p);
+    scheduler_record_completed(s, p);
+    process_free(p);
+}
+
+process_t *scheduler_take(scheduler_t *s, process_t *p) {
+    if (p->last_enqueued_tick != UINT_MAX && s->current_tick >= p->last_enqueued_tick)
+        p->waited_total += (unsigned int)(s->current_tick - p->last_enqueued_tick);
+    p->last_enqueued_tick = UINT_MAX;
+    return p;
+}
+
+void scheduler_dispatch(scheduler_t *s, process_t *p) {
+    s->running = p;
+    p->state = PROC_RUNNING;
+    if (p->start_time == UINT_MAX) p->start_time = s->current_tick;
+
+    event_type_t type = p->remaining == p->burst ? EVT_JOB_STARTED : EVT_JOB_RESUMED;
+    char *ev = utils_build_event(EVT_CONTEXT_SWITCH, s, p, NULL);
+    utils_emit_event_and_free(ev, EVT_CONTEXT_SWITCH, s);
+    ev = utils_build_event(type, s, p, NULL);
+    utils_emit_event_and_free(ev, type, s);
+}
+
+/* The slice runs after the stall; its expiry fires at the end of the tick
+ * before its last one, so the policy sees quantum_left == 0 when it checks
+ * that last tick.
+ */
+static void arm_slice(scheduler_t *s, process_t *p) {
+    s->slice_pending = 0;
+    if (p->quantum_left <= 0) return;
+    unsigned long last = s->current_tick + s->switch_left + s->migration_left + s->warmup_left + p->swap_left +
+                         (unsigned long)p->quantum_left - 1;
+    if (last == s->current_tick) {
+        p->quantum_left = 0;
+        return;
+    }
+    s->slice_timer.data = (void *)(size_t)s->dispatch_seq;
+    tw_schedule(&s->timers, &s->slice_timer, last - 1);
+}
+
+int scheduler_consume(scheduler_t *s, process_t *p) {
+    if (!s || !p) return 0;
+    unsigned int speed = s->freq.cfg ? dvfs_charge(s, p) : s->speed;
+    if (s->slice_pending && p == s->running) arm_slice(s, p);
+    p->run_ticks++;
+    if (s->admit.shed_late && p->admitted == 1 && admit_shed(s, p)) return 0;
+    if (s->locks.blocked) lock_charge(s, p);
+    /* switching, moving or refilling the cache: the CPU is held but no work gets done */
+    if (s->switch_left > 0) {
+        s->switch_left--;
+        s->switch_ticks++;
+        return 0;
+    }
+    if (s->migration_left > 0) {
+        s->migration_left--;
+        s->migration_ticks++;
+        return 0;
+    }
+    if (s->warmup_left > 0) {
+        s->warmup_left--;
+        s->warmup_ticks++;
+        return 0;
+    }
+    if (s->mem.capacity && paging_stall(s, p)) return 0;
+    if (p->nforks && spawn_fork(s, p)) return 0;
+    if (p->fork_children) {
+        /* preempted before it could block on its children: it blocks now */
+        s->fork_ticks++;
+        return 0;
+    }
+    if (p->ncs && !lock_enter(s, p)) {
+        s->locks.spin_ticks++;
+        return 0;
+    }
+    p->work_acc += speed;
+    while (p->work_acc >= 100 && p->remaining > 0 &&
+           (p->fork_next >= p->nforks || p->cpu_done < p->forks[p->fork_next].at)) {
+        p->work_acc -= 100;
+        p->remaining--;
+        p->cpu_done++;
+        if (s->assigned_work > 0 && p->cpu == s->cpu_id) s->assigned_work--;
+        if (p->admitted && s->admit.backlog > 0) s->admit.backlog--;
+    }
+    if (p->remaining <= 0) p->work_acc = 0;
+    /* a fast core stops at the next fork: the rest of the tick is lost, as at a burst end */
+    if (p->fork_next < p->nforks && p->cpu_done >= p->forks[p->fork_next].at) p->work_acc = 0;
+    if (p->ncs) lock_progress(s, p);
+    return 1;
+}
+
+void scheduler_charge_dispatch(scheduler_t *s) {
+    if (!s || !s->running) return;
+    process_t *p = s->running;
+    unsigned long warmup = 0, migration = 0;
+
+    /* busy_ticks and run_ticks both advance while p runs, so their difference
+     * only grows with other processes' execution on this CPU */
+    unsigned long mark = s->busy_ticks - p->run_ticks;
+    int same_task = p->run_ticks > 0 && p->last_cpu == s->cpu_id && mark == p->cache_mark;
+    if (p->run_ticks > 0) {
+        if (p->last_cpu != s->cpu_id) {
+            warmup = s->cache_warmup;
+            migration = s->migration_cost;
+        } else {
+            unsigned long foreign = mark - p->cache_mark;
+            if (!s->cache_size || foreign >= s->cache_size) warmup = s->cache_warmup;
+            else warmup = (s->cache_warmup * foreign + s->cache_size - 1) / s->cache_size;
+        }
+    }
+    p->last_cpu = s->cpu_id;
+    p->cache_mark = mark;
+
+    if (p->woken) {
+        unsigned long latency = s->current_tick - p->wake_tick;
+        p->woken = 0;
+        p->wakeups++;
+        p->latency_total += latency;
+        if (latency > p->latency_max) p->latency_max = (unsigned int)latency;
+        s->wakeups++;
+        s->latency_total += latency;
+        if (latency > s->latency_max) s->latency_max = latency;
+    }
+
+    s->switch_left = same_task ? 0 : s->switch_cost;
+    s->warmup_left = warmup;
+    s->migration_left = migration;
+
+    /* the slice is armed on p's first tick, which may be the next one when
+     * a policy dispatches after this tick's work was charged */
+    s->dispatch_seq++;
+    s->slice_pending = 1;
+    tw_cancel(&s->timers, &s->slice_timer);
+}
+
+int scheduler_fast_forward(scheduler_t *s) {
+    if (!s || !s->quiet || !s->running || s->ready_head) return 0;
+    /* only the heap policies keep no per-tick state of their own */
+    if (s->algo != ALG_EDF && s->algo != ALG_RM && s->algo != ALG_CPF) return 0;
+    /* the governor may change the speed on any tick */
+    if (s->freq.cfg) return 0;
+    /* and a paging stall may come on any tick */
+    if (s->mem.capacity) return 0;
+    if (s->switch_left || s->migration_left || s->warmup_left || s->slice_pending) return 0;
+    if (s->timers.due.head || s->timers.now != s->current_tick) return 0;
+
+    /* ticks until the burst's last one, which is left to scheduler_tick() */
+    process_t *p = s->running;
+    if (p->ncs || s->locks.blocked || p->fork_next < p->nforks) return 0;
+    unsigned long work = (unsigned long)p->remaining * 100 - (unsigned long)p->work_acc;
+    unsigned long left = (work + s->speed - 1) / s->speed;
+    if (left < 2) return 0;
+
+    /* the first timer before then ends the stretch; it fires at the end of
+     * its tick, which p still runs */
+    unsigned long from = s->current_tick;
+    timer_node_t *chain = tw_advance(&s->timers, from + left - 1, 1);
+    unsigned long n = s->timers.now - from;
+
+    s->current_tick += n;
+    p->run_ticks += n;
+    s->busy_ticks += n;
+    p->work_acc += n * s->speed;
+    unsigned long done = p->work_acc / 100;
+    p->work_acc %= 100;
+    p->remaining -= (int)done;
+    p->cpu_done += (int)done;
+    if (p->cpu == s->cpu_id) s->assigned_work -= done < s->assigned_work ? done : s->assigned_work;
+    if (p->admitted) s->admit.backlog -= done < s->admit.backlog ? done : s->admit.backlog;
+    if (s->io_active) {
+        unsigned long first = s->io_busy_since > from + 1 ? s->io_busy_since : from + 1;
+        if (s->current_tick >= first) {
+            s->io_busy_ticks += s->current_tick - first + 1;
+            s->overlap_ticks += s->current_tick - first + 1;
+        }
+    }
+    fire_chain(s, chain);
+    return 1;
+}
+
+int scheduler_slice_left(const scheduler_t *s, const process_t *p) {
+    if (!s || !p || p->quantum_left <= 0) return 0;
+    if (p != s->running || !tw_armed(&s->slice_timer)) return p->quantum_left;
+    unsigned long last = s->slice_timer.expires + 1;
+    unsigned long left = last > s->current_tick ? last - s->current_tick : 0;
+    return left < (unsigned long)p->quantum_left ? (int)left : p->quantum_left;
+}
+
+unsigned long scheduler_useful_ticks(const scheduler_t *s) {
+    if (!s) return 0;
+    return s->busy_ticks - s->switch_ticks - s->warmup_ticks - s->migration_ticks - s->locks.spin_ticks - s->fork_ticks
+           - s->sync_ticks - s->mem.fault_ticks - s->mem.swap_ticks
+           - s->admit.shed_ticks;
+}
+
+void scheduler_leave(scheduler_t *s, process_t *p) {
+    if (!s || !p) return;
+    if (s->algo == ALG_LOTTERY || s->algo == ALG_STRIDE) lottery_leave(s, p);
+    if (s->algo == ALG_EEVDF) eevdf_leave(s, p);
+    if (s->algo == ALG_HFS) hfs_leave(s, p);
 }
 
 void scheduler_record_completed(scheduler_t *s, const process_t *p) {
     if (!s || !p) return;
+    if (periodic_job_done(s, p)) {
+        if (s->nr_assigned > 0) s->nr_assigned--;
+        return;
+    }
     if (!ensure_completed_capacity_local(s)) {
         return;
     }
+    if (s->nr_assigned > 0) s->nr_assigned--;
     completed_proc_t *slot = &s->completed[s->completed_count++];
     slot->pid = p->pid;
     slot->arrival = p->arrival;
-    slot->burst = p->burst;
+    slot->burst = p->cpu_total;
     slot->start_time = (p->start_time == UINT_MAX) ? p->finish_time : p->start_time;
     slot->finish_time = p->finish_time;
     slot->priority = p->priority;
+    slot->io_time = p->io_total;
+    slot->latency_max = p->latency_max;
+    slot->latency_avg = p->wakeups ? (double)p->latency_total / (double)p->wakeups : 0.0;
+    slot->max_lag = p->max_lag;
+    slot->deadline = p->deadline;
+    slot->tickets = 0;
+    slot->share_target = slot->share_achieved = 0.0;
+    if ((s->algo == ALG_LOTTERY || s->algo == ALG_STRIDE) && p->share_ticks) {
+        slot->tickets = lottery_tickets(p->priority);
+        slot->share_target = p->share_due / (double)p->share_ticks;
+        slot->share_achieved = (double)p->run_ticks / (double)p->share_ticks;
+    }
+    slot->mlq_class = s->algo == ALG_MLQ ? p->mlq_class : -1;
+    slot->group = s->algo == ALG_HFS ? p->group : -1;
+    slot->lock_blocked = p->lock_blocked;
+    slot->lock_inversion = p->lock_inversion;
+    slot->released = p->nafter ? p->released : UINT_MAX;
+    slot->ppid = p->ppid;
+    slot->forked = p->forked;
+    slot->fork_wait = p->fork_wait;
+    slot->width = p->width;
+    slot->energy = p->energy;
+    slot->working_set = p->working_set;
+    slot->fault_ticks = p->fault_ticks;
+    slot->swap_outs = p->swap_outs;
 }
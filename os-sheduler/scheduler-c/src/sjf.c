@@ -7,10 +7,7 @@
 #include "scheduler.h"
 #include "process.h"
 #include "utils.h"
-/* -- Fallback for PROC_FINISHED if not defined in headers -- */
-#ifndef PROC_FINISHED
-#define PROC_FINISHED 4
-#endif
+#include "predict.h"
 /* detach the process with the smallest burst time from s->ready_head.
  * This function also updates the process waited accounting (waited_total)
  * using s->current_tick. Returns the detached process (next == NULL).
@@ -24,9 +21,9 @@ static process_t *detach_shortest(scheduler_t *s) {
     process_t *best = cur;
     process_t *best_prev = NULL;
 
-    /* find shortest burst (use original burst; if you prefer remaining, change to remaining) */
+    /* find shortest burst (the estimate when bursts are predicted) */
     while (cur) {
-        if (!best || cur->burst < best->burst) {
+        if (!best || predict_burst(s, cur) < predict_burst(s, best)) {
             best = cur;
             best_prev = prev;
         }
@@ -44,16 +41,7 @@ static process_t *detach_shortest(scheduler_t *s) {
         best_prev->next = best->next;
     }
     best->next = NULL;
-
-    /* update waited accounting: add time since last enqueued till now */
-    if (best->last_enqueued_tick != UINT_MAX) {
-        if (s->current_tick >= best->last_enqueued_tick) {
-            best->waited_total += (unsigned int)(s->current_tick - best->last_enqueued_tick);
-        }
-        best->last_enqueued_tick = UINT_MAX;
-    }
-
-    return best;
+    return scheduler_take(s, best);
 }
 
 /* Called by scheduler loop each tick when SJF is the chosen algorithm. */
@@ -64,6 +52,7 @@ void sjf_tick(scheduler_t *s) {
     if (!s->running && s->ready_head) {
         process_t *p = detach_shortest(s);
         if (p) {
+            predict_note_choice(s, p);
             p->next = NULL;
             s->running = p;
             p->state = PROC_RUNNING;
@@ -89,24 +78,12 @@ void sjf_tick(scheduler_t *s) {
         char *ev_slice = utils_build_event(EVT_GANTT_SLICE, s, s->running, NULL);
         utils_emit_event_and_free(ev_slice, EVT_GANTT_SLICE, s);
 
-        /* decrement remaining; note: remaining is int in many implementations */
-        if (s->running->remaining > 0) {
-            s->running->remaining--;
-        }
+        /* charge the tick; progress scales with the CPU speed */
+        scheduler_consume(s, s->running);
 
-        /* if finished, emit job finished and record it */
+        /* if the burst is done, the job finishes (recorded and freed) or blocks for I/O */
         if (s->running->remaining == 0) {
-            s->running->state = PROC_FINISHED;
-            s->running->finish_time = (unsigned int)s->current_tick;
-
-            char *ev_fin = utils_build_event(EVT_JOB_FINISHED, s, s->running, NULL);
-            utils_emit_event_and_free(ev_fin, EVT_JOB_FINISHED, s);
-
-            /* snapshot completed process metrics */
-            scheduler_record_completed(s, s->running);
-
-            /* clear running slot */
-            s->running = NULL;
+            scheduler_finish_burst(s);
         }
     }
 }
@@ -0,0 +1,559 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include "../include/smp.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+#include "../include/lottery.h"
+#include "../include/gang.h"
+
+/* Reusable barrier (pthread_barrier_t is not available everywhere) */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count;
+    int waiting;
+    unsigned long generation;
+} epoch_barrier_t;
+
+static void barrier_wait(epoch_barrier_t *b) {
+    pthread_mutex_lock(&b->lock);
+    unsigned long gen = b->generation;
+    if (++b->waiting >= b->count) {
+        b->waiting = 0;
+        b->generation++;
+        pthread_cond_broadcast(&b->cond);
+    } else {
+        while (gen == b->generation) pthread_cond_wait(&b->cond, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
+/* Epoch parameters, written by the main thread between barriers */
+typedef struct {
+    smp_t *m;
+    epoch_barrier_t barrier;
+    unsigned long until;   // window end (exclusive tick bound)
+    int drain;             // no arrivals left: run every CPU until idle
+    int stop;
+    scheduler_t **busy;    // CPUs with work, the only ones advanced and flushed
+    int nbusy;
+    int sorted;            // busy is in CPU order
+    char *listed;          // by CPU: on busy
+} epoch_t;
+
+typedef struct {
+    epoch_t *epoch;
+    int first, last;       // range [first, last) of the busy CPUs
+    pthread_t thread;
+} worker_t;
+
+smp_t *smp_create(sched_algo_t algo, int ncpus, int nthreads) {
+    if (ncpus < 1) ncpus = 1;
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > ncpus) nthreads = ncpus;
+
+    smp_t *m = (smp_t *)calloc(1, sizeof(smp_t));
+    if (!m) return NULL;
+    m->cpus = (scheduler_t **)calloc((size_t)ncpus, sizeof(scheduler_t *));
+    if (!m->cpus) {
+        free(m);
+        return NULL;
+    }
+    m->ncpus = ncpus;
+    m->nthreads = nthreads;
+    m->placement = PLACE_LEAST_LOADED;
+    for (int i = 0; i < ncpus; ++i) {
+        scheduler_t *s = scheduler_create(algo);
+        if (!s) {
+            smp_destroy(m);
+            return NULL;
+        }
+        s->cpu_id = i;
+        s->buffered = 1;
+        m->cpus[i] = s;
+    }
+    return m;
+}
+
+void smp_destroy(smp_t *m) {
+    if (!m) return;
+    if (m->cpus) {
+        for (int i = 0; i < m->ncpus; ++i) scheduler_destroy(m->cpus[i]);
+        free(m->cpus);
+    }
+    free(m);
+}
+
+long smp_parse_speeds(const char *spec, unsigned int *speeds, int n) {
+    if (!spec) return -1;
+    long cpu = 0;
+    const char *p = spec;
+    while (*p) {
+        char *end;
+        unsigned long count = 1, speed = strtoul(p, &end, 10);
+        if (end == p) return -1;
+        if (*end == 'x') {
+            count = speed;
+            p = end + 1;
+            speed = strtoul(p, &end, 10);
+            if (end == p) return -1;
+        }
+        if (speed == 0 || speed > UINT_MAX) return -1;
+        for (long i = cpu; i < n && (unsigned long)(i - cpu) < count; ++i) speeds[i] = (unsigned int)speed;
+        cpu = count > (unsigned long)(LONG_MAX - cpu) ? LONG_MAX : cpu + (long)count;
+        p = end;
+        if (*p == ',') p++;
+        else if (*p) return -1;
+    }
+    return cpu;
+}
+
+long smp_set_speeds(smp_t *m, const char *spec) {
+    if (!m || !spec) return -1;
+    unsigned int *speeds = (unsigned int *)malloc((size_t)m->ncpus * sizeof(unsigned int));
+    if (!speeds) return -1;
+    for (int i = 0; i < m->ncpus; ++i) speeds[i] = m->cpus[i]->speed;
+    long listed = smp_parse_speeds(spec, speeds, m->ncpus);
+    if (listed >= 0)
+        for (int i = 0; i < m->ncpus; ++i) m->cpus[i]->speed = speeds[i];
+    free(speeds);
+    return listed;
+}
+
+static int idle(const scheduler_t *s) {
+    return scheduler_idle(s);
+}
+
+/* (a_work + b) / a_speed < (b_work + b) / b_speed, without division */
+static int finishes_earlier(const scheduler_t *a, const scheduler_t *b, unsigned long burst) {
+    return (a->assigned_work + burst) * b->speed < (b->assigned_work + burst) * a->speed;
+}
+
+static scheduler_t *place(smp_t *m, const process_t *p) {
+    if (m->placement == PLACE_ROUND_ROBIN) {
+        scheduler_t *s = m->cpus[m->next_cpu];
+        m->next_cpu = (m->next_cpu + 1) % m->ncpus;
+        return s;
+    }
+    scheduler_t *best = m->cpus[0];
+    for (int i = 1; i < m->ncpus; ++i) {
+        if (m->placement == PLACE_CAPACITY) {
+            if (finishes_earlier(m->cpus[i], best, (unsigned long)p->remaining)) best = m->cpus[i];
+        } else if (m->cpus[i]->nr_assigned < best->nr_assigned) {
+            best = m->cpus[i];
+        }
+    }
+    return best;
+}
+
+/* An idle CPU may lag behind the epoch boundary; bring it up to 'now'
+ * before handing it work. Ticking it would only bump current_tick.
+ */
+static void sync_cpu(scheduler_t *s, unsigned long now) {
+    if (idle(s) && s->current_tick < now) scheduler_skip_idle(s, now);
+}
+
+/* s has work: advance it from now on */
+static void mark_busy(epoch_t *e, scheduler_t *s) {
+    if (e->listed[s->cpu_id]) return;
+    e->listed[s->cpu_id] = 1;
+    if (e->nbusy && e->busy[e->nbusy - 1]->cpu_id > s->cpu_id) e->sorted = 0;
+    e->busy[e->nbusy++] = s;
+}
+
+static int cmp_cpu_id(const void *a, const void *b) {
+    return (*(scheduler_t *const *)a)->cpu_id - (*(scheduler_t *const *)b)->cpu_id;
+}
+
+/* Hand p to a CPU at tick now. A later arrival (in the placement window) is
+ * placed now and fires on the CPU's timers. */
+static void inject(epoch_t *e, process_t *p, unsigned long now) {
+    smp_t *m = e->m;
+    scheduler_t *s = place(m, p);
+    sync_cpu(s, now);
+    mark_busy(e, s);
+    if (p->arrival > now) {
+        p->cpu = s->cpu_id;
+        s->nr_assigned++;
+        s->assigned_work += (unsigned long)p->remaining;
+        scheduler_schedule_arrival(s, p);
+        return;
+    }
+    char info[128];
+    if (p->nafter)
+        snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%u, \"released\":%u", p->pid, p->arrival, p->released);
+    else
+        snprintf(info, sizeof(info), "\"pid\":%d, \"arrival\":%u", p->pid, p->arrival);
+    char *ev = utils_build_event(EVT_JOB_RESUMED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_RESUMED, s);
+    scheduler_add_process(s, p);
+}
+
+/* The CPUs finished their graph jobs at the epoch boundary 'now': inject the
+ * dependants that were only waiting for them, CPU by CPU. Returns how many. */
+static int release_dependants(epoch_t *e, unsigned long now) {
+    smp_t *m = e->m;
+    int released = 0;
+    for (int c = 0; c < m->ncpus; ++c) {
+        scheduler_t *s = m->cpus[c];
+        for (size_t i = 0; i < s->dag_done_len; ++i) {
+            process_t *p = dag_finish(m->dag, s->dag_done[i], now);
+            while (p) {
+                process_t *n = p->next;
+                p->next = NULL;
+                inject(e, p, now);
+                released++;
+                p = n;
+            }
+        }
+        s->dag_done_len = 0;
+    }
+    return released;
+}
+
+/* Move s->running of src to the ready queue of dst */
+static void migrate(epoch_t *e, scheduler_t *src, scheduler_t *dst, unsigned long now) {
+    smp_t *m = e->m;
+    process_t *p = src->running;
+    char info[128];
+    snprintf(info, sizeof(info), "\"reason\":\"migrate\", \"to_cpu\":%d", dst->cpu_id);
+    char *ev = utils_build_event(EVT_JOB_PREEMPTED, src, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_PREEMPTED, src);
+
+    if (src->algo == ALG_LOTTERY || src->algo == ALG_STRIDE) lottery_leave(src, p);
+    if (src->algo == ALG_HFS) hfs_leave(src, p);
+    src->running = NULL;
+    if (src->nr_assigned > 0) src->nr_assigned--;
+    src->assigned_work -= (unsigned long)p->remaining;
+    p->state = PROC_READY;
+    sync_cpu(dst, now);
+    mark_busy(e, dst);
+    scheduler_add_process(dst, p);
+    m->migrations++;
+}
+
+static int cmp_speed_desc(const void *a, const void *b) {
+    const scheduler_t *x = *(scheduler_t *const *)a, *y = *(scheduler_t *const *)b;
+    if (x->speed != y->speed) return x->speed > y->speed ? -1 : 1;
+    return x->cpu_id - y->cpu_id;
+}
+
+static int cmp_speed_asc(const void *a, const void *b) {
+    const scheduler_t *x = *(scheduler_t *const *)a, *y = *(scheduler_t *const *)b;
+    if (x->speed != y->speed) return x->speed < y->speed ? -1 : 1;
+    return x->cpu_id - y->cpu_id;
+}
+
+/* Pair the fastest idle CPUs with the slowest CPUs running a long job */
+static void migrate_up(epoch_t *e, unsigned long now) {
+    smp_t *m = e->m;
+    scheduler_t **targets = (scheduler_t **)malloc((size_t)m->ncpus * sizeof(scheduler_t *));
+    scheduler_t **sources = (scheduler_t **)malloc((size_t)m->ncpus * sizeof(scheduler_t *));
+    int nt = 0, ns = 0;
+    if (!targets || !sources) {
+        free(targets);
+        free(sources);
+        return;
+    }
+    for (int i = 0; i < e->nbusy; ++i) {
+        scheduler_t *s = e->busy[i];
+        /* a job and the children it waits for stay together: the wakeup is local to a CPU */
+        if (s->running && s->running->run_ticks >= m->migrate_up &&
+            !s->running->fork_parent && !s->running->fork_children) sources[ns++] = s;
+    }
+    /* idle CPUs are only looked for when a job could move */
+    for (int i = 0; ns && i < m->ncpus; ++i) {
+        if (idle(m->cpus[i])) targets[nt++] = m->cpus[i];
+    }
+    qsort(targets, (size_t)nt, sizeof(scheduler_t *), cmp_speed_desc);
+    qsort(sources, (size_t)ns, sizeof(scheduler_t *), cmp_speed_asc);
+    for (int t = 0, k = 0; t < nt && k < ns; ++t, ++k) {
+        if (sources[k]->speed >= targets[t]->speed) break;
+        migrate(e, sources[k], targets[t], now);
+    }
+    free(targets);
+    free(sources);
+}
+
+/* Advance one busy CPU to the end of the window, or until it goes idle
+ * with no arrival left to fire */
+static void advance_cpu(scheduler_t *s, unsigned long until, int drain) {
+    for (;;) {
+        if (!drain && s->current_tick >= until) return;
+        if (!idle(s)) scheduler_tick(s);
+        else if (s->pending_arrivals) scheduler_skip_idle(s, drain ? ULONG_MAX : until);
+        else return;
+    }
+}
+
+static void run_range(epoch_t *e, int first, int last) {
+    for (int i = first; i < last; ++i) advance_cpu(e->busy[i], e->until, e->drain);
+}
+
+static void *worker_main(void *arg) {
+    worker_t *w = (worker_t *)arg;
+    epoch_t *e = w->epoch;
+    for (;;) {
+        barrier_wait(&e->barrier);
+        if (e->stop) break;
+        run_range(e, w->first, w->last);
+        barrier_wait(&e->barrier);
+    }
+    return NULL;
+}
+
+/* stable sort by arrival: ties keep workload order */
+typedef struct {
+    process_t *p;
+    int idx;
+} arrival_key_t;
+
+static int cmp_arrival(const void *a, const void *b) {
+    const arrival_key_t *x = (const arrival_key_t *)a, *y = (const arrival_key_t *)b;
+    if (x->p->arrival != y->p->arrival) return x->p->arrival < y->p->arrival ? -1 : 1;
+    return x->idx - y->idx;
+}
+
+static int sort_by_arrival(process_t **pending, int count) {
+    arrival_key_t *keys = (arrival_key_t *)malloc((size_t)count * sizeof(arrival_key_t));
+    if (!keys) return -1;
+    for (int i = 0; i < count; ++i) {
+        keys[i].p = pending[i];
+        keys[i].idx = i;
+    }
+    qsort(keys, (size_t)count, sizeof(arrival_key_t), cmp_arrival);
+    for (int i = 0; i < count; ++i) pending[i] = keys[i].p;
+    free(keys);
+    return 0;
+}
+
+int smp_run(smp_t *m, process_t **pending, int count) {
+    if (!m || !pending) return 0;
+    if (sort_by_arrival(pending, count) < 0) {
+        fprintf(stderr, "Error: out of memory sorting workload\n");
+        return 0;
+    }
+    if (m->gang) return gang_run(m, pending, count);
+    /* each CPU lists the graph jobs it finished; a list never outgrows the graph */
+    unsigned int top_speed = 0;
+    for (int c = 0; c < m->ncpus; ++c) {
+        if (m->cpus[c]->speed > top_speed) top_speed = m->cpus[c]->speed;
+        if (!m->dag || !m->dag->n) continue;
+        m->cpus[c]->dag_done = (int *)malloc((size_t)m->dag->n * sizeof(int));
+        if (!m->cpus[c]->dag_done) {
+            fprintf(stderr, "Error: out of memory tracking job dependencies\n");
+            for (int i = 0; i < count; ++i) process_free(pending[i]);
+            return 0;
+        }
+    }
+
+    epoch_t e;
+    memset(&e, 0, sizeof(e));
+    e.m = m;
+    e.sorted = 1;
+    e.busy = (scheduler_t **)malloc((size_t)m->ncpus * sizeof(scheduler_t *));
+    e.listed = (char *)calloc((size_t)m->ncpus, 1);
+    if (!e.busy || !e.listed) {
+        fprintf(stderr, "Error: out of memory tracking busy CPUs\n");
+        free(e.busy);
+        free(e.listed);
+        for (int i = 0; i < count; ++i) process_free(pending[i]);
+        return 0;
+    }
+
+    worker_t *workers = NULL;
+    if (m->nthreads > 1) {
+        workers = (worker_t *)calloc((size_t)m->nthreads, sizeof(worker_t));
+        if (!workers) m->nthreads = 1;
+    }
+    pthread_mutex_init(&e.barrier.lock, NULL);
+    pthread_cond_init(&e.barrier.cond, NULL);
+    e.barrier.count = m->nthreads;
+
+    int started = 1; /* the calling thread is worker 0 */
+    for (int t = 1; t < m->nthreads; ++t) {
+        workers[t].epoch = &e;
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) break;
+        started++;
+    }
+    if (started < m->nthreads) {
+        fprintf(stderr, "Warning: started %d of %d host threads\n", started, m->nthreads);
+        pthread_mutex_lock(&e.barrier.lock);
+        e.barrier.count = started;
+        pthread_mutex_unlock(&e.barrier.lock);
+        m->nthreads = started;
+    }
+    /* graph jobs are released on the tick their last predecessor finishes,
+     * so they are not placed ahead of their arrival */
+    unsigned long window = m->dag ? 1 : m->window ? m->window : 1;
+    unsigned long now = 0;
+    int next = 0, injected = 0;
+    for (;;) {
+        /* Inject arrivals of the window; every busy CPU sits exactly at 'now' here */
+        while (next < count && pending[next]->arrival < now + window) {
+            process_t *p = pending[next++];
+            if (m->dag && p->dag_idx >= 0 && !dag_arrive(m->dag, p)) continue;   // held until its predecessors finish
+            inject(&e, p, now);
+            injected++;
+        }
+
+        if (m->migrate_up && now > 0) migrate_up(&e, now);
+
+        /* held jobs wait on running ones: stop when the first of those could finish */
+        int held = m->dag && m->dag->unreleased;
+        e.drain = (next >= count) && !held;
+        e.until = e.drain ? now : next < count ? pending[next]->arrival : ULONG_MAX;
+        if (held) {
+            unsigned long t = dag_next_finish(m->dag, now, top_speed);
+            if (t < e.until) e.until = t;
+            if (e.until == ULONG_MAX) e.drain = 1;   // nothing left that could release them
+        }
+        if (m->migrate_up) {
+            /* while jobs run, bound the epoch so they are checked every migrate_up ticks */
+            if (e.drain && !e.nbusy) break;
+            if (e.nbusy && (e.drain || now + m->migrate_up < e.until)) {
+                e.until = now + m->migrate_up;
+                e.drain = 0;
+            }
+        }
+
+        /* events are written in CPU order */
+        if (!e.sorted) qsort(e.busy, (size_t)e.nbusy, sizeof(scheduler_t *), cmp_cpu_id);
+        e.sorted = 1;
+        if (m->nthreads > 1) {
+            /* workers read their range only after the first barrier */
+            for (int t = 0; t < m->nthreads; ++t) {
+                workers[t].first = (int)((long)t * e.nbusy / m->nthreads);
+                workers[t].last = (int)((long)(t + 1) * e.nbusy / m->nthreads);
+            }
+            barrier_wait(&e.barrier);
+            run_range(&e, workers[0].first, workers[0].last);
+            barrier_wait(&e.barrier);
+        } else {
+            run_range(&e, 0, e.nbusy);
+        }
+
+        /* only busy CPUs buffered events; drop those that went idle */
+        int kept = 0;
+        for (int i = 0; i < e.nbusy; ++i) {
+            scheduler_t *s = e.busy[i];
+            utils_flush_events(s);
+            if (!idle(s) || s->pending_arrivals) e.busy[kept++] = s;
+            else e.listed[s->cpu_id] = 0;
+        }
+        e.nbusy = kept;
+        m->epochs++;
+        if (e.drain) break;
+        now = e.until;
+        if (m->dag) injected += release_dependants(&e, now);
+    }
+
+    if (m->nthreads > 1) {
+        e.stop = 1;
+        barrier_wait(&e.barrier);
+        for (int t = 1; t < m->nthreads; ++t) pthread_join(workers[t].thread, NULL);
+    }
+    free(workers);
+    free(e.busy);
+    free(e.listed);
+    for (int c = 0; c < m->ncpus; ++c) injected += (int)m->cpus[c]->forked;
+    pthread_cond_destroy(&e.barrier.cond);
+    pthread_mutex_destroy(&e.barrier.lock);
+    return injected;
+}
+
+unsigned long smp_ticks(const smp_t *m) {
+    unsigned long t = 0;
+    if (!m) return 0;
+    for (int i = 0; i < m->ncpus; ++i) {
+        if (m->cpus[i]->current_tick > t) t = m->cpus[i]->current_tick;
+    }
+    return t;
+}
+
+scheduler_t *smp_collect(const smp_t *m) {
+    if (!m) return NULL;
+    scheduler_t *agg = scheduler_create(m->cpus[0]->algo);
+    if (!agg) return NULL;
+    size_t total = 0;
+    for (int i = 0; i < m->ncpus; ++i) total += m->cpus[i]->completed_count;
+    if (total) {
+        agg->completed = (completed_proc_t *)malloc(total * sizeof(completed_proc_t));
+        if (!agg->completed) {
+            scheduler_destroy(agg);
+            return NULL;
+        }
+        agg->completed_capacity = total;
+    }
+    for (int i = 0; i < m->ncpus; ++i) {
+        const scheduler_t *s = m->cpus[i];
+        if (s->completed_count) {
+            memcpy(agg->completed + agg->completed_count, s->completed,
+                   s->completed_count * sizeof(completed_proc_t));
+            agg->completed_count += s->completed_count;
+        }
+        agg->context_switches += s->context_switches;
+        agg->busy_ticks += s->busy_ticks;
+        agg->io_busy_ticks += s->io_busy_ticks;
+        agg->overlap_ticks += s->overlap_ticks;
+        agg->io_requests += s->io_requests;
+        agg->io_wait_total += s->io_wait_total;
+        if (s->io_wait_max > agg->io_wait_max) agg->io_wait_max = s->io_wait_max;
+        agg->seek_distance += s->seek_distance;
+        agg->seek_ticks += s->seek_ticks;
+        agg->io_overdue += s->io_overdue;
+        agg->predictions += s->predictions;
+        agg->predict_abs_error += s->predict_abs_error;
+        agg->predict_bias += s->predict_bias;
+        agg->inversions += s->inversions;
+        agg->inversion_ticks += s->inversion_ticks;
+        agg->wakeups += s->wakeups;
+        agg->latency_total += s->latency_total;
+        if (s->latency_max > agg->latency_max) agg->latency_max = s->latency_max;
+        agg->switch_ticks += s->switch_ticks;
+        agg->warmup_ticks += s->warmup_ticks;
+        agg->migration_ticks += s->migration_ticks;
+        agg->forked += s->forked;
+        agg->fork_ticks += s->fork_ticks;
+        agg->sync_ticks += s->sync_ticks;
+    }
+    agg->disk_policy = m->cpus[0]->disk_policy;
+    agg->predict = m->cpus[0]->predict;
+    agg->alpha = m->cpus[0]->alpha;
+    agg->tau0 = m->cpus[0]->tau0;
+    if (agg->algo == ALG_MLQ) {
+        /* every CPU runs the same classes; add up the time each got */
+        agg->mlq = m->cpus[0]->mlq;
+        agg->mlq.queued = 0;
+        for (int c = 0; c < agg->mlq.n; ++c) {
+            agg->mlq.classes[c].head = NULL;
+            agg->mlq.classes[c].queued = 0;
+            agg->mlq.classes[c].cpu_ticks = 0;
+            for (int i = 0; i < m->ncpus; ++i) agg->mlq.classes[c].cpu_ticks += m->cpus[i]->mlq.classes[c].cpu_ticks;
+        }
+    }
+    if (agg->algo == ALG_HFS && group_copy(&agg->groups, &m->cpus[0]->groups) == 0) {
+        /* the same groups on every CPU; add up what each got and was owed */
+        for (int g = 0; g < agg->groups.n; ++g) {
+            group_t *dst = &agg->groups.v[g];
+            dst->cpu_ticks = dst->runnable_ticks = 0;
+            dst->due = 0.0;
+            dst->nr_periods = dst->nr_throttled = dst->throttled_ticks = 0;
+            for (int i = 0; i < m->ncpus; ++i) {
+                const group_t *src = &m->cpus[i]->groups.v[g];
+                dst->cpu_ticks += src->cpu_ticks;
+                dst->runnable_ticks += src->runnable_ticks;
+                dst->due += src->due;
+                dst->nr_periods += src->nr_periods;
+                dst->nr_throttled += src->nr_throttled;
+                dst->throttled_ticks += src->throttled_ticks;
+            }
+        }
+        for (int i = 0; i < m->ncpus; ++i) agg->groups.throttled_idle += m->cpus[i]->groups.throttled_idle;
+    }
+    agg->current_tick = smp_ticks(m);
+    return agg;
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/spawn.h"
+#include "../include/scheduler.h"
+#include "../include/utils.h"
+
+int spawn_parse(const char *spec, fork_spec_t *out, int max) {
+    int n = 0;
+    const char *p = spec;
+    while (*p) {
+        while (*p == ' ' || *p == ',') p++;
+        if (!*p) break;
+        if (n == max) return -1;
+        char *end;
+        long at = strtol(p, &end, 10);
+        if (end == p || *end != '+' || at < 0) return -1;
+        p = end + 1;
+        long burst = strtol(p, &end, 10);
+        if (end == p || burst < 1) return -1;
+        p = end;
+        long count = 1;
+        if (*p == 'x') {
+            count = strtol(p + 1, &end, 10);
+            if (end == p + 1 || count < 1 || count > SPAWN_MAX_COUNT) return -1;
+            p = end;
+        }
+        int wait = 0;
+        if (*p == 'w') {
+            wait = 1;
+            p++;
+        }
+        while (*p == ' ') p++;
+        if (*p && *p != ',') return -1;
+
+        out[n].at = (int)at;
+        out[n].burst = (int)burst;
+        out[n].count = (int)count;
+        out[n].wait = wait;
+        out[n].first_pid = -1;
+        n++;
+    }
+    return n;
+}
+
+int spawn_fork(scheduler_t *s, process_t *p) {
+    if (p->fork_next >= p->nforks || p->cpu_done < p->forks[p->fork_next].at) return 0;
+
+    /* every fork due at this point of its work is made in the same tick */
+    int made = 0, first = -1;
+    while (p->fork_next < p->nforks && p->cpu_done >= p->forks[p->fork_next].at) {
+        const fork_spec_t *f = &p->forks[p->fork_next++];
+        for (int k = 0; k < f->count; ++k) {
+            process_t *c = process_create(f->first_pid + k, (unsigned int)s->current_tick, f->burst, p->base_priority);
+            if (!c) {
+                fprintf(stderr, "Warning: pid %d: out of memory forking a child\n", p->pid);
+                continue;
+            }
+            c->ppid = p->pid;
+            c->mlq_class = p->mlq_class;
+            c->group = p->group;
+            if (f->wait) {
+                c->fork_parent = p;
+                p->fork_children++;
+            }
+            if (first < 0) first = c->pid;
+            made++;
+            scheduler_schedule_arrival(s, c);
+        }
+    }
+    p->forked += made;
+    s->forked += (unsigned long)made;
+    s->fork_ticks++;
+
+    char info[96];
+    snprintf(info, sizeof(info), "\"children\":%d, \"first_pid\":%d, \"wait\":%s",
+             made, first, p->fork_children ? "true" : "false");
+    char *ev = utils_build_event(EVT_JOB_FORKED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_FORKED, s);
+    return 1;
+}
+
+void spawn_tick(scheduler_t *s) {
+    process_t *p = s->running;
+    if (!p || !p->fork_children) return;
+
+    scheduler_leave(s, p);
+    s->running = NULL;
+    p->state = PROC_WAITING;
+    char info[64];
+    snprintf(info, sizeof(info), "\"children\":%d", p->fork_children);
+    char *ev = utils_build_event(EVT_JOB_BLOCKED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_BLOCKED, s);
+    p->fork_since = s->current_tick;
+    p->next = s->fork_waiters;
+    s->fork_waiters = p;
+}
+
+void spawn_child_done(scheduler_t *s, process_t *child) {
+    process_t *p = child->fork_parent;
+    child->fork_parent = NULL;
+    if (--p->fork_children > 0 || p->state != PROC_WAITING) return;
+
+    process_t **link = &s->fork_waiters;
+    while (*link && *link != p) link = &(*link)->next;
+    if (!*link) return;
+    *link = p->next;
+    p->next = NULL;
+    p->fork_wait += (unsigned int)(s->current_tick - p->fork_since);
+
+    char info[64];
+    snprintf(info, sizeof(info), "\"reason\":\"children\", \"last_child\":%d", child->pid);
+    char *ev = utils_build_event(EVT_JOB_RESUMED, s, p, info);
+    utils_emit_event_and_free(ev, EVT_JOB_RESUMED, s);
+    scheduler_add_process(s, p);
+}
+
+void spawn_clear(scheduler_t *s) {
+    if (!s) return;
+    while (s->fork_waiters) {
+        process_t *n = s->fork_waiters->next;
+        process_free(s->fork_waiters);
+        s->fork_waiters = n;
+    }
+}
@@ -4,15 +4,17 @@
 #include "../include/srtf.h"
 #include "../include/utils.h"
 #include "../include/scheduler.h"
+#include "../include/predict.h"
 
-/* detach shortest remaining */
-static process_t *detach_shortest_remaining(process_t **head) {
+/* detach shortest remaining (the estimate when bursts are predicted) */
+static process_t *detach_shortest_remaining(const scheduler_t *s, process_t **head) {
     if (!head || !*head) return NULL;
     process_t *best = *head, *best_prev = NULL, *prev = *head, *cur = (*head)->next;
     while (cur) {
         int better = 0;
-        if (cur->remaining < best->remaining) better = 1;
-        else if (cur->remaining == best->remaining) {
+        int cur_left = predict_remaining(s, cur), best_left = predict_remaining(s, best);
+        if (cur_left < best_left) better = 1;
+        else if (cur_left == best_left) {
             if (cur->arrival < best->arrival) better = 1;
             else if (cur->arrival == best->arrival && cur->pid < best->pid) better = 1;
         }
@@ -48,8 +50,9 @@ void srtf_tick(scheduler_t *s) {
         process_t *cur = s->ready_head;
         process_t *best = cur;
         while (cur) {
-            if (cur->remaining < best->remaining ||
-               (cur->remaining == best->remaining && (cur->arrival < best->arrival ||
+            int cur_left = predict_remaining(s, cur), best_left = predict_remaining(s, best);
+            if (cur_left < best_left ||
+               (cur_left == best_left && (cur->arrival < best->arrival ||
                (cur->arrival == best->arrival && cur->pid < best->pid)))) {
                 best = cur;
             }
@@ -59,9 +62,10 @@ void srtf_tick(scheduler_t *s) {
     }
 
     if (s->running && candidate) {
-        if (candidate->remaining < s->running->remaining) {
-            process_t *det = detach_shortest_remaining(&s->ready_head);
+        if (predict_remaining(s, candidate) < predict_remaining(s, s->running)) {
+            process_t *det = detach_shortest_remaining(s, &s->ready_head);
             if (det) {
+                predict_note_choice(s, det);
                 char info_pre[128];
                 snprintf(info_pre, sizeof(info_pre), "\"preempted_by\":%d", det->pid);
                 char *ev = utils_build_event(EVT_JOB_PREEMPTED, s, s->running, info_pre);
@@ -81,8 +85,9 @@ void srtf_tick(scheduler_t *s) {
             }
         }
     } else if (!s->running && s->ready_head) {
-        process_t *p = detach_shortest_remaining(&s->ready_head);
+        process_t *p = detach_shortest_remaining(s, &s->ready_head);
         if (p) {
+            predict_note_choice(s, p);
             s->running = p;
             p->state = PROC_RUNNING;
             if (p->start_time == UINT_MAX) p->start_time = s->current_tick;
@@ -94,20 +99,12 @@ void srtf_tick(scheduler_t *s) {
     }
 
     if (s->running) {
-        if (s->running->remaining > 0) s->running->remaining -= 1;
+        scheduler_consume(s, s->running);
         char info[128];
         snprintf(info, sizeof(info), "\"pid\":%d, \"remaining\":%d", s->running->pid, s->running->remaining);
         char *ev = utils_build_event(EVT_GANTT_SLICE, s, s->running, info);
         utils_emit_event_and_free(ev, EVT_GANTT_SLICE, s);
 
-        if (s->running->remaining <= 0) {
-            s->running->state = PROC_TERMINATED;
-            s->running->finish_time = s->current_tick;
-            ev = utils_build_event(EVT_JOB_FINISHED, s, s->running, NULL);
-            utils_emit_event_and_free(ev, EVT_JOB_FINISHED, s);
-            scheduler_record_completed(s, s->running);
-            process_free(s->running);
-            s->running = NULL;
-        }
+        if (s->running->remaining <= 0) scheduler_finish_burst(s);
     }
 }
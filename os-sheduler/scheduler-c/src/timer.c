@@ -0,0 +1,135 @@
+#include <string.h>
+#include "../include/timer.h"
+
+static void list_append(timer_list_t *l, timer_node_t *t) {
+    t->list = l;
+    t->next = NULL;
+    t->prev = l->tail;
+    if (l->tail) l->tail->next = t;
+    else l->head = t;
+    l->tail = t;
+}
+
+static void list_unlink(timer_list_t *l, timer_node_t *t) {
+    if (t->prev) t->prev->next = t->next;
+    else l->head = t->next;
+    if (t->next) t->next->prev = t->prev;
+    else l->tail = t->prev;
+    t->prev = t->next = NULL;
+    t->list = NULL;
+}
+
+/* Chain l onto the end of the singly linked out list and empty l */
+static void list_move_out(timer_list_t *l, timer_node_t **out_head, timer_node_t **out_tail) {
+    if (!l->head) return;
+    for (timer_node_t *t = l->head; t; t = t->next) t->list = NULL;
+    if (*out_tail) (*out_tail)->next = l->head;
+    else *out_head = l->head;
+    *out_tail = l->tail;
+    l->head = l->tail = NULL;
+}
+
+void tw_init(timer_wheel_t *tw, unsigned long now) {
+    memset(tw, 0, sizeof(*tw));
+    tw->now = now;
+}
+
+/* Cascaded timers may be due on the current tick; they go to its level-0
+ * slot, which is expired right after the cascade. */
+static void place(timer_wheel_t *tw, timer_node_t *t, int cascading) {
+    if (t->expires < tw->now || (t->expires == tw->now && !cascading)) {
+        t->level = -1;
+        list_append(&tw->due, t);
+        return;
+    }
+    unsigned long delta = t->expires - tw->now;   // 0 only when cascading
+    int level = 0;
+    while (level < TW_LEVELS - 1 && delta >= (1UL << (TW_BITS * (level + 1)))) level++;
+    size_t slot = (t->expires >> (TW_BITS * level)) & TW_MASK;
+    t->level = level;
+    tw->level_count[level]++;
+    list_append(&tw->slots[level][slot], t);
+}
+
+void tw_schedule(timer_wheel_t *tw, timer_node_t *t, unsigned long expires) {
+    if (t->list) tw_cancel(tw, t);
+    t->expires = expires;
+    tw->count++;
+    place(tw, t, 0);
+}
+
+void tw_cancel(timer_wheel_t *tw, timer_node_t *t) {
+    if (!t->list) return;
+    if (t->level >= 0) tw->level_count[t->level]--;
+    list_unlink(t->list, t);
+    tw->count--;
+}
+
+/* On a level boundary, re-place the timers of the slot that just came due */
+static void cascade(timer_wheel_t *tw) {
+    for (int level = 1; level < TW_LEVELS; ++level) {
+        if (tw->now & ((1UL << (TW_BITS * level)) - 1)) break;
+        timer_list_t *l = &tw->slots[level][(tw->now >> (TW_BITS * level)) & TW_MASK];
+        timer_node_t *t = l->head;
+        l->head = l->tail = NULL;
+        while (t) {
+            timer_node_t *n = t->next;
+            tw->level_count[level]--;
+            place(tw, t, 1);
+            t = n;
+        }
+    }
+}
+
+timer_node_t *tw_advance(timer_wheel_t *tw, unsigned long upto, int stop_early) {
+    timer_node_t *head = NULL, *tail = NULL;
+
+    if (tw->due.head) {
+        for (timer_node_t *t = tw->due.head; t; t = t->next) tw->count--;
+        list_move_out(&tw->due, &head, &tail);
+        if (stop_early) return head;
+    }
+
+    while (tw->now < upto) {
+        if (tw->count == 0) {
+            tw->now = upto;
+            break;
+        }
+        /* nothing fires before the next slot boundary of the lowest busy level */
+        int level = 0;
+        while (level < TW_LEVELS - 1 && tw->level_count[level] == 0) level++;
+        if (level > 0) {
+            unsigned long span = 1UL << (TW_BITS * level);
+            unsigned long boundary = (tw->now | (span - 1)) + 1;
+            if (boundary == 0 || boundary > upto) {
+                tw->now = upto;
+                break;
+            }
+            tw->now = boundary - 1;
+        }
+
+        tw->now++;
+        cascade(tw);
+        timer_list_t *l = &tw->slots[0][tw->now & TW_MASK];
+        if (l->head) {
+            for (timer_node_t *t = l->head; t; t = t->next) {
+                tw->level_count[0]--;
+                tw->count--;
+            }
+            list_move_out(l, &head, &tail);
+            if (stop_early) break;
+        }
+    }
+    return head;
+}
+
+timer_node_t *tw_detach_all(timer_wheel_t *tw) {
+    timer_node_t *head = NULL, *tail = NULL;
+    list_move_out(&tw->due, &head, &tail);
+    for (int level = 0; level < TW_LEVELS; ++level) {
+        for (int slot = 0; slot < TW_SLOTS; ++slot) list_move_out(&tw->slots[level][slot], &head, &tail);
+        tw->level_count[level] = 0;
+    }
+    tw->count = 0;
+    return head;
+}
@@ -15,6 +15,11 @@ static const char *event_type_str(event_type_t t) {
         case EVT_JOB_FINISHED: return "job_finished";
         case EVT_CONTEXT_SWITCH: return "context_switch";
         case EVT_GANTT_SLICE: return "gantt_slice";
+        case EVT_JOB_BLOCKED: return "job_blocked";
+        case EVT_IO_COMPLETED: return "io_completed";
+        case EVT_IO_STARTED: return "io_started";
+        case EVT_LOCK_ACQUIRED: return "lock_acquired";
+        case EVT_JOB_FORKED: return "job_forked";
         default: return "unknown";
     }
 }
@@ -23,22 +28,32 @@ char *utils_build_event(event_type_t type, const scheduler_t *sched, const proce
     char *json = NULL;
     const char *etype = event_type_str(type);
 
+    if (sched && sched->quiet) return NULL;
+
+    /* events of the multi-CPU model carry the CPU they happened on */
+    char cpu[32] = "";
+    if (sched && sched->cpu_id >= 0) snprintf(cpu, sizeof(cpu), "\"cpu\": %d, ", sched->cpu_id);
+
     if (proc) {
         if (event_info) {
             (void) asprintf(&json,
-                "{ \"event\": \"%s\", \"tick\": %lu, \"pid\": %d, \"state\": \"%d\", %s }",
-                etype, sched ? sched->current_tick : 0UL, proc->pid, (int)proc->state, event_info);
+                "{ \"event\": \"%s\", \"tick\": %lu, %s\"pid\": %d, \"state\": \"%d\", %s }",
+                etype, sched ? sched->current_tick : 0UL, cpu, proc->pid, (int)proc->state, event_info);
         } else {
             (void) asprintf(&json,
-                "{ \"event\": \"%s\", \"tick\": %lu, \"pid\": %d, \"state\": \"%d\", \"arrival\": %u, \"burst\": %d, \"remaining\": %d, \"priority\": %d }",
-                etype, sched ? sched->current_tick : 0UL,
+                "{ \"event\": \"%s\", \"tick\": %lu, %s\"pid\": %d, \"state\": \"%d\", \"arrival\": %u, \"burst\": %d, \"remaining\": %d, \"priority\": %d }",
+                etype, sched ? sched->current_tick : 0UL, cpu,
                 proc->pid, (int)proc->state, proc->arrival, proc->burst, proc->remaining, proc->priority);
         }
     } else {
         if (event_info) {
             (void) asprintf(&json,
-                "{ \"event\": \"%s\", \"tick\": %lu, %s }",
-                etype, sched ? sched->current_tick : 0UL, event_info);
+                "{ \"event\": \"%s\", \"tick\": %lu, %s%s }",
+                etype, sched ? sched->current_tick : 0UL, cpu, event_info);
+        } else if (cpu[0]) {
+            (void) asprintf(&json,
+                "{ \"event\": \"%s\", \"tick\": %lu, \"cpu\": %d }",
+                etype, sched->current_tick, sched->cpu_id);
         } else {
             (void) asprintf(&json,
                 "{ \"event\": \"%s\", \"tick\": %lu }",
@@ -60,17 +75,38 @@ static int ensure_completed_capacity(scheduler_t *s) {
     return 1;
 }
 
-void utils_emit_event_and_free(char *event_json, event_type_t type, scheduler_t *sched) {
-    if (!event_json) return;
-
-    /* print the event first */
-    puts(event_json);
+/* Append one event line to the scheduler's buffer. This runs on the host
+ * thread advancing the CPU, so an event the buffer cannot grow for is only
+ * counted, for utils_flush_events() to report. */
+static void buffer_event(scheduler_t *s, const char *event_json) {
+    size_t n = strlen(event_json);
+    if (s->event_buf_len + n + 2 > s->event_buf_cap) {
+        size_t newcap = s->event_buf_cap ? s->event_buf_cap * 2 : 4096;
+        while (newcap < s->event_buf_len + n + 2) newcap *= 2;
+        char *buf = (char *)realloc(s->event_buf, newcap);
+        if (!buf) {
+            s->events_lost++;
+            return;
+        }
+        s->event_buf = buf;
+        s->event_buf_cap = newcap;
+    }
+    memcpy(s->event_buf + s->event_buf_len, event_json, n);
+    s->event_buf_len += n;
+    s->event_buf[s->event_buf_len++] = '\n';
+}
 
-    /* Update metrics where appropriate */
+void utils_emit_event_and_free(char *event_json, event_type_t type, scheduler_t *sched) {
+    /* Update metrics where appropriate (also when the event text was suppressed) */
     if (sched) {
         switch (type) {
             case EVT_CONTEXT_SWITCH:
                 sched->context_switches++;
+                scheduler_charge_dispatch(sched);
+                break;
+            case EVT_GANTT_SLICE:
+                /* every algorithm emits exactly one slice per tick it runs a process */
+                sched->busy_ticks++;
                 break;
             case EVT_JOB_STARTED:
                 /* set process start_time handled elsewhere (we have only a JSON string here) */
@@ -84,5 +120,21 @@ void utils_emit_event_and_free(char *event_json, event_type_t type, scheduler_t
         }
     }
 
+    if (!event_json) return;
+
+    if (sched && sched->buffered) buffer_event(sched, event_json);
+    else puts(event_json);
+
     free(event_json);
 }
+
+void utils_flush_events(scheduler_t *s) {
+    if (!s) return;
+    if (s->events_lost) {
+        fprintf(stderr, "Warning: cpu %d: out of memory buffering events, %lu lost\n", s->cpu_id, s->events_lost);
+        s->events_lost = 0;
+    }
+    if (!s->event_buf_len) return;
+    fwrite(s->event_buf, 1, s->event_buf_len, stdout);
+    s->event_buf_len = 0;
+}